@@ -0,0 +1,34 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+
+#include "common/latency_histogram.hpp"
+#include "common/tsc.hpp"
+
+namespace Benchmarks {
+
+	/// Prints one key=value line: benchmark=<benchmark> case=<name>, then ns_per_op
+	/// from the total elapsed time and the percentiles of histogram, recorded in
+	/// TSC ticks. extra goes at the end, e.g. " size=64".
+	inline auto report(const std::string& benchmark, const std::string& name, size_t ops,
+		uint64_t elapsed_tsc, const Common::LatencyHistogram& histogram,
+		const std::string& extra = "") {
+		const auto tsc_per_nano = Common::tscPerNano();
+		const auto ns = [tsc_per_nano](uint64_t tsc) {
+			return static_cast<double>(tsc) / tsc_per_nano;
+		};
+		std::cout << "benchmark=" << benchmark << " case=" << name << " ops=" << ops <<
+			" ns_per_op=" << (ops ? ns(elapsed_tsc) / ops : 0) <<
+			" p50=" << ns(histogram.percentile(50)) <<
+			" p90=" << ns(histogram.percentile(90)) <<
+			" p99=" << ns(histogram.percentile(99)) <<
+			" p99.9=" << ns(histogram.percentile(99.9)) <<
+			" max=" << ns(histogram.max()) << extra << std::endl;
+	}
+
+	/// Optional core for thread index from the command line, -1 to not pin.
+	inline auto core(int argc, char** argv, int index) {
+		return index + 1 < argc ? std::stoi(argv[index + 1]) : -1;
+	}
+}
@@ -0,0 +1,44 @@
+#include <chrono>
+
+#include "common/time_utils.hpp"
+
+#include "benchmarks/benchmark_utils.hpp"
+
+// Cost of reading the clocks used for timestamps: getCurrentNanos() (system
+// clock through the vDSO), steady_clock and the TSC. ns_per_op is a tight loop
+// of calls, the percentiles are of single calls measured with the TSC, so
+// include its own cost once.
+
+using namespace Common;
+
+namespace {
+	constexpr size_t NumCalls = 10 * 1000 * 1000;
+
+	template<typename F>
+	auto run(const std::string& name, F&& clock) {
+		uint64_t sink = 0;
+		const auto start = rdtsc();
+		for (size_t i = 0; i < NumCalls; ++i)
+			sink += clock();
+		const auto elapsed = rdtsc() - start;
+
+		LatencyHistogram histogram;
+		for (size_t i = 0; i < NumCalls; ++i) {
+			const auto call_start = rdtsc();
+			sink += clock();
+			histogram.record(rdtsc() - call_start);
+		}
+		Benchmarks::report("clock", name, NumCalls, elapsed, histogram,
+			" sink=" + std::to_string(sink & 1));
+	}
+}
+
+int main(int, char**) {
+	run("get_current_nanos", []() { return static_cast<uint64_t>(getCurrentNanos()); });
+	run("steady_clock", []() {
+		return static_cast<uint64_t>(
+			std::chrono::steady_clock::now().time_since_epoch().count());
+	});
+	run("rdtsc", []() { return rdtsc(); });
+	return 0;
+}
@@ -0,0 +1,126 @@
+#include <atomic>
+#include <cstring>
+
+#include "common/lf_queue.hpp"
+#include "common/thread_utils.hpp"
+
+#include "benchmarks/benchmark_utils.hpp"
+
+// LFQueue between two threads, for several element sizes:
+// - ping_pong: round trip of one element through a queue and back through a
+//   second one, the latency of a hand off in both directions.
+// - throughput: a producer keeps the queue full, the consumer records each
+//   element's time from write to read.
+// Both threads spin, with fewer than two free cores every hand off waits for a
+// time slice.
+//
+// Usage: lf_queue_benchmark [core of this thread] [core of the other thread]
+
+using namespace Common;
+
+namespace {
+	constexpr size_t QueueSize = 1024;
+	constexpr size_t NumPingPongs = 1000 * 1000;
+	constexpr size_t NumElements = 10 * 1000 * 1000;
+
+	template<size_t Size>
+	struct Payload {
+		uint64_t m_tsc = 0;
+		char m_data[Size - sizeof(uint64_t)] = {};
+	};
+
+	template<typename T>
+	auto waitToRead(const LFQueue<T>& queue) noexcept {
+		const T* element;
+		while (!(element = queue.getNextToRead()))
+			;
+		return element;
+	}
+
+	template<typename T>
+	auto write(LFQueue<T>& queue, const T& element) noexcept {
+		while (queue.size() + 1 >= queue.capacity())
+			;
+		*queue.getNextToWriteTo() = element;
+		queue.updateWriteIndex();
+	}
+
+	template<size_t Size>
+	auto pingPong(int core_id) {
+		using Element = Payload<Size>;
+		LFQueue<Element> ping(QueueSize), pong(QueueSize);
+
+		auto echo_thread = createAndStartThread(core_id, "Benchmarks/Echo", [&]() {
+			for (size_t i = 0; i < NumPingPongs; ++i) {
+				write(pong, *waitToRead(ping));
+				ping.updateReadIndex();
+			}
+		});
+
+		LatencyHistogram histogram;
+		Element element;
+		const auto start = rdtsc();
+		for (size_t i = 0; i < NumPingPongs; ++i) {
+			element.m_tsc = rdtsc();
+			write(ping, element);
+			const auto echo = waitToRead(pong);
+			histogram.record(rdtsc() - echo->m_tsc);
+			pong.updateReadIndex();
+		}
+		const auto elapsed = rdtsc() - start;
+
+		echo_thread->join();
+		delete echo_thread;
+		Benchmarks::report("lf_queue", "ping_pong", NumPingPongs, elapsed, histogram,
+			" size=" + std::to_string(Size));
+	}
+
+	template<size_t Size>
+	auto throughput(int core_id) {
+		using Element = Payload<Size>;
+		LFQueue<Element> queue(QueueSize);
+
+		LatencyHistogram histogram;
+		auto consumer_thread = createAndStartThread(core_id, "Benchmarks/Consumer", [&]() {
+			for (size_t i = 0; i < NumElements; ++i) {
+				const auto element = waitToRead(queue);
+				histogram.record(rdtsc() - element->m_tsc);
+				queue.updateReadIndex();
+			}
+		});
+
+		Element element;
+		const auto start = rdtsc();
+		for (size_t i = 0; i < NumElements; ++i) {
+			element.m_tsc = rdtsc();
+			write(queue, element);
+		}
+		while (queue.size())
+			;
+		const auto elapsed = rdtsc() - start;
+
+		consumer_thread->join();
+		delete consumer_thread;
+		Benchmarks::report("lf_queue", "throughput", NumElements, elapsed, histogram,
+			" size=" + std::to_string(Size));
+	}
+
+	template<size_t Size>
+	auto run(int core_id) {
+		pingPong<Size>(core_id);
+		throughput<Size>(core_id);
+	}
+}
+
+int main(int argc, char** argv) {
+	const auto main_core = Benchmarks::core(argc, argv, 0);
+	if (main_core >= 0)
+		setThreadCore(main_core);
+	const auto other_core = Benchmarks::core(argc, argv, 1);
+
+	run<16>(other_core);
+	run<64>(other_core);
+	run<256>(other_core);
+	run<1024>(other_core);
+	return 0;
+}
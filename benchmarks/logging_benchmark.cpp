@@ -0,0 +1,67 @@
+#include <cstdio>
+#include <thread>
+
+#include "common/logging.hpp"
+#include "common/time_utils.hpp"
+
+#include "exchange/order_server/client_request.hpp"
+
+#include "benchmarks/benchmark_utils.hpp"
+
+// Cost of a Logger::log() call on the calling thread, with the format strings
+// of the MatchingEngine hot path:
+// - numbers: file, line, function and two integers.
+// - time_str: the same with getCurrentTimeStr(), as every log line has.
+// - me_request: "Processing" line of MatchingEngine::run() with the request's
+//   toString().
+// Calls are made in batches the logger thread drains in between, the queue
+// has no back pressure.
+
+using namespace Common;
+
+namespace {
+	constexpr size_t NumBatches = 20;
+	constexpr size_t BatchSize = 10 * 1000;
+
+	template<typename F>
+	auto run(Logger& logger, const std::string& name, F&& log) {
+		LatencyHistogram histogram;
+		uint64_t elapsed = 0;
+		for (size_t batch = 0; batch < NumBatches; ++batch) {
+			for (size_t i = 0; i < BatchSize; ++i) {
+				const auto start = rdtsc();
+				log(i);
+				const auto call = rdtsc() - start;
+				histogram.record(call);
+				elapsed += call;
+			}
+			while (logger.pendingSize())
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		Benchmarks::report("logging", name, histogram.count(), elapsed, histogram);
+	}
+}
+
+int main(int, char**) {
+	const std::string file_name = "logging_benchmark.log";
+	{
+		Logger logger(file_name);
+		std::string time_str;
+		const Exchange::MEClientRequest request{ Exchange::ClientRequestType::NEW, 1, 7, 42,
+			Side::BUY, 100, 10 };
+
+		run(logger, "numbers", [&](size_t i) {
+			logger.log("%:% %() seq:% qty:%\n", __FILE__, __LINE__, __FUNCTION__, i, 10);
+		});
+		run(logger, "time_str", [&](size_t i) {
+			logger.log("%:% %() % seq:% qty:%\n", __FILE__, __LINE__, __FUNCTION__,
+				getCurrentTimeStr(&time_str), i, 10);
+		});
+		run(logger, "me_request", [&](size_t) {
+			logger.log("%:% %() % Processing %\n", __FILE__, __LINE__, __FUNCTION__,
+				getCurrentTimeStr(&time_str), request.toString());
+		});
+	}
+	std::remove(file_name.c_str());
+	return 0;
+}
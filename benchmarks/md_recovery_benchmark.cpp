@@ -0,0 +1,184 @@
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <map>
+#include <random>
+
+#include "common/thread_utils.hpp"
+#include "common/time_utils.hpp"
+
+#include "trading/market_data/market_data_recovery.hpp"
+
+// Recovers a channel from a snapshot of a 1M order book while incrementals
+// around the snapshot's SeqNum arrive out of order, the way MarketDataConsumer
+// does, and pushes the result through a queue of the trade engine's size that
+// another thread drains. The std::map variant is the previous implementation
+// minus its rescan of both maps on every queued message, a lower bound for it.
+// Prints one key=value line per run.
+
+using namespace Common;
+using namespace Exchange;
+using Trading::RecvTimeMarketUpdate;
+
+namespace {
+	constexpr size_t NumOrders = 1000 * 1000;
+	constexpr size_t SnapshotSeqNum = 5 * 1000 * 1000;
+	/// Incrementals queued before and after SnapshotSeqNum.
+	constexpr size_t NumIncrementalsBefore = 20 * 1000;
+	constexpr size_t NumIncrementalsAfter = 40 * 1000;
+	constexpr size_t NumRuns = 5;
+
+	struct Input {
+		std::vector<RecvTimeMarketUpdate> m_snapshot;
+		std::vector<std::pair<size_t, RecvTimeMarketUpdate>> m_incrementals;
+	};
+
+	auto makeInput() {
+		Input input;
+		input.m_snapshot.reserve(NumOrders + ME_MAX_TICKERS + 2);
+		input.m_snapshot.push_back({ 0, { MarketUpdateType::SNAPSHOT_START, SnapshotSeqNum } });
+		for (TickerId ticker_id = 0; ticker_id < ME_MAX_TICKERS; ++ticker_id) {
+			input.m_snapshot.push_back({ 0, { MarketUpdateType::CLEAR, OrderId_INVALID,
+				ticker_id } });
+			for (size_t i = ticker_id; i < NumOrders; i += ME_MAX_TICKERS) {
+				const auto side = (i & 1) ? Side::BUY : Side::SELL;
+				input.m_snapshot.push_back({ 0, { MarketUpdateType::ADD, i, ticker_id, side,
+					static_cast<Price>(side == Side::BUY ? 1000 - i % 100 : 1001 + i % 100),
+					static_cast<Qty>(1 + i % 50), static_cast<Priority>(i) } });
+			}
+		}
+		input.m_snapshot.push_back({ 0, { MarketUpdateType::SNAPSHOT_END, SnapshotSeqNum } });
+
+		for (size_t seq_num = SnapshotSeqNum - NumIncrementalsBefore + 1;
+			seq_num <= SnapshotSeqNum + NumIncrementalsAfter; ++seq_num) {
+			const auto ticker_id = static_cast<TickerId>(seq_num % ME_MAX_TICKERS);
+			input.m_incrementals.push_back({ seq_num, { 0, { MarketUpdateType::ADD,
+				NumOrders + seq_num, ticker_id, Side::BUY, 900, 10, 1 } } });
+		}
+		std::mt19937_64 rng(42);
+		std::shuffle(input.m_incrementals.begin(), input.m_incrementals.end(), rng);
+		return input;
+	}
+
+	/// Reader standing in for the trade engine.
+	struct Drain {
+		Trading::RecvTimeMarketUpdateLFQueue* m_queue = nullptr;
+		std::atomic<size_t> m_count = 0;
+		std::atomic<bool> m_run = true;
+
+		auto run() noexcept {
+			while (m_run) {
+				const auto num_updates = m_queue->size();
+				m_queue->updateReadIndex(num_updates);
+				m_count += num_updates;
+			}
+		}
+
+		auto waitFor(size_t count) const noexcept {
+			while (m_count < count)
+				;
+		}
+	};
+
+	auto pushOne(Trading::RecvTimeMarketUpdateLFQueue& queue,
+		const RecvTimeMarketUpdate& market_update) {
+		while (queue.size() + 1 >= queue.capacity())
+			;
+		*queue.getNextToWriteTo() = market_update;
+		queue.updateWriteIndex();
+	}
+
+	auto recoverSeqWindow(const Input& input, Trading::MarketDataRecovery& recovery) {
+		auto& incrementals = recovery.incrementals();
+		incrementals.advance(SnapshotSeqNum - NumIncrementalsBefore + 1);
+		for (const auto& [seq_num, market_update] : input.m_incrementals)
+			incrementals.insert(seq_num, market_update);
+		for (size_t i = 0; i < input.m_snapshot.size(); ++i)
+			recovery.addSnapshot(i, input.m_snapshot[i]);
+
+		if (!recovery.snapshotComplete())
+			return size_t(0);
+		const auto snapshot_seq_num = recovery.snapshotSeqNum();
+		incrementals.advance(snapshot_seq_num + 1);
+		if (!incrementals.complete())
+			return size_t(0);
+
+		const auto num_updates = recovery.snapshotSize() - 2;
+		recovery.forwardSnapshot();
+		const auto end_seq_num = recovery.forwardIncrementals(snapshot_seq_num + 1);
+		recovery.clearSnapshot();
+		return num_updates + end_seq_num - (snapshot_seq_num + 1);
+	}
+
+	auto recoverMap(const Input& input, Trading::RecvTimeMarketUpdateLFQueue& queue) {
+		std::map<size_t, RecvTimeMarketUpdate> snapshot_queued_msgs;
+		std::map<size_t, RecvTimeMarketUpdate> incremental_queued_msgs;
+		for (const auto& [seq_num, market_update] : input.m_incrementals)
+			incremental_queued_msgs[seq_num] = market_update;
+		for (size_t i = 0; i < input.m_snapshot.size(); ++i)
+			snapshot_queued_msgs[i] = input.m_snapshot[i];
+
+		std::vector<RecvTimeMarketUpdate> final_events;
+		size_t next_snapshot_seq = 0;
+		for (const auto& [seq_num, market_update] : snapshot_queued_msgs) {
+			if (seq_num != next_snapshot_seq++)
+				return size_t(0);
+			if (market_update.m_market_update.m_type != MarketUpdateType::SNAPSHOT_START &&
+				market_update.m_market_update.m_type != MarketUpdateType::SNAPSHOT_END)
+				final_events.push_back(market_update);
+		}
+		auto next_exp_inc_seq_num = snapshot_queued_msgs.rbegin()->second.m_market_update.m_order_id + 1;
+		for (const auto& [seq_num, market_update] : incremental_queued_msgs) {
+			if (seq_num < next_exp_inc_seq_num)
+				continue;
+			if (seq_num != next_exp_inc_seq_num)
+				return size_t(0);
+			final_events.push_back(market_update);
+			next_exp_inc_seq_num++;
+		}
+
+		for (const auto& market_update : final_events)
+			pushOne(queue, market_update);
+		return final_events.size();
+	}
+
+	auto report(const std::string& impl, size_t run, Nanos elapsed, size_t num_updates) {
+		std::cout << "benchmark=md_recovery impl=" << impl << " run=" << run <<
+			" orders=" << NumOrders << " incrementals=" <<
+			NumIncrementalsBefore + NumIncrementalsAfter << " updates=" << num_updates <<
+			" ns=" << elapsed << " ns_per_update=" <<
+			(num_updates ? elapsed / Nanos(num_updates) : 0) << std::endl;
+	}
+}
+
+int main(int, char**) {
+	const auto input = makeInput();
+
+	Trading::RecvTimeMarketUpdateLFQueue queue(ME_MAX_MARKET_UPDATES);
+	Drain drain;
+	drain.m_queue = &queue;
+	auto drain_thread = createAndStartThread(-1, "Benchmarks/Drain", [&drain]() {
+		drain.run(); });
+
+	Trading::TickerSubscriptions ticker_subscribed;
+	ticker_subscribed.fill(true);
+	Trading::MarketDataRecovery recovery(&queue, &ticker_subscribed);
+
+	size_t expected = drain.m_count;
+	for (size_t run = 0; run < NumRuns; ++run) {
+		const auto start = getCurrentNanos();
+		const auto num_updates = recoverSeqWindow(input, recovery);
+		drain.waitFor(expected += num_updates);
+		report("seq_window", run, getCurrentNanos() - start, num_updates);
+	}
+	for (size_t run = 0; run < NumRuns; ++run) {
+		const auto start = getCurrentNanos();
+		const auto num_updates = recoverMap(input, queue);
+		drain.waitFor(expected += num_updates);
+		report("map", run, getCurrentNanos() - start, num_updates);
+	}
+
+	drain.m_run = false;
+	drain_thread->join();
+	return 0;
+}
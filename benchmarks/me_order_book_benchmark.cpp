@@ -0,0 +1,353 @@
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "common/logging.hpp"
+
+#include "exchange/matcher/me_order_book.hpp"
+#include "exchange/matcher/matching_engine.hpp"
+
+#include "benchmarks/benchmark_utils.hpp"
+
+// MEOrderBook::add() and cancel() under synthetic order flow, the book built
+// with the stub MatchingEngine of benchmarks/stub which keeps the responses
+// instead of queueing them. The book is prefilled with orders= orders spread
+// depth= to a level around a mid price (at most MaxLevels levels a side, larger
+// books queue deeper), then ops= operations are drawn with
+// the add=, cancel= and cross= ratios:
+// - add: a passive order at the touch or up to distance= ticks behind it.
+// - cancel: a random live order.
+// - cross: an order up to distance= ticks through the opposite touch, which
+//   rests with what it does not fill.
+// The book is kept between orders= and twice that: a cancel becomes an add below
+// it and an add a cancel above it, anything but a cancel does once the order
+// pool is full and a cross becomes an add when there is nothing to cross. The
+// ops= of each case is the mix that came out. Each case prints the percentiles
+// of one call, case=all the msgs_per_sec of all of them.
+//
+// Usage: me_order_book_benchmark [orders=N] [ops=N] [add=N] [cancel=N] [cross=N]
+//   [distance=N] [depth=N] [seed=N]
+// Without orders= it runs for 10, 1000, 100000 and 1000000 orders.
+
+using namespace Common;
+using namespace Exchange;
+
+namespace {
+	constexpr Price MidPrice = 10000;
+	/// Most levels on a side in the prefilled book.
+	constexpr Price MaxLevels = 100;
+	/// Every price stays within MidPrice +/- PriceRange, fewer than
+	/// ME_MAX_PRICE_LEVELS so no two live levels share an index.
+	constexpr Price PriceRange = 120;
+	constexpr Price MinPrice = MidPrice - PriceRange;
+	constexpr Price MaxPrice = MidPrice + PriceRange;
+	constexpr size_t NumClients = 8;
+	constexpr TickerId BenchmarkTickerId = 0;
+
+	static_assert(2 * PriceRange < static_cast<Price>(ME_MAX_PRICE_LEVELS));
+
+	struct Config {
+		size_t m_orders = 0;
+		size_t m_ops = 1000 * 1000;
+		size_t m_add = 50;
+		size_t m_cancel = 40;
+		size_t m_cross = 10;
+		Price m_distance = 5;
+		size_t m_depth = 10;
+		uint64_t m_seed = 42;
+	};
+
+	enum class Op : size_t {
+		ADD = 0,
+		CANCEL = 1,
+		CROSS = 2,
+		COUNT = 3
+	};
+
+	const std::array<std::string, static_cast<size_t>(Op::COUNT)> OpNames = {
+		"add", "cancel", "cross" };
+
+	class Flow final {
+		const Config& m_config;
+		MatchingEngine m_matching_engine;
+		MEOrderBook* m_book = nullptr;
+		std::mt19937_64 m_rng;
+
+		/// Order ids are client order ids too, the client is id % NumClients.
+		std::vector<OrderId> m_free_ids;
+		std::vector<OrderId> m_live;
+		std::vector<size_t> m_live_index;
+		std::vector<Side> m_sides;
+		std::vector<Price> m_prices;
+		/// Live orders at each price from MinPrice.
+		std::array<size_t, 2 * PriceRange + 1> m_num_bids = {};
+		std::array<size_t, 2 * PriceRange + 1> m_num_asks = {};
+
+		std::array<LatencyHistogram, static_cast<size_t>(Op::COUNT)> m_histograms;
+		std::array<uint64_t, static_cast<size_t>(Op::COUNT)> m_elapsed = {};
+		LatencyHistogram m_all;
+		uint64_t m_all_elapsed = 0;
+
+		auto& numAt(Side side, Price price) noexcept {
+			return (side == Side::BUY ? m_num_bids : m_num_asks)[price - MinPrice];
+		}
+
+		auto bestBid() const noexcept {
+			for (auto price = MaxPrice; price >= MinPrice; --price)
+				if (m_num_bids[price - MinPrice])
+					return price;
+			return Price_INVALID;
+		}
+
+		auto bestAsk() const noexcept {
+			for (auto price = MinPrice; price <= MaxPrice; ++price)
+				if (m_num_asks[price - MinPrice])
+					return price;
+			return Price_INVALID;
+		}
+
+		auto addLive(OrderId id, Side side, Price price) noexcept {
+			m_live_index[id] = m_live.size();
+			m_live.push_back(id);
+			m_sides[id] = side;
+			m_prices[id] = price;
+			++numAt(side, price);
+		}
+
+		auto removeLive(OrderId id) noexcept {
+			const auto last = m_live.back();
+			m_live[m_live_index[id]] = last;
+			m_live_index[last] = m_live_index[id];
+			m_live.pop_back();
+			--numAt(m_sides[id], m_prices[id]);
+			m_free_ids.push_back(id);
+		}
+
+		/// Follows the orders in the book from the responses to the last call.
+		auto processResponses() noexcept {
+			for (const auto& response : m_matching_engine.responses()) {
+				switch (response.m_type) {
+				case ClientResponseType::ACCEPTED:
+					addLive(response.m_client_order_id, response.m_side, response.m_price);
+					break;
+				case ClientResponseType::FILLED:
+					if (!response.m_leaves_qty)
+						removeLive(response.m_client_order_id);
+					break;
+				case ClientResponseType::CANCELED:
+					removeLive(response.m_client_order_id);
+					break;
+				default:
+					FATAL("Unexpected response " + response.toString());
+				}
+			}
+			m_matching_engine.clearResponses();
+		}
+
+		auto add(Side side, Price price, Qty qty) noexcept {
+			const auto id = m_free_ids.back();
+			m_free_ids.pop_back();
+			price = std::clamp(price, MinPrice, MaxPrice);
+
+			const auto start = rdtsc();
+			m_book->add(static_cast<ClientId>(id % NumClients), id, BenchmarkTickerId, side,
+				price, qty);
+			const auto elapsed = rdtsc() - start;
+
+			// ACCEPTED makes id live, a fill or cancel hands it back to m_free_ids.
+			processResponses();
+			return elapsed;
+		}
+
+		auto cancel(OrderId id) noexcept {
+			const auto start = rdtsc();
+			m_book->cancel(static_cast<ClientId>(id % NumClients), id, BenchmarkTickerId);
+			const auto elapsed = rdtsc() - start;
+			processResponses();
+			return elapsed;
+		}
+
+		auto randomSide() noexcept { return (m_rng() & 1) ? Side::BUY : Side::SELL; }
+		auto randomQty() noexcept { return static_cast<Qty>(1 + m_rng() % 100); }
+		auto randomDistance() noexcept {
+			return static_cast<Price>(m_rng() % (m_config.m_distance + 1));
+		}
+
+		auto passivePrice(Side side) noexcept {
+			const auto touch = (side == Side::BUY ? bestBid() : bestAsk());
+			if (side == Side::BUY)
+				return (touch == Price_INVALID ? MidPrice - 1 : touch) - randomDistance();
+			return (touch == Price_INVALID ? MidPrice + 1 : touch) + randomDistance();
+		}
+
+		auto pick() noexcept {
+			const auto draw = m_rng() % (m_config.m_add + m_config.m_cancel + m_config.m_cross);
+			auto op = (draw < m_config.m_add ? Op::ADD :
+				draw < m_config.m_add + m_config.m_cancel ? Op::CANCEL : Op::CROSS);
+			if ((op == Op::ADD && m_live.size() >= 2 * m_config.m_orders) || m_free_ids.empty())
+				op = Op::CANCEL;
+			if ((op == Op::CANCEL && m_live.size() < m_config.m_orders) ||
+				(op != Op::ADD && m_live.empty()))
+				op = Op::ADD;
+			return op;
+		}
+
+		auto step() noexcept {
+			auto op = pick();
+			uint64_t elapsed = 0;
+			switch (op) {
+			case Op::ADD: {
+				const auto side = randomSide();
+				elapsed = add(side, passivePrice(side), randomQty());
+			}
+				break;
+			case Op::CANCEL:
+				elapsed = cancel(m_live[m_rng() % m_live.size()]);
+				break;
+			case Op::CROSS: {
+				const auto side = randomSide();
+				const auto touch = (side == Side::BUY ? bestAsk() : bestBid());
+				if (touch == Price_INVALID) {
+					op = Op::ADD;
+					elapsed = add(side, passivePrice(side), randomQty());
+				}
+				else {
+					const auto distance = randomDistance();
+					elapsed = add(side, side == Side::BUY ? touch + distance : touch - distance,
+						static_cast<Qty>(1 + m_rng() % 200));
+				}
+			}
+				break;
+			default:
+				break;
+			}
+			m_histograms[static_cast<size_t>(op)].record(elapsed);
+			m_elapsed[static_cast<size_t>(op)] += elapsed;
+			m_all.record(elapsed);
+			m_all_elapsed += elapsed;
+		}
+
+	public:
+		Flow(const Config& config, Logger& logger) : m_config(config), m_rng(config.m_seed),
+			m_live_index(ME_MAX_ORDER_IDS), m_sides(ME_MAX_ORDER_IDS),
+			m_prices(ME_MAX_ORDER_IDS) {
+			m_book = new MEOrderBook(BenchmarkTickerId, &logger, &m_matching_engine);
+			m_free_ids.reserve(ME_MAX_ORDER_IDS);
+			for (size_t id = ME_MAX_ORDER_IDS; id > 0; --id)
+				m_free_ids.push_back(id - 1);
+			m_live.reserve(ME_MAX_ORDER_IDS);
+		}
+
+		~Flow() {
+			delete m_book;
+		}
+
+		Flow() = delete;
+		Flow(const Flow&) = delete;
+		Flow(const Flow&&) = delete;
+		Flow& operator=(const Flow&) = delete;
+		Flow& operator=(const Flow&&) = delete;
+
+		auto levels() const noexcept {
+			const auto per_side = (m_config.m_orders + 1) / 2;
+			return std::clamp<Price>(static_cast<Price>(
+				(per_side + m_config.m_depth - 1) / m_config.m_depth), 1, MaxLevels);
+		}
+
+		auto prefill() noexcept {
+			const auto num_levels = levels();
+			for (size_t i = 0; i < m_config.m_orders; ++i) {
+				const auto side = (i & 1) ? Side::BUY : Side::SELL;
+				const auto level = static_cast<Price>((i / 2) % num_levels);
+				add(side, side == Side::BUY ? MidPrice - 1 - level : MidPrice + 1 + level,
+					randomQty());
+			}
+		}
+
+		auto run() noexcept {
+			for (size_t i = 0; i < m_config.m_ops; ++i)
+				step();
+		}
+
+		auto report() const {
+			const auto extra = " orders=" + std::to_string(m_config.m_orders) +
+				" depth=" + std::to_string(m_config.m_depth) +
+				" levels=" + std::to_string(levels()) +
+				" live=" + std::to_string(m_live.size());
+			for (size_t op = 0; op < static_cast<size_t>(Op::COUNT); ++op)
+				Benchmarks::report("me_order_book", OpNames[op], m_histograms[op].count(),
+					m_elapsed[op], m_histograms[op], extra);
+
+			const auto seconds = static_cast<double>(m_all_elapsed) / tscPerNano() / 1e9;
+			Benchmarks::report("me_order_book", "all", m_all.count(), m_all_elapsed, m_all,
+				extra + " market_updates=" + std::to_string(m_matching_engine.numMarketUpdates()) +
+				" msgs_per_sec=" + std::to_string(
+					static_cast<uint64_t>(seconds > 0 ? m_all.count() / seconds : 0)));
+		}
+	};
+
+	auto parse(int argc, char** argv) {
+		Config config;
+		for (int i = 1; i < argc; ++i) {
+			const std::string arg = argv[i];
+			const auto equals = arg.find('=');
+			ASSERT(equals != std::string::npos, "Expected key=value, got " + arg);
+			const auto key = arg.substr(0, equals);
+			const auto value = std::stoull(arg.substr(equals + 1));
+			if (key == "orders")
+				config.m_orders = value;
+			else if (key == "ops")
+				config.m_ops = value;
+			else if (key == "add")
+				config.m_add = value;
+			else if (key == "cancel")
+				config.m_cancel = value;
+			else if (key == "cross")
+				config.m_cross = value;
+			else if (key == "distance")
+				config.m_distance = static_cast<Price>(value);
+			else if (key == "depth")
+				config.m_depth = value;
+			else if (key == "seed")
+				config.m_seed = value;
+			else
+				FATAL("Unknown argument " + arg);
+		}
+		ASSERT(config.m_add + config.m_cancel + config.m_cross, "All ratios are 0");
+		ASSERT(config.m_depth, "depth must be at least 1");
+		ASSERT(config.m_orders < ME_MAX_ORDER_IDS, "orders must be below " +
+			std::to_string(ME_MAX_ORDER_IDS));
+		return config;
+	}
+}
+
+int main(int argc, char** argv) {
+	const auto config = parse(argc, argv);
+	const std::string file_name = "me_order_book_benchmark.log";
+	{
+		Logger logger(file_name);
+		const auto run = [&logger](const Config& run_config) {
+			// Over 2GB of MEOrderBook, mostly untouched, on the heap.
+			Flow flow(run_config, logger);
+			flow.prefill();
+			flow.run();
+			flow.report();
+		};
+
+		if (config.m_orders) {
+			run(config);
+		}
+		else {
+			for (const size_t orders : { 10, 1000, 100 * 1000, 1000 * 1000 }) {
+				auto sweep_config = config;
+				sweep_config.m_orders = orders;
+				run(sweep_config);
+			}
+		}
+	}
+	std::remove(file_name.c_str());
+	return 0;
+}
@@ -0,0 +1,98 @@
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "common/mem_pool.hpp"
+
+#include "benchmarks/benchmark_utils.hpp"
+
+// MemPool allocate() and deallocate() with ME_MAX_ORDER_IDS sized pools of
+// order sized objects, in the patterns the order books produce:
+// - lifo: a burst of orders cancelled newest first.
+// - fifo: a burst of orders filled oldest first.
+// - random: a steady book, a random live order goes and a new one comes.
+
+using namespace Common;
+
+namespace {
+	constexpr size_t PoolSize = 1024 * 1024;
+	/// Live objects, half the pool.
+	constexpr size_t NumLive = PoolSize / 2;
+	constexpr size_t NumRounds = 5;
+
+	struct Order {
+		uint64_t m_values[8] = {};
+	};
+
+	struct Timings {
+		LatencyHistogram m_allocate;
+		LatencyHistogram m_deallocate;
+		uint64_t m_allocate_tsc = 0;
+		uint64_t m_deallocate_tsc = 0;
+
+		auto allocate(MemPool<Order>& pool) noexcept {
+			const auto start = rdtsc();
+			auto order = pool.allocate();
+			const auto elapsed = rdtsc() - start;
+			m_allocate.record(elapsed);
+			m_allocate_tsc += elapsed;
+			return order;
+		}
+
+		auto deallocate(MemPool<Order>& pool, const Order* order) noexcept {
+			const auto start = rdtsc();
+			pool.deallocate(order);
+			const auto elapsed = rdtsc() - start;
+			m_deallocate.record(elapsed);
+			m_deallocate_tsc += elapsed;
+		}
+
+		auto report(const std::string& name) const {
+			Benchmarks::report("mem_pool", name, m_allocate.count(), m_allocate_tsc,
+				m_allocate, " op=allocate");
+			Benchmarks::report("mem_pool", name, m_deallocate.count(), m_deallocate_tsc,
+				m_deallocate, " op=deallocate");
+		}
+	};
+
+	auto burst(bool lifo) {
+		MemPool<Order> pool(PoolSize);
+		std::vector<Order*> orders(NumLive);
+		Timings timings;
+		for (size_t round = 0; round < NumRounds; ++round) {
+			for (auto& order : orders)
+				order = timings.allocate(pool);
+			if (lifo)
+				std::reverse(orders.begin(), orders.end());
+			for (const auto order : orders)
+				timings.deallocate(pool, order);
+		}
+		timings.report(lifo ? "lifo" : "fifo");
+	}
+
+	auto randomChurn() {
+		MemPool<Order> pool(PoolSize);
+		std::vector<Order*> orders(NumLive);
+		for (auto& order : orders)
+			order = pool.allocate();
+
+		std::mt19937_64 rng(42);
+		std::vector<size_t> victims(NumRounds * NumLive);
+		for (auto& victim : victims)
+			victim = rng() % NumLive;
+
+		Timings timings;
+		for (const auto victim : victims) {
+			timings.deallocate(pool, orders[victim]);
+			orders[victim] = timings.allocate(pool);
+		}
+		timings.report("random");
+	}
+}
+
+int main(int, char**) {
+	burst(true);
+	burst(false);
+	randomChurn();
+	return 0;
+}
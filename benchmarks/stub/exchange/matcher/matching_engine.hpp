@@ -0,0 +1,38 @@
+#pragma once
+
+#include <vector>
+
+#include "exchange/order_server/client_response.hpp"
+#include "exchange/market_data/market_update.hpp"
+
+#include "exchange/matcher/me_order_book.hpp"
+
+// Stands in for exchange/matcher/matching_engine.hpp when me_order_book.cpp is
+// built into a benchmark: MEOrderBook's responses are kept for the benchmark to
+// look at and its market updates only counted, no queues or threads.
+
+namespace Exchange {
+
+	class MatchingEngine final {
+
+		std::vector<MEClientResponse> m_responses;
+		size_t m_num_market_updates = 0;
+
+	public:
+		MatchingEngine() { m_responses.reserve(1024); }
+
+		MatchingEngine(const MatchingEngine&) = delete;
+		MatchingEngine(const MatchingEngine&&) = delete;
+		MatchingEngine& operator=(const MatchingEngine&) = delete;
+		MatchingEngine& operator=(const MatchingEngine&&) = delete;
+
+		void sendClientResponse(const MEClientResponse* client_response) noexcept {
+			m_responses.push_back(*client_response);
+		}
+		void sendMarketUpdate(const MEMarketUpdate*) noexcept { ++m_num_market_updates; }
+
+		const auto& responses() const noexcept { return m_responses; }
+		auto clearResponses() noexcept { m_responses.clear(); }
+		auto numMarketUpdates() const noexcept { return m_num_market_updates; }
+	};
+}
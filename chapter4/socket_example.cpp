@@ -10,10 +10,10 @@ int main(int, char**) {
 
 	auto tcpServerRecvCallback = [&](TCPSocket* socket, Nanos rx_time) noexcept {
 		logger.log("TCPServer::defaultRecvCallback() socket: % len : % rx : % \n",
-			socket->m_fd, socket->m_next_recv_valid_index, rx_time);
+			socket->m_fd, socket->m_recv_ring.size(), rx_time);
 		const std::string reply = "TCPServer received msg:" +
-			std::string(socket->m_recv_buffer, socket->m_next_recv_valid_index);
-		socket->m_next_recv_valid_index = 0;
+			std::string(socket->m_recv_ring.data(), socket->m_recv_ring.size());
+		socket->m_recv_ring.consume(socket->m_recv_ring.size());
 		socket->send(reply.data(), reply.length());
 		};
 
@@ -23,11 +23,11 @@ int main(int, char**) {
 
 	auto tcpClientRecvCallback = [&](TCPSocket* socket, Nanos rx_time) noexcept {
 		const std::string recv_msg = std::string(
-			socket->m_recv_buffer, socket->m_next_recv_valid_index);
-		socket->m_next_recv_valid_index = 0;
+			socket->m_recv_ring.data(), socket->m_recv_ring.size());
+		socket->m_recv_ring.consume(socket->m_recv_ring.size());
 
 		logger.log("TCPServer::defaultRecvCallback() socket: % len: % rx: % msg: %\n",
-			socket->m_fd, socket->m_next_recv_valid_index, rx_time, recv_msg);
+			socket->m_fd, socket->m_recv_ring.size(), rx_time, recv_msg);
 		};
 
 	const std::string iface = "lo";
@@ -0,0 +1,271 @@
+#include "common/io_uring.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace Common {
+
+	static auto ioUringSetup(unsigned entries, io_uring_params* params) {
+		return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+	}
+
+	static auto ioUringRegister(int fd, unsigned opcode, void* arg, unsigned nr_args) {
+		return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, nr_args));
+	}
+
+	IoUring::IoUring(const IoUringCfg& cfg) noexcept {
+		io_uring_params params{};
+		if (cfg.m_sqpoll) {
+			params.flags = IORING_SETUP_SQPOLL;
+			params.sq_thread_idle = cfg.m_sqpoll_idle_ms;
+			if (cfg.m_sqpoll_cpu >= 0) {
+				params.flags |= IORING_SETUP_SQ_AFF;
+				params.sq_thread_cpu = cfg.m_sqpoll_cpu;
+			}
+		}
+		else {
+			params.flags = IORING_SETUP_COOP_TASKRUN | IORING_SETUP_TASKRUN_FLAG;
+		}
+
+		m_ring_fd = ioUringSetup(cfg.m_entries, &params);
+		if (m_ring_fd == -1 && errno == EINVAL && !cfg.m_sqpoll) {
+			// Kernels before 5.19 do not know COOP_TASKRUN.
+			params = {};
+			m_ring_fd = ioUringSetup(cfg.m_entries, &params);
+		}
+		if (m_ring_fd == -1)
+			return;
+		m_setup_flags = params.flags;
+
+		m_sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+		m_cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+		if (params.features & IORING_FEAT_SINGLE_MMAP)
+			m_sq_ring_size = m_cq_ring_size = std::max(m_sq_ring_size, m_cq_ring_size);
+
+		m_sq_ring = mmap(nullptr, m_sq_ring_size, PROT_READ | PROT_WRITE,
+			MAP_SHARED | MAP_POPULATE, m_ring_fd, IORING_OFF_SQ_RING);
+		if (m_sq_ring == MAP_FAILED) {
+			m_sq_ring = nullptr;
+			destroy();
+			return;
+		}
+		if (params.features & IORING_FEAT_SINGLE_MMAP) {
+			m_cq_ring = m_sq_ring;
+		}
+		else {
+			m_cq_ring = mmap(nullptr, m_cq_ring_size, PROT_READ | PROT_WRITE,
+				MAP_SHARED | MAP_POPULATE, m_ring_fd, IORING_OFF_CQ_RING);
+			if (m_cq_ring == MAP_FAILED) {
+				m_cq_ring = nullptr;
+				destroy();
+				return;
+			}
+		}
+
+		m_sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+		auto sqes = mmap(nullptr, m_sqes_size, PROT_READ | PROT_WRITE,
+			MAP_SHARED | MAP_POPULATE, m_ring_fd, IORING_OFF_SQES);
+		if (sqes == MAP_FAILED) {
+			destroy();
+			return;
+		}
+		m_sqes = static_cast<io_uring_sqe*>(sqes);
+
+		auto sq_ring = static_cast<char*>(m_sq_ring);
+		m_sq_head = reinterpret_cast<unsigned*>(sq_ring + params.sq_off.head);
+		m_sq_tail = reinterpret_cast<unsigned*>(sq_ring + params.sq_off.tail);
+		m_sq_flags = reinterpret_cast<unsigned*>(sq_ring + params.sq_off.flags);
+		m_sq_mask = *reinterpret_cast<unsigned*>(sq_ring + params.sq_off.ring_mask);
+		m_sq_entries = params.sq_entries;
+		m_sqe_tail = m_sqe_submitted = *m_sq_tail;
+
+		// SQE slots are always used in order, so the indirection array is identity.
+		auto sq_array = reinterpret_cast<unsigned*>(sq_ring + params.sq_off.array);
+		for (unsigned i = 0; i < m_sq_entries; ++i)
+			sq_array[i] = i;
+
+		auto cq_ring = static_cast<char*>(m_cq_ring);
+		m_cq_head = reinterpret_cast<unsigned*>(cq_ring + params.cq_off.head);
+		m_cq_tail = reinterpret_cast<unsigned*>(cq_ring + params.cq_off.tail);
+		m_cq_mask = *reinterpret_cast<unsigned*>(cq_ring + params.cq_off.ring_mask);
+		m_cqes = reinterpret_cast<io_uring_cqe*>(cq_ring + params.cq_off.cqes);
+
+		if (!setupBufferRing(cfg))
+			destroy();
+	}
+
+	IoUring::~IoUring() {
+		destroy();
+	}
+
+	auto IoUring::setupBufferRing(const IoUringCfg& cfg) noexcept -> bool {
+		m_buffer_count = cfg.m_buffer_count;
+		m_buffer_size = cfg.m_buffer_size;
+		if (!m_buffer_count || (m_buffer_count & (m_buffer_count - 1)) ||
+			m_buffer_count > 32768)
+			return false;
+
+		const size_t page_size = sysconf(_SC_PAGESIZE);
+		m_buf_ring_size = (m_buffer_count * sizeof(io_uring_buf) + page_size - 1) /
+			page_size * page_size;
+		// Entries are addressed through a plain io_uring_buf*, in C++ the flexible
+		// array in io_uring_buf_ring sits behind an empty struct and is misplaced.
+		auto buf_ring = mmap(nullptr, m_buf_ring_size, PROT_READ | PROT_WRITE,
+			MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (buf_ring == MAP_FAILED)
+			return false;
+		m_buf_ring = static_cast<io_uring_buf_ring*>(buf_ring);
+
+		auto buffers = mmap(nullptr, size_t(m_buffer_count) * m_buffer_size,
+			PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+		if (buffers == MAP_FAILED)
+			return false;
+		m_buffers = static_cast<char*>(buffers);
+
+		io_uring_buf_reg reg{};
+		reg.ring_addr = reinterpret_cast<uint64_t>(m_buf_ring);
+		reg.ring_entries = m_buffer_count;
+		reg.bgid = 0;
+		if (ioUringRegister(m_ring_fd, IORING_REGISTER_PBUF_RING, &reg, 1) != 0)
+			return false;
+
+		auto bufs = reinterpret_cast<io_uring_buf*>(m_buf_ring);
+		for (unsigned i = 0; i < m_buffer_count; ++i) {
+			auto& buf = bufs[i];
+			buf.addr = reinterpret_cast<uint64_t>(m_buffers + size_t(i) * m_buffer_size);
+			buf.len = m_buffer_size;
+			buf.bid = i;
+		}
+		m_buf_tail = m_buffer_count;
+		std::atomic_ref<uint16_t>(m_buf_ring->tail).store(m_buf_tail,
+			std::memory_order_release);
+		return true;
+	}
+
+	void IoUring::destroy() noexcept {
+		if (m_buffers)
+			munmap(m_buffers, size_t(m_buffer_count) * m_buffer_size);
+		if (m_buf_ring)
+			munmap(m_buf_ring, m_buf_ring_size);
+		if (m_sqes)
+			munmap(m_sqes, m_sqes_size);
+		if (m_cq_ring && m_cq_ring != m_sq_ring)
+			munmap(m_cq_ring, m_cq_ring_size);
+		if (m_sq_ring)
+			munmap(m_sq_ring, m_sq_ring_size);
+		if (m_ring_fd != -1)
+			close(m_ring_fd);
+
+		m_buffers = nullptr;
+		m_buf_ring = nullptr;
+		m_sqes = nullptr;
+		m_cq_ring = m_sq_ring = nullptr;
+		m_ring_fd = -1;
+	}
+
+	auto IoUring::enter(unsigned to_submit, unsigned flags) noexcept -> int {
+		++m_enter_calls;
+		return static_cast<int>(syscall(__NR_io_uring_enter, m_ring_fd, to_submit, 0,
+			flags, nullptr, 0));
+	}
+
+	void IoUring::submit() noexcept {
+		const auto to_submit = m_sqe_tail - m_sqe_submitted;
+		if (!to_submit)
+			return;
+
+		std::atomic_ref<unsigned>(*m_sq_tail).store(m_sqe_tail, std::memory_order_release);
+		m_sqe_submitted = m_sqe_tail;
+
+		if (sqpoll()) {
+			// The SQ thread went to sleep after m_sqpoll_idle_ms without work.
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if (std::atomic_ref<unsigned>(*m_sq_flags).load(std::memory_order_relaxed) &
+				IORING_SQ_NEED_WAKEUP)
+				enter(0, IORING_ENTER_SQ_WAKEUP);
+			return;
+		}
+
+		ASSERT(enter(to_submit, 0) >= 0, "io_uring_enter() failed error:" +
+			std::string(strerror(errno)));
+	}
+
+	void IoUring::recycleBuffer(uint32_t cqe_flags) noexcept {
+		const auto bid = cqe_flags >> IORING_CQE_BUFFER_SHIFT;
+		auto bufs = reinterpret_cast<io_uring_buf*>(m_buf_ring);
+		auto& buf = bufs[m_buf_tail & (m_buffer_count - 1)];
+		buf.addr = reinterpret_cast<uint64_t>(m_buffers + size_t(bid) * m_buffer_size);
+		buf.len = m_buffer_size;
+		buf.bid = bid;
+		++m_buf_tail;
+		std::atomic_ref<uint16_t>(m_buf_ring->tail).store(m_buf_tail,
+			std::memory_order_release);
+	}
+
+	auto IoUring::getSqe() noexcept -> io_uring_sqe* {
+		// Flush when the SQ ring is full, the kernel frees the slots on submission
+		// (or the SQ thread does, in which case we spin until it caught up).
+		while (m_sqe_tail - std::atomic_ref<unsigned>(*m_sq_head).load(
+			std::memory_order_acquire) >= m_sq_entries) [[unlikely]]
+			submit();
+
+		auto sqe = &m_sqes[m_sqe_tail & m_sq_mask];
+		memset(sqe, 0, sizeof(*sqe));
+		++m_sqe_tail;
+		return sqe;
+	}
+
+	void IoUring::prepAccept(int fd, uint64_t user_data) noexcept {
+		auto sqe = getSqe();
+		sqe->opcode = IORING_OP_ACCEPT;
+		sqe->fd = fd;
+		sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+		sqe->accept_flags = SOCK_NONBLOCK;
+		sqe->user_data = user_data;
+	}
+
+	void IoUring::prepRecv(int fd, uint64_t user_data) noexcept {
+		auto sqe = getSqe();
+		sqe->opcode = IORING_OP_RECV;
+		sqe->fd = fd;
+		sqe->ioprio = IORING_RECV_MULTISHOT;
+		sqe->flags = IOSQE_BUFFER_SELECT;
+		sqe->buf_group = 0;
+		sqe->user_data = user_data;
+	}
+
+	void IoUring::prepRecv(int fd, void* data, size_t len, uint64_t user_data) noexcept {
+		auto sqe = getSqe();
+		sqe->opcode = IORING_OP_RECV;
+		sqe->fd = fd;
+		sqe->addr = reinterpret_cast<uint64_t>(data);
+		sqe->len = static_cast<uint32_t>(std::min<size_t>(len, UINT32_MAX));
+		sqe->user_data = user_data;
+	}
+
+	void IoUring::prepSend(int fd, const void* data, size_t len,
+		uint64_t user_data) noexcept {
+		auto sqe = getSqe();
+		sqe->opcode = IORING_OP_SEND;
+		sqe->fd = fd;
+		sqe->addr = reinterpret_cast<uint64_t>(data);
+		sqe->len = static_cast<uint32_t>(std::min<size_t>(len, UINT32_MAX));
+		sqe->msg_flags = MSG_NOSIGNAL;
+		sqe->user_data = user_data;
+	}
+
+	void IoUring::prepCancel(uint64_t target_user_data) noexcept {
+		auto sqe = getSqe();
+		sqe->opcode = IORING_OP_ASYNC_CANCEL;
+		sqe->fd = -1;
+		sqe->addr = target_user_data;
+		sqe->cancel_flags = IORING_ASYNC_CANCEL_ALL;
+		sqe->user_data = ioUringUserData(nullptr, IoUringOp::CANCEL);
+	}
+}
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <sstream>
+#include <string>
+
+#include <linux/io_uring.h>
+
+#include "common/macros.hpp"
+
+namespace Common {
+
+	struct IoUringCfg {
+		unsigned m_entries = 4096;
+
+		/// Let a kernel thread poll the submission queue so submitting costs no syscall.
+		bool m_sqpoll = false;
+		int m_sqpoll_cpu = -1;
+		unsigned m_sqpoll_idle_ms = 1000;
+
+		/// Provided buffers handed to multishot receives, m_buffer_count must be a power of 2.
+		unsigned m_buffer_count = 64;
+		unsigned m_buffer_size = 64 * 1024;
+
+		auto toString() const {
+			std::stringstream ss;
+			ss << "IoUringCfg[" <<
+				"entries:" << m_entries <<
+				" sqpoll:" << m_sqpoll <<
+				" sqpoll_cpu:" << m_sqpoll_cpu <<
+				" sqpoll_idle_ms:" << m_sqpoll_idle_ms <<
+				" buffer_count:" << m_buffer_count <<
+				" buffer_size:" << m_buffer_size <<
+				"]";
+			return ss.str();
+		}
+	};
+
+	enum class SocketBackend : int8_t {
+		EPOLL = 0,
+		IO_URING = 1
+	};
+
+	/// Process wide socket backend, set once from main() before any socket is created.
+	inline SocketBackend g_socket_backend = SocketBackend::EPOLL;
+	inline IoUringCfg g_io_uring_cfg;
+
+	inline auto useIoUring(const IoUringCfg& cfg) noexcept {
+		g_io_uring_cfg = cfg;
+		g_socket_backend = SocketBackend::IO_URING;
+	}
+
+	enum class IoUringOp : uint8_t {
+		INVALID = 0,
+		ACCEPT = 1,
+		RECV = 2,
+		SEND = 3,
+		CANCEL = 4
+	};
+
+	/// Completions carry the owning object in the upper bits of user_data and the
+	/// operation in the low 3 bits, which are always zero in an aligned pointer.
+	inline auto ioUringUserData(const void* owner, IoUringOp op) noexcept {
+		return reinterpret_cast<uint64_t>(owner) | static_cast<uint64_t>(op);
+	}
+
+	template<typename T>
+	inline auto ioUringOwner(uint64_t user_data) noexcept {
+		return reinterpret_cast<T*>(user_data & ~uint64_t(7));
+	}
+
+	inline auto ioUringOp(uint64_t user_data) noexcept {
+		return static_cast<IoUringOp>(user_data & 7);
+	}
+
+	/// Minimal io_uring instance on top of the raw syscalls. SQEs prepared during
+	/// one loop iteration are submitted together by submit(), and completions are
+	/// read straight from the shared CQ ring, so a thread with nothing to do makes
+	/// no syscalls at all.
+	class IoUring final {
+
+		int m_ring_fd = -1;
+		unsigned m_setup_flags = 0;
+
+		void* m_sq_ring = nullptr;
+		size_t m_sq_ring_size = 0;
+		void* m_cq_ring = nullptr;
+		size_t m_cq_ring_size = 0;
+		io_uring_sqe* m_sqes = nullptr;
+		size_t m_sqes_size = 0;
+
+		unsigned* m_sq_head = nullptr;
+		unsigned* m_sq_tail = nullptr;
+		unsigned* m_sq_flags = nullptr;
+		unsigned m_sq_mask = 0;
+		unsigned m_sq_entries = 0;
+		unsigned m_sqe_tail = 0;
+		unsigned m_sqe_submitted = 0;
+
+		unsigned* m_cq_head = nullptr;
+		unsigned* m_cq_tail = nullptr;
+		unsigned m_cq_mask = 0;
+		io_uring_cqe* m_cqes = nullptr;
+
+		io_uring_buf_ring* m_buf_ring = nullptr;
+		size_t m_buf_ring_size = 0;
+		char* m_buffers = nullptr;
+		unsigned m_buffer_count = 0;
+		unsigned m_buffer_size = 0;
+		uint16_t m_buf_tail = 0;
+
+		size_t m_enter_calls = 0;
+
+		auto enter(unsigned to_submit, unsigned flags) noexcept -> int;
+		auto getSqe() noexcept -> io_uring_sqe*;
+		auto setupBufferRing(const IoUringCfg& cfg) noexcept -> bool;
+		void destroy() noexcept;
+
+	public:
+		/// Check valid() afterwards, setup fails on kernels without io_uring or
+		/// when it is disabled, callers then fall back to epoll / plain syscalls.
+		explicit IoUring(const IoUringCfg& cfg) noexcept;
+		~IoUring();
+
+		IoUring() = delete;
+		IoUring(const IoUring&) = delete;
+		IoUring(const IoUring&&) = delete;
+		IoUring& operator=(const IoUring&) = delete;
+		IoUring& operator=(const IoUring&&) = delete;
+
+		auto valid() const noexcept { return m_ring_fd != -1; }
+		auto sqpoll() const noexcept { return (m_setup_flags & IORING_SETUP_SQPOLL) != 0; }
+		auto enterCalls() const noexcept { return m_enter_calls; }
+		auto bufferSize() const noexcept { return m_buffer_size; }
+
+		void prepAccept(int fd, uint64_t user_data) noexcept;
+		void prepRecv(int fd, uint64_t user_data) noexcept;
+		/// Single receive straight into [data, data + len), no provided buffer.
+		void prepRecv(int fd, void* data, size_t len, uint64_t user_data) noexcept;
+		void prepSend(int fd, const void* data, size_t len, uint64_t user_data) noexcept;
+		/// Cancel every request submitted with target_user_data. Needed before
+		/// close(fd), since a pending multishot request keeps the file open.
+		void prepCancel(uint64_t target_user_data) noexcept;
+
+		/// Hand all SQEs prepared since the last call to the kernel.
+		void submit() noexcept;
+
+		/// Provided buffer a RECV completion landed in, identified by cqe->flags.
+		auto buffer(uint32_t cqe_flags) const noexcept {
+			return m_buffers + size_t(cqe_flags >> IORING_CQE_BUFFER_SHIFT) * m_buffer_size;
+		}
+		/// Give the provided buffer of a RECV completion back to the kernel.
+		void recycleBuffer(uint32_t cqe_flags) noexcept;
+
+		template<typename F>
+		auto forEachCompletion(F&& f) noexcept {
+			// With COOP_TASKRUN the kernel only flags pending work, completions
+			// get posted once this thread enters the kernel.
+			const auto sq_flags = std::atomic_ref<unsigned>(*m_sq_flags).load(
+				std::memory_order_relaxed);
+			if (sq_flags & (IORING_SQ_TASKRUN | IORING_SQ_CQ_OVERFLOW)) [[unlikely]]
+				enter(0, IORING_ENTER_GETEVENTS);
+
+			auto head = *m_cq_head;
+			const auto tail = std::atomic_ref<unsigned>(*m_cq_tail).load(
+				std::memory_order_acquire);
+			size_t n = 0;
+			for (; head != tail; ++head, ++n)
+				f(m_cqes[head & m_cq_mask]);
+			std::atomic_ref<unsigned>(*m_cq_head).store(head, std::memory_order_release);
+			return n;
+		}
+	};
+}
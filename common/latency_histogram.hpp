@@ -0,0 +1,196 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <sstream>
+#include <string>
+
+namespace Common {
+
+	/// Fixed size log-linear (HDR style) histogram of latencies, in ns or TSC
+	/// ticks. Every power of 2 is split into LatencySubBuckets / 2 linear buckets,
+	/// so a value is reported within 1 / 64 of itself, up to 2^LatencyMaxBits.
+	constexpr unsigned LatencySubBucketBits = 7;
+	constexpr uint64_t LatencySubBuckets = uint64_t(1) << LatencySubBucketBits;
+	constexpr unsigned LatencyMaxBits = 40;
+	constexpr uint64_t LatencyMaxValue = (uint64_t(1) << LatencyMaxBits) - 1;
+	constexpr size_t LatencyBuckets = (LatencyMaxBits - LatencySubBucketBits + 2) *
+		(LatencySubBuckets / 2);
+
+	class LatencyRecorder;
+
+	class LatencyHistogram final {
+		friend class LatencyRecorder;
+
+		std::array<uint64_t, LatencyBuckets> m_counts{};
+		uint64_t m_count = 0;
+		uint64_t m_sum = 0;
+		uint64_t m_min = std::numeric_limits<uint64_t>::max();
+		uint64_t m_max = 0;
+
+	public:
+		static constexpr auto bucketIndex(uint64_t value) noexcept -> size_t {
+			value = std::min(value, LatencyMaxValue);
+			if (value < LatencySubBuckets)
+				return value;
+			const unsigned shift = std::bit_width(value) - LatencySubBucketBits;
+			return shift * (LatencySubBuckets / 2) + (value >> shift);
+		}
+
+		/// Lowest value counted in bucket index.
+		static constexpr auto bucketValue(size_t index) noexcept -> uint64_t {
+			if (index < LatencySubBuckets)
+				return index;
+			const unsigned shift = index / (LatencySubBuckets / 2) - 1;
+			return (index - shift * (LatencySubBuckets / 2)) << shift;
+		}
+
+		auto record(uint64_t value) noexcept {
+			++m_counts[bucketIndex(value)];
+			++m_count;
+			m_sum += value;
+			m_min = std::min(m_min, value);
+			m_max = std::max(m_max, value);
+		}
+
+		auto merge(const LatencyHistogram& other) noexcept {
+			for (size_t i = 0; i < LatencyBuckets; ++i)
+				m_counts[i] += other.m_counts[i];
+			m_count += other.m_count;
+			m_sum += other.m_sum;
+			m_min = std::min(m_min, other.m_min);
+			m_max = std::max(m_max, other.m_max);
+		}
+
+		auto reset() noexcept { *this = LatencyHistogram(); }
+
+		auto count() const noexcept { return m_count; }
+		auto min() const noexcept { return m_count ? m_min : 0; }
+		auto max() const noexcept { return m_max; }
+		auto mean() const noexcept { return m_count ? m_sum / m_count : 0; }
+
+		/// Smallest recorded value (to bucket precision) that percentile percent of
+		/// the values do not exceed.
+		auto percentile(double percent) const noexcept -> uint64_t {
+			if (!m_count)
+				return 0;
+			const auto rank = std::max<uint64_t>(1, static_cast<uint64_t>(
+				percent / 100.0 * m_count + 0.5));
+			uint64_t seen = 0;
+			for (size_t i = 0; i < LatencyBuckets; ++i) {
+				seen += m_counts[i];
+				if (seen >= rank)
+					return std::clamp(bucketValue(i), min(), m_max);
+			}
+			return m_max;
+		}
+
+		/// Values are divided by scale on export, e.g. TSC ticks per ns to report
+		/// ns from a histogram of tick deltas.
+		auto toString(double scale = 1) const {
+			std::stringstream ss;
+			ss << "count=" << count() <<
+				" min=" << scaled(min(), scale) <<
+				" mean=" << scaled(mean(), scale) <<
+				" p50=" << scaled(percentile(50), scale) <<
+				" p90=" << scaled(percentile(90), scale) <<
+				" p99=" << scaled(percentile(99), scale) <<
+				" p99.9=" << scaled(percentile(99.9), scale) <<
+				" max=" << scaled(max(), scale);
+			return ss.str();
+		}
+
+		static auto csvHeader() -> std::string {
+			return "name,count,min,mean,p50,p90,p99,p99.9,max";
+		}
+
+		auto toCsv(const std::string& name, double scale = 1) const {
+			std::stringstream ss;
+			ss << name << "," << count() << "," <<
+				scaled(min(), scale) << "," <<
+				scaled(mean(), scale) << "," <<
+				scaled(percentile(50), scale) << "," <<
+				scaled(percentile(90), scale) << "," <<
+				scaled(percentile(99), scale) << "," <<
+				scaled(percentile(99.9), scale) << "," <<
+				scaled(max(), scale);
+			return ss.str();
+		}
+
+		/// One "value,count" line per non empty bucket, to plot the distribution.
+		auto bucketsToCsv(double scale = 1) const {
+			std::stringstream ss;
+			ss << "value,count\n";
+			for (size_t i = 0; i < LatencyBuckets; ++i) {
+				if (m_counts[i])
+					ss << scaled(bucketValue(i), scale) << "," << m_counts[i] << "\n";
+			}
+			return ss.str();
+		}
+
+	private:
+		static auto scaled(uint64_t value, double scale) noexcept -> uint64_t {
+			return static_cast<uint64_t>(value / scale + 0.5);
+		}
+	};
+
+	/// LatencyHistogram for a hot loop: recorded by its thread only, with plain
+	/// relaxed loads and stores, no locked instructions, and read concurrently by
+	/// any thread through snapshot(). A snapshot taken mid record() may miss the
+	/// value in flight, its count is the sum of the buckets it saw.
+	class LatencyRecorder final {
+		std::array<std::atomic<uint64_t>, LatencyBuckets> m_counts{};
+		std::atomic<uint64_t> m_sum = 0;
+		std::atomic<uint64_t> m_min = std::numeric_limits<uint64_t>::max();
+		std::atomic<uint64_t> m_max = 0;
+
+		static auto bump(std::atomic<uint64_t>& counter, uint64_t value) noexcept {
+			counter.store(counter.load(std::memory_order_relaxed) + value,
+				std::memory_order_relaxed);
+		}
+
+	public:
+		LatencyRecorder() = default;
+
+		LatencyRecorder(const LatencyRecorder&) = delete;
+		LatencyRecorder(const LatencyRecorder&&) = delete;
+		LatencyRecorder& operator=(const LatencyRecorder&) = delete;
+		LatencyRecorder& operator=(const LatencyRecorder&&) = delete;
+
+		/// Writer thread only.
+		auto record(uint64_t value) noexcept {
+			bump(m_counts[LatencyHistogram::bucketIndex(value)], 1);
+			bump(m_sum, value);
+			if (value < m_min.load(std::memory_order_relaxed)) [[unlikely]]
+				m_min.store(value, std::memory_order_relaxed);
+			if (value > m_max.load(std::memory_order_relaxed)) [[unlikely]]
+				m_max.store(value, std::memory_order_relaxed);
+		}
+
+		/// Any thread, adds what was recorded so far to histogram.
+		auto mergeInto(LatencyHistogram& histogram) const noexcept {
+			uint64_t count = 0;
+			for (size_t i = 0; i < LatencyBuckets; ++i) {
+				const auto bucket_count = m_counts[i].load(std::memory_order_relaxed);
+				histogram.m_counts[i] += bucket_count;
+				count += bucket_count;
+			}
+			if (!count)
+				return;
+			histogram.m_count += count;
+			histogram.m_sum += m_sum.load(std::memory_order_relaxed);
+			histogram.m_min = std::min(histogram.m_min, m_min.load(std::memory_order_relaxed));
+			histogram.m_max = std::max(histogram.m_max, m_max.load(std::memory_order_relaxed));
+		}
+
+		auto snapshot() const noexcept {
+			LatencyHistogram histogram;
+			mergeInto(histogram);
+			return histogram;
+		}
+	};
+}
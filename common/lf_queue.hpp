@@ -29,9 +29,24 @@ namespace Common {
 			return &m_store[m_next_write_index];
 		}
 
+		/// Slot offset elements past the next one to write, see updateWriteIndex(count).
+		auto getNextToWriteTo(size_t offset) noexcept {
+			return &m_store[(m_next_write_index + offset) % m_store.size()];
+		}
+
+		/// Counts the element before publishing it, a reader that sees the new index
+		/// must not find m_num_elements still at zero.
 		auto updateWriteIndex() noexcept {
-			m_next_write_index = (m_next_write_index + 1) % m_store.size();
 			m_num_elements++;
+			m_next_write_index = (m_next_write_index + 1) % m_store.size();
+		}
+
+		/// Publishes count elements written through getNextToWriteTo(offset) at once.
+		auto updateWriteIndex(size_t count) noexcept {
+			if (!count)
+				return;
+			m_num_elements += count;
+			m_next_write_index = (m_next_write_index + count) % m_store.size();
 		}
 
 		const T* getNextToRead() const noexcept {
@@ -39,6 +54,12 @@ namespace Common {
 				nullptr : &m_store[m_next_read_index];
 		}
 
+		/// Peeks offset elements past the next one to read, without consuming anything.
+		const T* getNextToRead(size_t offset) const noexcept {
+			return (offset >= m_num_elements) ?
+				nullptr : &m_store[(m_next_read_index + offset) % m_store.size()];
+		}
+
 		auto updateReadIndex() noexcept {
 			m_next_read_index = (m_next_read_index + 1) % m_store.size();
 			ASSERT(m_num_elements != 0, "Read and invalid element in: " +
@@ -46,8 +67,23 @@ namespace Common {
 			m_num_elements--;
 		}
 
+		auto updateReadIndex(size_t count) noexcept {
+			if (!count)
+				return;
+			m_next_read_index = (m_next_read_index + count) % m_store.size();
+			ASSERT(m_num_elements >= count, "Read and invalid element in: " +
+				std::to_string(pthread_self()));
+			m_num_elements -= count;
+		}
+
 		auto size() const noexcept {
 			return m_num_elements.load();
 		}
+
+		/// A queue holding capacity() elements looks empty to getNextToRead(), so at
+		/// most capacity() - 1 can be outstanding.
+		auto capacity() const noexcept {
+			return m_store.size();
+		}
 	};
 }
\ No newline at end of file
@@ -31,7 +31,10 @@ namespace Common {
 	};
 
 	class Logger final {
+		static inline std::atomic<bool> s_enabled = true;
+
 		const std::string m_file_name;
+		const bool m_enabled;
 		std::ofstream m_file;
 		LFQueue<LogElement> m_queue;
 		std::atomic<bool> m_running = true;
@@ -85,8 +88,17 @@ namespace Common {
 				std::this_thread::sleep_for(1ms);
 			}
 		}
+		/// Loggers created while disabled open no file, start no thread and drop
+		/// everything, for backtests where logging would cost more than the rest.
+		static void setEnabled(bool enabled) noexcept {
+			s_enabled = enabled;
+		}
+
 		explicit Logger(const std::string& file_name) :
-			m_file_name(file_name), m_queue(LOG_QUEUE_SIZE) {
+			m_file_name(file_name), m_enabled(s_enabled),
+			m_queue(m_enabled ? LOG_QUEUE_SIZE : 1) {
+			if (!m_enabled)
+				return;
 			m_file.open(m_file_name);
 			m_logger_thread = createAndStartThread(-1, "Common/Logger",
 				[this]() { flushQueue(); });
@@ -94,6 +106,8 @@ namespace Common {
 		}
 
 		~Logger() {
+			if (!m_enabled)
+				return;
 			std::cerr << "Flushing and closing Logger for " << m_file_name << std::endl;
 			while (m_queue.size()) {
 				using namespace std::literals::chrono_literals;
@@ -105,6 +119,11 @@ namespace Common {
 			m_file.close();
 		}
 
+		/// Elements not written to the file yet.
+		auto pendingSize() const noexcept {
+			return m_queue.size();
+		}
+
 		auto pushValue(const LogElement& log_element) noexcept {
 			*(m_queue.getNextToWriteTo()) = log_element;
 			m_queue.updateWriteIndex();
@@ -159,6 +178,8 @@ namespace Common {
 
 		template<typename T, typename... A>
 		auto log(const char* s, const T& value, A... args) noexcept {
+			if (!m_enabled) [[unlikely]]
+				return;
 			while (*s) {
 				if (*s == '%') {
 					if (*(s + 1) == '%') [[unlikely]] {
@@ -175,6 +196,8 @@ namespace Common {
 			FATAL("Extra arguments provided to log()");
 		}
 		auto log(const char* s) noexcept {
+			if (!m_enabled) [[unlikely]]
+				return;
 			while (*s) {
 				if (*s == '%') {
 					if (*(s + 1) == '%') [[unlikely]] {
@@ -5,7 +5,25 @@ namespace Common {
     /// Does not join the multicast stream yet.
     int McastSocket::init(const std::string& ip, const std::string& iface, int port, bool is_listening) {
         const SocketCfg socket_cfg{  };
-        m_socket_fd = createSocket(m_logger, ip, iface, port, true, false, is_listening, 0, false);
+        m_socket_fd = createSocket(m_logger, ip, iface, port, true, false, is_listening, 0,
+            /*needs_so_timestamp*/ is_listening);
+
+        if (m_socket_fd != -1 && g_socket_backend == SocketBackend::IO_URING) {
+            if (!m_io_uring) {
+                m_io_uring = new IoUring(g_io_uring_cfg);
+                if (!m_io_uring->valid()) {
+                    m_logger.log("%:% %() % io_uring setup failed errno:%, falling back to"
+                        " recv/send.\n", __FILE__, __LINE__, __FUNCTION__,
+                        Common::getCurrentTimeStr(&m_time_str), strerror(errno));
+                    delete m_io_uring;
+                    m_io_uring = nullptr;
+                }
+            }
+            if (m_io_uring && is_listening) {
+                m_io_uring->prepRecv(m_socket_fd, ioUringUserData(this, IoUringOp::RECV));
+                m_io_uring->submit();
+            }
+        }
         return m_socket_fd;
     }
 
@@ -16,41 +34,195 @@ namespace Common {
 
     /// Remove / Leave membership / subscription to a multicast stream.
     void McastSocket::leave(const std::string&, int) {
+        if (m_io_uring && m_socket_fd != -1) {
+            m_io_uring->prepCancel(ioUringUserData(this, IoUringOp::RECV));
+            m_io_uring->submit();
+        }
         close(m_socket_fd);
         m_socket_fd = -1;
     }
 
     /// Publish outgoing data and read incoming data.
     bool McastSocket::sendAndRecv() noexcept {
-        // Read data and dispatch callbacks if data is available - non blocking.
-        const ssize_t n_rcv = recv(m_socket_fd, m_inbound_data.data() + m_next_recv_valid_index, 
-            McastBufferSize - m_next_recv_valid_index, MSG_DONTWAIT);
+        if (m_io_uring) {
+            m_io_uring->forEachCompletion([this](const io_uring_cqe& cqe) {
+                onIoUringCompletion(cqe); });
+
+            const auto received = m_inbound_count > 0;
+            dispatchInbound();
+
+            if (!m_send_in_flight && m_outbound_head < m_outbound_count) {
+                m_outbound_packet_open = false;
+                for (auto i = m_outbound_head; i < m_outbound_count; ++i) {
+                    m_io_uring->prepSend(m_socket_fd, outboundPacket(i), m_outbound_lens[i],
+                        ioUringUserData(this, IoUringOp::SEND));
+                }
+                m_send_in_flight = m_outbound_count - m_outbound_head;
+                m_outbound_head = m_outbound_count;
+            }
+            m_io_uring->submit();
+            return received;
+        }
+
+        // Read a batch of packets and dispatch callbacks if data is available - non blocking.
+        for (size_t i = 0; i < McastMaxBatch; ++i) {
+            auto packet = m_inbound_data.data() + i * McastMaxPacketSize;
+            m_inbound_packets[i] = packet;
+            m_iovs[i] = { packet, McastMaxPacketSize };
+            auto& hdr = m_mmsgs[i].msg_hdr;
+            hdr = {};
+            hdr.msg_iov = &m_iovs[i];
+            hdr.msg_iovlen = 1;
+            hdr.msg_control = m_ctrls[i].data();
+            hdr.msg_controllen = m_ctrls[i].size();
+        }
+        const int n_rcv = recvmmsg(m_socket_fd, m_mmsgs.data(), McastMaxBatch,
+            MSG_DONTWAIT, nullptr);
         if (n_rcv > 0) {
-            m_next_recv_valid_index += n_rcv;
-            m_logger.log("%:% %() % read socket:% len:%\n", __FILE__, __LINE__, __FUNCTION__, 
-                Common::getCurrentTimeStr(&m_time_str), m_socket_fd,
-                m_next_recv_valid_index);
+            const auto user_time = getCurrentNanos();
+            for (int i = 0; i < n_rcv; ++i) {
+                m_inbound_lens[i] = m_mmsgs[i].msg_len;
+                const auto rx_time = rxTimestamp(m_mmsgs[i].msg_hdr);
+                m_inbound_times[i] = rx_time ? rx_time : user_time;
+            }
+            m_inbound_count = n_rcv;
+            m_logger.log("%:% %() % read socket:% packets:% utime:% ktime:%\n", __FILE__,
+                __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&m_time_str), m_socket_fd,
+                n_rcv, user_time, m_inbound_times[0]);
+            dispatchInbound();
+        }
+
+        // Publish the queued packets to the multicast stream.
+        flushSendMmsg();
+
+        return (n_rcv > 0);
+    }
+
+    void McastSocket::dispatchInbound() noexcept {
+        if (m_inbound_count) {
+            if (g_tracing) [[unlikely]] {
+                for (size_t i = 0; i < m_inbound_count; ++i)
+                    trace(TraceHop::MCAST_RECV, m_inbound_times[i]);
+            }
             m_recv_callback(this);
+            if (m_io_uring) {
+                for (size_t i = 0; i < m_inbound_count; ++i)
+                    m_io_uring->recycleBuffer(m_inbound_buffers[i]);
+            }
+            m_inbound_count = 0;
         }
+    }
 
-        // Publish market data in the send buffer to the multicast stream.
-        if (m_next_send_valid_index > 0) {
-            ssize_t n = ::send(m_socket_fd, m_outbound_data.data(), 
-                m_next_send_valid_index, MSG_DONTWAIT | MSG_NOSIGNAL);
+    void McastSocket::flushSendMmsg() noexcept {
+        m_outbound_packet_open = false;
 
-            m_logger.log("%:% %() % send socket:% len:%\n", __FILE__, __LINE__, __FUNCTION__, 
-                Common::getCurrentTimeStr(&m_time_str), m_socket_fd, n);
+        while (m_outbound_head < m_outbound_count) {
+            const auto n = std::min(McastMaxBatch, m_outbound_count - m_outbound_head);
+            for (size_t i = 0; i < n; ++i) {
+                m_iovs[i] = { outboundPacket(m_outbound_head + i),
+                    m_outbound_lens[m_outbound_head + i] };
+                m_mmsgs[i].msg_hdr = {};
+                m_mmsgs[i].msg_hdr.msg_iov = &m_iovs[i];
+                m_mmsgs[i].msg_hdr.msg_iovlen = 1;
+            }
+
+            const int n_sent = sendmmsg(m_socket_fd, m_mmsgs.data(), n,
+                MSG_DONTWAIT | MSG_NOSIGNAL);
+            m_logger.log("%:% %() % send socket:% packets:% sent:%\n", __FILE__, __LINE__,
+                __FUNCTION__, Common::getCurrentTimeStr(&m_time_str), m_socket_fd, n, n_sent);
+
+            // Whatever the kernel did not take stays queued for the next call.
+            if (n_sent <= 0)
+                break;
+            m_outbound_head += n_sent;
+            if (static_cast<size_t>(n_sent) < n)
+                break;
         }
-        m_next_send_valid_index = 0;
 
-        return (n_rcv > 0);
+        reclaimOutbound();
+    }
+
+    /// Moves the packets not handed to the kernel yet down to slot 0, once the
+    /// kernel is done with the ones before them.
+    void McastSocket::reclaimOutbound() noexcept {
+        if (!m_outbound_head)
+            return;
+
+        const auto num_queued = m_outbound_count - m_outbound_head;
+        for (size_t i = 0; i < num_queued; ++i) {
+            memmove(outboundPacket(i), outboundPacket(m_outbound_head + i),
+                m_outbound_lens[m_outbound_head + i]);
+            m_outbound_lens[i] = m_outbound_lens[m_outbound_head + i];
+        }
+        m_outbound_head = 0;
+        m_outbound_count = num_queued;
     }
 
-    /// Copy data to send buffers - does not send them out yet.
+    /// Copy a message into the open outgoing packet - does not send it out yet.
     void McastSocket::send(const void* data, size_t len) noexcept {
-        memcpy(m_outbound_data.data() + m_next_send_valid_index, data, len);
-        m_next_send_valid_index += len;
-        ASSERT(m_next_send_valid_index < McastBufferSize, 
-            "Mcast socket buffer filled up and sendAndRecv() not called.");
+        ASSERT(len <= m_max_packet_size, "Mcast message of " + std::to_string(len) +
+            " bytes exceeds packet size " + std::to_string(m_max_packet_size));
+
+        if (!m_outbound_packet_open ||
+            m_outbound_lens[m_outbound_count - 1] + len > m_max_packet_size) {
+            ASSERT(m_outbound_count < m_outbound_lens.size(),
+                "Mcast socket buffer filled up and sendAndRecv() not called.");
+            m_outbound_lens[m_outbound_count++] = 0;
+            m_outbound_packet_open = true;
+        }
+
+        auto& packet_len = m_outbound_lens[m_outbound_count - 1];
+        memcpy(outboundPacket(m_outbound_count - 1) + packet_len, data, len);
+        packet_len += len;
+    }
+
+    void McastSocket::setMaxPacketSize(size_t max_packet_size) noexcept {
+        ASSERT(!m_outbound_count, "Mcast packet size changed with packets queued.");
+        ASSERT(max_packet_size && max_packet_size <= McastMaxPacketSize,
+            "Invalid mcast packet size: " + std::to_string(max_packet_size));
+        m_max_packet_size = max_packet_size;
+        m_outbound_lens.resize(McastBufferSize / m_max_packet_size);
+    }
+
+    void McastSocket::onIoUringCompletion(const io_uring_cqe& cqe) noexcept {
+        switch (ioUringOp(cqe.user_data)) {
+        case IoUringOp::RECV:
+            if (cqe.res > 0 && (cqe.flags & IORING_CQE_F_BUFFER)) {
+                // Hand a full batch over before taking more packets.
+                if (m_inbound_count == McastMaxBatch) [[unlikely]]
+                    dispatchInbound();
+                // Read in place, the buffer is recycled once the batch is dispatched.
+                m_inbound_packets[m_inbound_count] = m_io_uring->buffer(cqe.flags);
+                m_inbound_buffers[m_inbound_count] = cqe.flags;
+                m_inbound_lens[m_inbound_count] = cqe.res;
+                m_inbound_times[m_inbound_count] = getCurrentNanos();
+                ++m_inbound_count;
+                m_logger.log("%:% %() % read socket:% len:%\n", __FILE__, __LINE__,
+                    __FUNCTION__, Common::getCurrentTimeStr(&m_time_str), m_socket_fd, cqe.res);
+            }
+            else if (cqe.flags & IORING_CQE_F_BUFFER) {
+                m_io_uring->recycleBuffer(cqe.flags);
+            }
+            if (!(cqe.flags & IORING_CQE_F_MORE) && cqe.res != -ECANCELED &&
+                m_socket_fd != -1)
+                m_io_uring->prepRecv(m_socket_fd, ioUringUserData(this, IoUringOp::RECV));
+            break;
+        case IoUringOp::SEND:
+            m_logger.log("%:% %() % send socket:% len:%\n", __FILE__, __LINE__, __FUNCTION__,
+                Common::getCurrentTimeStr(&m_time_str), m_socket_fd, cqe.res);
+            if (cqe.res < 0 && cqe.res != -ECANCELED) [[unlikely]] {
+                ++m_send_failures;
+                m_logger.log("%:% %() % send socket:% failed errno:% failures:%\n", __FILE__,
+                    __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&m_time_str),
+                    m_socket_fd, strerror(-cqe.res), m_send_failures);
+            }
+            // Slots are reused once the whole submission completed, packets
+            // queued meanwhile move down and go out with the next flush.
+            if (!--m_send_in_flight)
+                reclaimOutbound();
+            break;
+        default:
+            break;
+        }
     }
-}
\ No newline at end of file
+}
@@ -1,10 +1,13 @@
 #pragma once
 
+#include <array>
 #include <functional>
 #include <vector>
 #include <string>
 
 #include "common/socket_utils.hpp"
+#include "common/io_uring.hpp"
+#include "common/trace.hpp"
 
 #include "common/logging.hpp"
 
@@ -12,11 +15,24 @@ namespace Common {
     /// Size of send and receive buffers in bytes.
     constexpr size_t McastBufferSize = 64 * 1024 * 1024;
 
+    /// Largest UDP payload over IPv4.
+    constexpr size_t McastMaxPacketSize = 65507;
+    /// UDP payload that fits a 1500 byte Ethernet frame without fragmentation.
+    constexpr size_t McastDefaultPacketSize = 1472;
+    /// Packets moved by a single sendmmsg() / recvmmsg() call.
+    constexpr size_t McastMaxBatch = 64;
+
     struct McastSocket {
         McastSocket(Logger& logger)
             : m_logger(logger) {
             m_outbound_data.resize(McastBufferSize);
-            m_inbound_data.resize(McastBufferSize);
+            m_inbound_data.resize(McastMaxBatch * McastMaxPacketSize);
+            setMaxPacketSize(McastDefaultPacketSize);
+        }
+
+        ~McastSocket() {
+            delete m_io_uring;
+            m_io_uring = nullptr;
         }
 
         /// Initialize multicast socket to read from or publish to a stream.
@@ -32,21 +48,80 @@ namespace Common {
         /// Publish outgoing data and read incoming data.
         bool sendAndRecv() noexcept;
 
-        /// Copy data to send buffers - does not send them out yet.
+        /// Copy a message into the open outgoing packet - does not send it out yet.
+        /// A message never straddles two packets, one that does not fit in the
+        /// open packet starts a new one.
         void send(const void* data, size_t len) noexcept;
 
+        /// Next send() starts a new packet.
+        void closePacket() noexcept { m_outbound_packet_open = false; }
+
+        /// Open outgoing packet, nullptr if the next send() starts a new one.
+        char* openPacket() noexcept {
+            return m_outbound_packet_open ?
+                outboundPacket(m_outbound_count - 1) : nullptr;
+        }
+        size_t openPacketSize() const noexcept {
+            return m_outbound_packet_open ? m_outbound_lens[m_outbound_count - 1] : 0;
+        }
+
+        /// Only valid while no packets are queued.
+        void setMaxPacketSize(size_t max_packet_size) noexcept;
+
+        /// Packets read by the last sendAndRecv(), valid inside m_recv_callback.
+        size_t numInboundPackets() const noexcept { return m_inbound_count; }
+        const char* inboundPacket(size_t i) const noexcept { return m_inbound_packets[i]; }
+        size_t inboundPacketSize(size_t i) const noexcept { return m_inbound_lens[i]; }
+        /// NIC or kernel receive time with the epoll backend, see rxTimestamp(),
+        /// time of reaping with io_uring.
+        Nanos inboundPacketTime(size_t i) const noexcept { return m_inbound_times[i]; }
+
+        void onIoUringCompletion(const io_uring_cqe& cqe) noexcept;
+
         int m_socket_fd = -1;
 
-        /// Send and receive buffers, typically only one or the other is needed, not both.
+        /// Outgoing packets, stored back to back in m_max_packet_size slots.
         std::vector<char> m_outbound_data;
-        size_t m_next_send_valid_index = 0;
+        std::vector<size_t> m_outbound_lens;
+        size_t m_max_packet_size = 0;
+        size_t m_outbound_head = 0;
+        size_t m_outbound_count = 0;
+        bool m_outbound_packet_open = false;
+
+        /// Incoming packets of the current batch read by recvmmsg(), in
+        /// McastMaxPacketSize slots.
         std::vector<char> m_inbound_data;
-        size_t m_next_recv_valid_index = 0;
+        /// Start of each incoming packet. With io_uring that is the provided buffer
+        /// it landed in, m_inbound_buffers says which, given back once dispatched.
+        std::array<const char*, McastMaxBatch> m_inbound_packets;
+        std::array<uint32_t, McastMaxBatch> m_inbound_buffers;
+        std::array<size_t, McastMaxBatch> m_inbound_lens;
+        std::array<Nanos, McastMaxBatch> m_inbound_times;
+        size_t m_inbound_count = 0;
+
+        std::array<mmsghdr, McastMaxBatch> m_mmsgs;
+        std::array<iovec, McastMaxBatch> m_iovs;
+        std::array<std::array<char, RxTimestampCtrlSize>, McastMaxBatch> m_ctrls;
+
+        /// Owned ring when the io_uring backend is selected, see useIoUring().
+        IoUring* m_io_uring = nullptr;
+        /// Packets before m_outbound_head handed to the kernel and not completed yet.
+        size_t m_send_in_flight = 0;
+        /// Packets io_uring completed with an error, they are not sent again.
+        size_t m_send_failures = 0;
 
         /// Function wrapper for the method to call when data is read.
         std::function<void(McastSocket* s)> m_recv_callback = nullptr;
 
         std::string m_time_str;
         Logger& m_logger;
+
+    private:
+        char* outboundPacket(size_t i) noexcept {
+            return m_outbound_data.data() + i * m_max_packet_size;
+        }
+        void dispatchInbound() noexcept;
+        void flushSendMmsg() noexcept;
+        void reclaimOutbound() noexcept;
     };
-}
\ No newline at end of file
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <vector>
 #include <string>
 
@@ -15,6 +16,8 @@ namespace Common {
 
 		std::vector<ObjectBlock> m_store;
 		size_t m_next_free_index = 0;
+		/// Objects allocated, written by the owning thread and read by monitoring.
+		std::atomic<size_t> m_num_used = 0;
 
 		MemPool() = delete;
 		MemPool(const MemPool&) = delete;
@@ -50,6 +53,8 @@ namespace Common {
 			T* ret = &(obj_block->m_object);
 			ret = new(ret) T(args...);
 			obj_block->m_is_free = false;
+			m_num_used.store(m_num_used.load(std::memory_order_relaxed) + 1,
+				std::memory_order_relaxed);
 			updateNextFreeIndex();
 
 			return ret;
@@ -62,6 +67,19 @@ namespace Common {
 			ASSERT(!m_store[elem_index].m_is_free, 
 				"Expected in-use ObjectoBlock at index: " + std::to_string(elem_index));
 			m_store[elem_index].m_is_free = true;
+			m_num_used.store(m_num_used.load(std::memory_order_relaxed) - 1,
+				std::memory_order_relaxed);
 		}
+
+		/// Hands out the store from its start again, once every object is back, so
+		/// a reused pool touches the same memory as a new one.
+		auto reset() noexcept {
+			ASSERT(!numUsed(), "Memory Pool reset with " + std::to_string(numUsed()) +
+				" objects in use.");
+			m_next_free_index = 0;
+		}
+
+		auto numUsed() const noexcept { return m_num_used.load(std::memory_order_relaxed); }
+		auto capacity() const noexcept { return m_store.size(); }
 	};
 }
\ No newline at end of file
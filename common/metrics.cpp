@@ -0,0 +1,173 @@
+#include "common/metrics.hpp"
+
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "common/thread_utils.hpp"
+
+namespace Common {
+
+	MetricsRegistry::MetricsRegistry(const std::string& name) : m_name("/" + name) {
+		const auto fd = shm_open(m_name.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0644);
+		ASSERT(fd != -1, "shm_open() failed for " + m_name + " error:" +
+			std::string(strerror(errno)));
+		ASSERT(ftruncate(fd, sizeof(MetricsPage)) == 0, "ftruncate() failed for " +
+			m_name + " error:" + std::string(strerror(errno)));
+
+		auto page = mmap(nullptr, sizeof(MetricsPage), PROT_READ | PROT_WRITE, MAP_SHARED,
+			fd, 0);
+		close(fd);
+		ASSERT(page != MAP_FAILED, "mmap() failed for " + m_name + " error:" +
+			std::string(strerror(errno)));
+
+		m_page = new(page) MetricsPage();
+		m_page->m_header.m_pid = getpid();
+	}
+
+	MetricsRegistry::~MetricsRegistry() {
+		stop();
+		munmap(m_page, sizeof(MetricsPage));
+		m_page = nullptr;
+		shm_unlink(m_name.c_str());
+	}
+
+	auto MetricsRegistry::addSlot(const std::string& name, MetricType type) -> MetricSlot* {
+		ASSERT(!m_run, "Metric " + name + " registered after start().");
+		auto& num_metrics = m_page->m_header.m_num_metrics;
+		const auto index = num_metrics.load(std::memory_order_relaxed);
+		ASSERT(index < MetricsMaxMetrics, "No metrics slot left for " + name);
+
+		auto slot = &m_page->m_slots[index];
+		slot->m_type = type;
+		strncpy(slot->m_name, name.c_str(), MetricNameSize - 1);
+		num_metrics.store(index + 1, std::memory_order_release);
+		return slot;
+	}
+
+	void MetricsRegistry::addCounter(const std::string& name, const MetricCounter* counter) {
+		m_sources.push_back({ addSlot(name, MetricType::COUNTER),
+			[counter]() { return counter->value(); }, nullptr, 1 });
+	}
+
+	void MetricsRegistry::addGauge(const std::string& name, std::function<uint64_t()> value) {
+		m_sources.push_back({ addSlot(name, MetricType::GAUGE), std::move(value), nullptr, 1 });
+	}
+
+	void MetricsRegistry::addHistogram(const std::string& name,
+		const LatencyRecorder* recorder, double scale) {
+		m_sources.push_back({ addSlot(name, MetricType::HISTOGRAM), nullptr, recorder, scale });
+	}
+
+	void MetricsRegistry::start(int core_id, Nanos interval) {
+		m_interval = interval;
+		m_run = true;
+		m_thread = createAndStartThread(core_id, "Common/MetricsRegistry " + m_name,
+			[this]() { run(); });
+		ASSERT(m_thread != nullptr, "Failed to start MetricsRegistry thread.");
+	}
+
+	void MetricsRegistry::stop() {
+		if (!m_thread)
+			return;
+		m_run = false;
+		m_thread->join();
+		delete m_thread;
+		m_thread = nullptr;
+	}
+
+	void MetricsRegistry::run() noexcept {
+		while (m_run) {
+			sample();
+			std::this_thread::sleep_for(std::chrono::nanoseconds(m_interval));
+		}
+		sample();
+	}
+
+	void MetricsRegistry::sample() noexcept {
+		for (const auto& source : m_sources) {
+			uint64_t values[METRIC_VALUES] = {};
+			if (source.m_recorder) {
+				const auto histogram = source.m_recorder->snapshot();
+				const auto scaled = [&source](uint64_t value) {
+					return static_cast<uint64_t>(value / source.m_scale + 0.5);
+				};
+				values[METRIC_COUNT] = histogram.count();
+				values[METRIC_MIN] = scaled(histogram.min());
+				values[METRIC_MEAN] = scaled(histogram.mean());
+				values[METRIC_P50] = scaled(histogram.percentile(50));
+				values[METRIC_P90] = scaled(histogram.percentile(90));
+				values[METRIC_P99] = scaled(histogram.percentile(99));
+				values[METRIC_P999] = scaled(histogram.percentile(99.9));
+				values[METRIC_MAX] = scaled(histogram.max());
+			}
+			else {
+				values[0] = source.m_value();
+			}
+
+			auto slot = source.m_slot;
+			const auto seq = slot->m_seq.load(std::memory_order_relaxed);
+			slot->m_seq.store(seq + 1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+			for (size_t i = 0; i < METRIC_VALUES; ++i)
+				std::atomic_ref<uint64_t>(slot->m_values[i]).store(values[i],
+					std::memory_order_relaxed);
+			slot->m_seq.store(seq + 2, std::memory_order_release);
+		}
+		m_page->m_header.m_sample_time.store(getCurrentNanos(), std::memory_order_release);
+	}
+
+	MetricsReader::MetricsReader(const std::string& name) {
+		const auto fd = shm_open(("/" + name).c_str(), O_RDONLY, 0);
+		if (fd == -1)
+			return;
+
+		auto page = mmap(nullptr, sizeof(MetricsPage), PROT_READ, MAP_SHARED, fd, 0);
+		close(fd);
+		if (page == MAP_FAILED)
+			return;
+
+		m_page = static_cast<const MetricsPage*>(page);
+		if (memcmp(m_page->m_header.m_magic, MetricsPageHeader().m_magic,
+			sizeof(m_page->m_header.m_magic))) {
+			munmap(page, sizeof(MetricsPage));
+			m_page = nullptr;
+		}
+	}
+
+	MetricsReader::~MetricsReader() {
+		if (m_page)
+			munmap(const_cast<MetricsPage*>(m_page), sizeof(MetricsPage));
+	}
+
+	auto MetricsReader::read() const -> std::vector<MetricValue> {
+		std::vector<MetricValue> metrics;
+		const auto num_metrics = std::min<uint64_t>(MetricsMaxMetrics,
+			m_page->m_header.m_num_metrics.load(std::memory_order_acquire));
+		metrics.resize(num_metrics);
+
+		for (size_t i = 0; i < num_metrics; ++i) {
+			const auto& slot = m_page->m_slots[i];
+			auto& metric = metrics[i];
+			metric.m_type = slot.m_type;
+			metric.m_name.assign(slot.m_name, strnlen(slot.m_name, MetricNameSize));
+
+			// The const_cast is for atomic_ref, the values are only loaded.
+			auto values = const_cast<uint64_t*>(slot.m_values);
+			while (true) {
+				const auto seq = slot.m_seq.load(std::memory_order_acquire);
+				if (seq & 1) [[unlikely]]
+					continue;
+				for (size_t j = 0; j < METRIC_VALUES; ++j)
+					metric.m_values[j] = std::atomic_ref<uint64_t>(values[j]).load(
+						std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_acquire);
+				if (slot.m_seq.load(std::memory_order_relaxed) == seq)
+					break;
+			}
+		}
+		return metrics;
+	}
+}
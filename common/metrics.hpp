@@ -0,0 +1,155 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common/latency_histogram.hpp"
+#include "common/macros.hpp"
+#include "common/time_utils.hpp"
+
+namespace Common {
+
+	/// Event count bumped by a single thread, read by the metrics sampler.
+	class MetricCounter final {
+		std::atomic<uint64_t> m_value = 0;
+
+	public:
+		auto inc(uint64_t n = 1) noexcept {
+			m_value.store(m_value.load(std::memory_order_relaxed) + n,
+				std::memory_order_relaxed);
+		}
+
+		auto value() const noexcept { return m_value.load(std::memory_order_relaxed); }
+	};
+
+	enum class MetricType : uint8_t {
+		INVALID = 0,
+		/// Monotonic, llstat shows its rate too.
+		COUNTER = 1,
+		GAUGE = 2,
+		/// Latency summary in ns, see MetricHistogramValue.
+		HISTOGRAM = 3
+	};
+
+	inline std::string metricTypeToString(MetricType type) {
+		switch (type) {
+		case MetricType::COUNTER: return "COUNTER";
+		case MetricType::GAUGE: return "GAUGE";
+		case MetricType::HISTOGRAM: return "HISTOGRAM";
+		case MetricType::INVALID: return "INVALID";
+		}
+		return "UNKNOWN";
+	}
+
+	/// Index into MetricSlot::m_values of a HISTOGRAM, COUNTER and GAUGE only use
+	/// the first value.
+	enum MetricHistogramValue : size_t {
+		METRIC_COUNT = 0, METRIC_MIN, METRIC_MEAN, METRIC_P50, METRIC_P90,
+		METRIC_P99, METRIC_P999, METRIC_MAX, METRIC_VALUES
+	};
+
+	constexpr size_t MetricNameSize = 48;
+	constexpr size_t MetricsMaxMetrics = 256;
+
+	/// One metric in the shared page, written by the sampler under a seqlock:
+	/// m_seq is odd while m_values change.
+	struct alignas(64) MetricSlot {
+		std::atomic<uint64_t> m_seq = 0;
+		MetricType m_type = MetricType::INVALID;
+		char m_name[MetricNameSize] = {};
+		uint64_t m_values[METRIC_VALUES] = {};
+	};
+
+	struct MetricsPageHeader {
+		char m_magic[8] = { 'L', 'L', 'M', 'E', 'T', 'R', 'C', '1' };
+		uint64_t m_pid = 0;
+		/// Slots are filled in before the count is published.
+		std::atomic<uint64_t> m_num_metrics = 0;
+		/// Wall clock time of the last sample.
+		std::atomic<Nanos> m_sample_time = 0;
+	};
+
+	struct MetricsPage {
+		MetricsPageHeader m_header;
+		MetricSlot m_slots[MetricsMaxMetrics];
+	};
+
+	/// Copy of a slot taken by MetricsReader.
+	struct MetricValue {
+		MetricType m_type = MetricType::INVALID;
+		std::string m_name;
+		uint64_t m_values[METRIC_VALUES] = {};
+	};
+
+	/// Publishes a process's metrics in /dev/shm/<name>. Metrics are registered
+	/// before start(), then a sampler thread copies every source into its slot
+	/// each interval, so the threads being measured never touch the page.
+	class MetricsRegistry final {
+		struct Source {
+			MetricSlot* m_slot = nullptr;
+			std::function<uint64_t()> m_value;
+			const LatencyRecorder* m_recorder = nullptr;
+			double m_scale = 1;
+		};
+
+		std::string m_name;
+		MetricsPage* m_page = nullptr;
+		std::vector<Source> m_sources;
+
+		Nanos m_interval = 0;
+		volatile bool m_run = false;
+		std::thread* m_thread = nullptr;
+
+		auto addSlot(const std::string& name, MetricType type) -> MetricSlot*;
+		void sample() noexcept;
+		void run() noexcept;
+
+	public:
+		/// name is the shm object, e.g. "ll_exchange", shared by nobody else.
+		explicit MetricsRegistry(const std::string& name);
+		~MetricsRegistry();
+
+		MetricsRegistry() = delete;
+		MetricsRegistry(const MetricsRegistry&) = delete;
+		MetricsRegistry(const MetricsRegistry&&) = delete;
+		MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+		MetricsRegistry& operator=(const MetricsRegistry&&) = delete;
+
+		/// Sources are read from the sampler thread and have to outlive stop().
+		void addCounter(const std::string& name, const MetricCounter* counter);
+		void addGauge(const std::string& name, std::function<uint64_t()> value);
+		/// Values are divided by scale, tscPerNano() for recorders of TSC ticks.
+		void addHistogram(const std::string& name, const LatencyRecorder* recorder,
+			double scale = 1);
+
+		void start(int core_id = -1, Nanos interval = 100 * NANOS_TO_MILLIS);
+		void stop();
+	};
+
+	/// Maps another process's MetricsRegistry page read only.
+	class MetricsReader final {
+		const MetricsPage* m_page = nullptr;
+
+	public:
+		explicit MetricsReader(const std::string& name);
+		~MetricsReader();
+
+		MetricsReader() = delete;
+		MetricsReader(const MetricsReader&) = delete;
+		MetricsReader(const MetricsReader&&) = delete;
+		MetricsReader& operator=(const MetricsReader&) = delete;
+		MetricsReader& operator=(const MetricsReader&&) = delete;
+
+		auto valid() const noexcept { return m_page != nullptr; }
+		auto pid() const noexcept { return m_page->m_header.m_pid; }
+		auto sampleTime() const noexcept {
+			return m_page->m_header.m_sample_time.load(std::memory_order_acquire);
+		}
+
+		/// Consistent copy of every slot, retried while the sampler writes one.
+		auto read() const -> std::vector<MetricValue>;
+	};
+}
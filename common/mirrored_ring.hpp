@@ -0,0 +1,97 @@
+#pragma once
+
+#include <string>
+#include <cstring>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "common/macros.hpp"
+
+namespace Common {
+
+	/// Byte ring whose physical pages are mapped twice, back to back, in virtual memory.
+	/// Any readable or writable span is therefore contiguous no matter where it
+	/// wraps, so messages can be decoded in place and the unconsumed tail never
+	/// needs to be moved back to the start of the buffer.
+	class MirroredRing final {
+
+		char* m_data = nullptr;
+		size_t m_capacity = 0;
+
+		size_t m_read_index = 0;
+		size_t m_size = 0;
+
+		MirroredRing() = delete;
+		MirroredRing(const MirroredRing&) = delete;
+		MirroredRing(const MirroredRing&&) = delete;
+		MirroredRing& operator=(const MirroredRing&) = delete;
+		MirroredRing& operator=(const MirroredRing&&) = delete;
+
+	public:
+		explicit MirroredRing(size_t capacity) {
+			const size_t page_size = sysconf(_SC_PAGESIZE);
+			m_capacity = (capacity + page_size - 1) / page_size * page_size;
+
+			const int fd = memfd_create("Common/MirroredRing", MFD_CLOEXEC);
+			ASSERT(fd != -1, "memfd_create() failed error:" + std::string(strerror(errno)));
+			ASSERT(ftruncate(fd, m_capacity) == 0, "ftruncate() failed error:" +
+				std::string(strerror(errno)));
+
+			auto base = mmap(nullptr, 2 * m_capacity, PROT_NONE,
+				MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			ASSERT(base != MAP_FAILED, "mmap() reserve failed error:" +
+				std::string(strerror(errno)));
+			m_data = static_cast<char*>(base);
+
+			ASSERT(mmap(m_data, m_capacity, PROT_READ | PROT_WRITE,
+				MAP_SHARED | MAP_FIXED, fd, 0) == m_data,
+				"mmap() first view failed error:" + std::string(strerror(errno)));
+			ASSERT(mmap(m_data + m_capacity, m_capacity, PROT_READ | PROT_WRITE,
+				MAP_SHARED | MAP_FIXED, fd, 0) == m_data + m_capacity,
+				"mmap() mirror view failed error:" + std::string(strerror(errno)));
+
+			close(fd);
+		}
+
+		~MirroredRing() {
+			munmap(m_data, 2 * m_capacity);
+			m_data = nullptr;
+		}
+
+		/// Start of the unconsumed bytes, valid for size() bytes.
+		char* data() const noexcept { return m_data + m_read_index; }
+		size_t size() const noexcept { return m_size; }
+
+		/// Start of the free space, valid for freeSpace() bytes.
+		char* writePtr() const noexcept {
+			auto write_index = m_read_index + m_size;
+			if (write_index >= m_capacity)
+				write_index -= m_capacity;
+			return m_data + write_index;
+		}
+		size_t freeSpace() const noexcept { return m_capacity - m_size; }
+		size_t capacity() const noexcept { return m_capacity; }
+
+		void commitWrite(size_t len) noexcept {
+			ASSERT(len <= freeSpace(), "MirroredRing overflow.");
+			m_size += len;
+		}
+
+		/// Bytes released here stay untouched until the next write into the ring,
+		/// so pointers into them remain usable until then.
+		void consume(size_t len) noexcept {
+			ASSERT(len <= m_size, "MirroredRing consumed more than available.");
+			m_read_index += len;
+			if (m_read_index >= m_capacity)
+				m_read_index -= m_capacity;
+			m_size -= len;
+		}
+
+		auto write(const void* data, size_t len) noexcept {
+			ASSERT(len <= freeSpace(), "MirroredRing overflow.");
+			memcpy(writePtr(), data, len);
+			m_size += len;
+		}
+	};
+}
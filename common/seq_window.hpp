@@ -0,0 +1,98 @@
+#pragma once
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include "common/macros.hpp"
+
+namespace Common {
+
+	/// Preallocated ring of values indexed by sequence number, holding any of
+	/// [begin(), begin() + capacity()). Values may arrive in any order, the run
+	/// without gaps starting at begin() is tracked as they do, so completeness is
+	/// known without rescanning anything.
+	template<typename T>
+	class SeqWindow final {
+		static constexpr size_t SeqNum_INVALID = std::numeric_limits<size_t>::max();
+
+		std::vector<T> m_values;
+		/// Sequence number stored in each slot, slots of older numbers are stale.
+		std::vector<size_t> m_seq_nums;
+		size_t m_mask = 0;
+
+		size_t m_begin = 0;
+		size_t m_contiguous_end = 0;
+		size_t m_end = 0;
+
+		auto extend() noexcept {
+			while (m_contiguous_end < m_end && contains(m_contiguous_end))
+				++m_contiguous_end;
+		}
+
+		SeqWindow() = delete;
+		SeqWindow(const SeqWindow&) = delete;
+		SeqWindow(const SeqWindow&&) = delete;
+		SeqWindow& operator=(const SeqWindow&) = delete;
+		SeqWindow& operator=(const SeqWindow&&) = delete;
+
+	public:
+		explicit SeqWindow(size_t capacity) :
+			m_values(capacity), m_seq_nums(capacity, SeqNum_INVALID), m_mask(capacity - 1) {
+			ASSERT(capacity && !(capacity & (capacity - 1)),
+				"SeqWindow capacity must be a power of 2: " + std::to_string(capacity));
+		}
+
+		auto capacity() const noexcept { return m_values.size(); }
+		auto begin() const noexcept { return m_begin; }
+		/// First sequence number missing from begin() onwards.
+		auto contiguousEnd() const noexcept { return m_contiguous_end; }
+		/// One past the highest sequence number held.
+		auto end() const noexcept { return m_end; }
+
+		auto empty() const noexcept { return m_end <= m_begin; }
+		/// Nothing missing between begin() and end().
+		auto complete() const noexcept { return m_contiguous_end >= m_end; }
+
+		auto contains(size_t seq_num) const noexcept {
+			return seq_num >= m_begin && seq_num - m_begin < capacity() &&
+				m_seq_nums[seq_num & m_mask] == seq_num;
+		}
+
+		auto& at(size_t seq_num) const noexcept {
+			return m_values[seq_num & m_mask];
+		}
+
+		/// First sequence number held at or after seq_num, end() if there is none.
+		auto nextPresent(size_t seq_num) const noexcept {
+			for (seq_num = std::max(seq_num, m_begin); seq_num < m_end; ++seq_num) {
+				if (contains(seq_num))
+					break;
+			}
+			return std::min(seq_num, m_end);
+		}
+
+		/// Values older than begin() are ignored. Returns false, storing nothing,
+		/// for sequence numbers past the end of the window.
+		auto insert(size_t seq_num, const T& value) noexcept {
+			if (seq_num < m_begin)
+				return true;
+			if (seq_num - m_begin >= capacity())
+				return false;
+
+			m_values[seq_num & m_mask] = value;
+			m_seq_nums[seq_num & m_mask] = seq_num;
+			m_end = std::max(m_end, seq_num + 1);
+			if (seq_num == m_contiguous_end)
+				extend();
+			return true;
+		}
+
+		/// Moves the window to start at seq_num, dropping everything before it.
+		auto advance(size_t seq_num) noexcept {
+			m_begin = m_contiguous_end = seq_num;
+			m_end = std::max(m_end, seq_num);
+			extend();
+		}
+	};
+}
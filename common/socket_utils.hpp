@@ -6,8 +6,13 @@
 #include <string.h>
 #include <unordered_set>
 #include <ifaddrs.h>
+#include <sys/ioctl.h>
 #include <sys/socket.h> 
 #include <sys/types.h>
+#include <net/if.h>
+#include <linux/errqueue.h>
+#include <linux/net_tstamp.h>
+#include <linux/sockios.h>
 #include <netdb.h>
 #include <fcntl.h>
 #include <netinet/tcp.h>
@@ -45,6 +50,21 @@ namespace Common {
 
 	constexpr int MaxTCPServerBacklog = 1024;
 
+	enum class RxTimestampSource : int8_t {
+		SOFTWARE = 0,
+		HARDWARE = 1
+	};
+
+	/// Process wide, set once from main() before any socket is created. HARDWARE
+	/// times come from the NIC's clock, which has to be disciplined to the system
+	/// clock (e.g. by phc2sys) to be compared with getCurrentNanos(). Packets the
+	/// NIC did not stamp fall back to the kernel's software time.
+	inline RxTimestampSource g_rx_timestamp_source = RxTimestampSource::SOFTWARE;
+
+	/// Control buffer large enough for what rxTimestamp() parses.
+	constexpr size_t RxTimestampCtrlSize = CMSG_SPACE(sizeof(scm_timestamping)) +
+		CMSG_SPACE(sizeof(timespec));
+
 	static std::string getIfaceIP(const std::string& iface) {
 		char buf[NI_MAXHOST] = { '\0' };
 		ifaddrs* ifaddr = nullptr;
@@ -78,9 +98,70 @@ namespace Common {
 			reinterpret_cast<void*>(&one), sizeof(one)) != -1;
 	}
 
-	static bool setSOTimestamp(int fd) {
+	static bool setSOTimestampNs(int fd) {
 		int one = 1;
-		return setsockopt(fd, SOL_SOCKET, SO_TIMESTAMP,
+		return setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPNS,
+			reinterpret_cast<void*>(&one), sizeof(one)) != -1;
+	}
+
+	inline bool setSOTimestamping(int fd, bool hardware) {
+		int flags = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+		if (hardware)
+			flags |= SOF_TIMESTAMPING_RX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE;
+		return setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPING,
+			reinterpret_cast<void*>(&flags), sizeof(flags)) != -1;
+	}
+
+	/// Nanosecond receive timestamps through SO_TIMESTAMPING, SO_TIMESTAMPNS on
+	/// kernels without it.
+	inline bool setSORxTimestamps(int fd) {
+		return setSOTimestamping(fd, g_rx_timestamp_source == RxTimestampSource::HARDWARE) ||
+			setSOTimestampNs(fd);
+	}
+
+	/// Has the NIC behind iface stamp every received packet. Needs CAP_NET_ADMIN
+	/// and a driver supporting it.
+	inline bool setHwRxTimestamps(int fd, const std::string& iface) {
+		hwtstamp_config config{};
+		config.tx_type = HWTSTAMP_TX_OFF;
+		config.rx_filter = HWTSTAMP_FILTER_ALL;
+
+		ifreq ifr{};
+		strncpy(ifr.ifr_name, iface.c_str(), IFNAMSIZ - 1);
+		ifr.ifr_data = reinterpret_cast<char*>(&config);
+		return ioctl(fd, SIOCSHWTSTAMP, &ifr) != -1;
+	}
+
+	/// Receive time carried in the control data of msg, the NIC's when there is
+	/// one, 0 if the kernel did not attach any.
+	inline Nanos rxTimestamp(msghdr& msg) {
+		auto toNanos = [](const timespec& ts) {
+			return ts.tv_sec * NANOS_TO_SECS + ts.tv_nsec;
+		};
+
+		for (auto cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+			if (cmsg->cmsg_level != SOL_SOCKET)
+				continue;
+
+			if (cmsg->cmsg_type == SCM_TIMESTAMPING) {
+				scm_timestamping timestamps;
+				memcpy(&timestamps, CMSG_DATA(cmsg), sizeof(timestamps));
+				// ts[0] is the software time, ts[2] the raw hardware time.
+				const auto hw_time = toNanos(timestamps.ts[2]);
+				return hw_time ? hw_time : toNanos(timestamps.ts[0]);
+			}
+			if (cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+				timespec timestamp;
+				memcpy(&timestamp, CMSG_DATA(cmsg), sizeof(timestamp));
+				return toNanos(timestamp);
+			}
+		}
+		return 0;
+	}
+
+	static bool setSOReusePort(int fd) {
+		int one = 1;
+		return setsockopt(fd, SOL_SOCKET, SO_REUSEPORT,
 			reinterpret_cast<void*>(&one), sizeof(one)) != -1;
 	}
 
@@ -105,7 +186,7 @@ namespace Common {
 
 	static int createSocket(Logger& logger, const std::string& t_ip,
 		const std::string& iface, int port, bool is_udp, bool is_blocking,
-		bool is_listening, int ttl, bool needs_so_timestamp) {
+		bool is_listening, int ttl, bool needs_so_timestamp, bool reuse_port = false) {
 
 		std::string time_str;
 
@@ -163,6 +244,10 @@ namespace Common {
 				logger.log("setsockopt() failed. errno: %\n", strerror(errno));
 				return -1;
 			}
+			if (is_listening && reuse_port && !setSOReusePort(fd)) {
+				logger.log("setSOReusePort() failed. errno: %\n", strerror(errno));
+				return -1;
+			}
 			if (is_listening && bind(fd, rp->ai_addr, rp->ai_addrlen) == -1) {
 				logger.log("bind() failed. errno: %\n", strerror(errno));
 				return -1;
@@ -183,10 +268,15 @@ namespace Common {
 					return -1;
 				}
 			}
-			if (needs_so_timestamp && !setSOTimestamp(fd)) {
-				logger.log("setSOTimestamp() failed. errno: %\n", strerror(errno));
+			if (needs_so_timestamp && !setSORxTimestamps(fd)) {
+				logger.log("setSORxTimestamps() failed. errno: %\n", strerror(errno));
 				return -1;
 			}
+			if (needs_so_timestamp && g_rx_timestamp_source == RxTimestampSource::HARDWARE &&
+				!setHwRxTimestamps(fd, iface)) {
+				logger.log("setHwRxTimestamps() failed on iface: % errno: %, using software"
+					" timestamps.\n", iface, strerror(errno));
+			}
 		}
 
 		if (result)
@@ -4,6 +4,17 @@
 namespace Common {
 
 	void TCPServer::destroy() {
+		if (m_io_uring) {
+			// Closing the ring cancels every pending request on it.
+			for (auto socket : m_sockets)
+				socket->m_io_uring = nullptr;
+			delete m_io_uring;
+			m_io_uring = nullptr;
+
+			for (auto socket : m_closing_sockets)
+				delete socket;
+			m_closing_sockets.clear();
+		}
 		close(m_efd);
 		m_efd = -1;
 		m_listener_socket.destroy();
@@ -12,21 +23,41 @@ namespace Common {
 	auto TCPServer::epoll_add(TCPSocket* socket) {
 		epoll_event ev{};
 		ev.events = EPOLLET | EPOLLIN;
+		if (socket != &m_listener_socket)
+			ev.events |= EPOLLOUT;
 		ev.data.ptr = reinterpret_cast<void*>(socket);
 		return epoll_ctl(m_efd, EPOLL_CTL_ADD, socket->m_fd, &ev) != -1;
 	}
 
-	void TCPServer::listen(const std::string& iface, int port) {
+	void TCPServer::listen(const std::string& iface, int port, bool reuse_port) {
 		destroy();
 
 		m_efd = epoll_create(1);
 		ASSERT(m_efd >= 0, "epoll_create() failed error:" +
 			std::string(strerror(errno)));
 
-		ASSERT(m_listener_socket.connect("", iface, port, true) >= 0,
+		ASSERT(m_listener_socket.connect("", iface, port, true, reuse_port) >= 0,
 			"Listener socket failed to connect. iface:" + iface + " port:" +
 			std::to_string(port) + "error:" + std::string(strerror(errno)));
 
+		if (g_socket_backend == SocketBackend::IO_URING) {
+			m_io_uring = new IoUring(g_io_uring_cfg);
+			if (m_io_uring->valid()) {
+				m_logger.log("%: % %() % using io_uring %\n", __FILE__, __LINE__,
+					__FUNCTION__, Common::getCurrentTimeStr(&m_time_str),
+					g_io_uring_cfg.toString());
+				m_io_uring->prepAccept(m_listener_socket.m_fd,
+					ioUringUserData(this, IoUringOp::ACCEPT));
+				m_io_uring->submit();
+				return;
+			}
+			m_logger.log("%: % %() % io_uring setup failed errno: %, falling back to epoll.\n",
+				__FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&m_time_str),
+				strerror(errno));
+			delete m_io_uring;
+			m_io_uring = nullptr;
+		}
+
 		ASSERT(epoll_add(&m_listener_socket), "epoll_ctl()failed.error:" +
 			std::string(strerror(errno)));
 	}
@@ -43,14 +74,98 @@ namespace Common {
 			m_receive_sockets.end(), socket), m_receive_sockets.end());
 		m_send_sockets.erase(std::remove(m_send_sockets.begin(),
 			m_send_sockets.end(), socket), m_send_sockets.end());
+		m_disconnect_callback(socket);
+
+		socket->destroy();
+		if (socket->ioUringPending())
+			m_closing_sockets.push_back(socket);
+		else
+			delete socket;
+	}
+
+	auto TCPServer::addSocket(int fd) {
+		ASSERT(setNonBlocking(fd) && setNoDelay(fd),
+			"Failed to set non - blocking or no - delay on socket : " +
+			std::to_string(fd));
+		if (!setSORxTimestamps(fd))
+			m_logger.log("%: % %() % setSORxTimestamps() failed on socket: % errno: %\n",
+				__FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&m_time_str), fd,
+				strerror(errno));
+
+		m_logger.log("%: % %() % accepted socket: %\n", __FILE__, __LINE__,
+			__FUNCTION__, Common::getCurrentTimeStr(&m_time_str), fd);
+
+		TCPSocket* socket = new TCPSocket(m_logger);
+		socket->m_fd = fd;
+		socket->m_recv_callback = m_recv_callback;
+		if (m_io_uring) {
+			socket->attachIoUring(m_io_uring, false);
+		}
+		else {
+			socket->m_wait_for_epollout = true;
+			ASSERT(epoll_add(socket), "Unable to add socket. erro: " +
+				std::string(strerror(errno)));
+		}
+
+		if (std::find(m_sockets.begin(), m_sockets.end(),
+			socket) == m_sockets.end()) {
+			m_sockets.push_back(socket);
+		}
+		if (std::find(m_receive_sockets.begin(), m_receive_sockets.end(),
+			socket) == m_receive_sockets.end()) {
+			m_receive_sockets.push_back(socket);
+		}
+	}
+
+	auto TCPServer::pollIoUring() noexcept {
+		m_io_uring->forEachCompletion([this](const io_uring_cqe& cqe) {
+			switch (ioUringOp(cqe.user_data)) {
+			case IoUringOp::ACCEPT:
+				if (cqe.res >= 0) {
+					addSocket(cqe.res);
+				}
+				else {
+					m_logger.log("%: % %() % accept failed errno: %\n", __FILE__, __LINE__,
+						__FUNCTION__, Common::getCurrentTimeStr(&m_time_str),
+						strerror(-cqe.res));
+				}
+				if (!(cqe.flags & IORING_CQE_F_MORE) && m_listener_socket.m_fd != -1)
+					m_io_uring->prepAccept(m_listener_socket.m_fd,
+						ioUringUserData(this, IoUringOp::ACCEPT));
+				break;
+			case IoUringOp::RECV:
+			case IoUringOp::SEND:
+				ioUringOwner<TCPSocket>(cqe.user_data)->onIoUringCompletion(cqe);
+				break;
+			default:
+				break;
+			}
+		});
+
+		if (!m_closing_sockets.empty()) [[unlikely]] {
+			std::erase_if(m_closing_sockets, [](auto socket) {
+				if (socket->ioUringPending())
+					return false;
+				delete socket;
+				return true;
+			});
+		}
 	}
 
 	void TCPServer::poll() noexcept {
 		const int max_events = 1 + m_sockets.size();
 
 		for (auto socket : m_disconnected_sockets) {
+			m_logger.log("%: % %() % disconnecting socket: %\n", __FILE__, __LINE__,
+				__FUNCTION__, Common::getCurrentTimeStr(&m_time_str), socket->m_fd);
 			del(socket);
 		}
+		m_disconnected_sockets.clear();
+
+		if (m_io_uring) {
+			pollIoUring();
+			return;
+		}
 
 		const int n = epoll_wait(m_efd, m_events, max_events, 0);
 		bool have_new_connections = false;
@@ -78,6 +193,7 @@ namespace Common {
 			if (event.events & EPOLLOUT) {
 				m_logger.log("%: % %() % EPOLLOUT socket: %\n", __FILE__, __LINE__,
 					__FUNCTION__, Common::getCurrentTimeStr(&m_time_str), socket->m_fd);
+				socket->m_send_blocked = false;
 				if (std::find(m_send_sockets.begin(), m_send_sockets.end(),
 					socket) == m_send_sockets.end()) {
 					m_send_sockets.push_back(socket);
@@ -105,27 +221,7 @@ namespace Common {
 			if (fd == -1)
 				break;
 
-			ASSERT(setNonBlocking(fd) && setNoDelay(fd),
-				"Failed to set non - blocking or no - delay on socket : " +
-				std::to_string(fd));
-
-			m_logger.log("%: % %() % accepted socket: %\n", __FILE__, __LINE__,
-				__FUNCTION__, Common::getCurrentTimeStr(&m_time_str), fd);
-
-			TCPSocket* socket = new TCPSocket(m_logger);
-			socket->m_fd = fd;
-			socket->m_recv_callback = m_recv_callback;
-			ASSERT(epoll_add(socket), "Unable to add socket. erro: " +
-				std::string(strerror(errno)));
-			
-			if (std::find(m_sockets.begin(), m_sockets.end(),
-				socket) == m_sockets.end()) {
-				m_sockets.push_back(socket);
-			}
-			if (std::find(m_receive_sockets.begin(), m_receive_sockets.end(),
-				socket) == m_receive_sockets.end()) {
-				m_receive_sockets.push_back(socket);
-			}
+			addSocket(fd);
 		}
 	}
 
@@ -139,8 +235,22 @@ namespace Common {
 		if (recv)
 			m_recv_finished_callback();
 
+		// Send only, callers may still reference bytes consumed above until the
+		// next round, which reading again could overwrite.
 		for (auto socket : m_send_sockets) {
-			socket->sendAndRecv();
+			socket->flushSend();
 		}
+
+		for (auto socket : m_sockets) {
+			if ((socket->m_send_disconnected || socket->m_recv_disconnected) &&
+				std::find(m_disconnected_sockets.begin(), m_disconnected_sockets.end(),
+					socket) == m_disconnected_sockets.end()) [[unlikely]] {
+				m_disconnected_sockets.push_back(socket);
+			}
+		}
+
+		// Everything the sockets queued during this round goes out in one submission.
+		if (m_io_uring)
+			m_io_uring->submit();
 	}
 }
\ No newline at end of file
@@ -13,11 +13,20 @@ namespace Common {
 
 		epoll_event m_events[1024];
 
+		/// Replaces epoll when the io_uring backend is selected, see useIoUring().
+		IoUring* m_io_uring = nullptr;
+
 		std::vector<TCPSocket*> m_sockets, m_receive_sockets,
 			m_send_sockets, m_disconnected_sockets;
+		/// Disconnected sockets io_uring still has requests for, deleted once those
+		/// completed.
+		std::vector<TCPSocket*> m_closing_sockets;
 
 		std::function<void(TCPSocket* s, Nanos rx_time)> m_recv_callback;
 		std::function<void()> m_recv_finished_callback;
+		/// Called before a disconnected socket is deleted, holders of the pointer
+		/// have to drop it.
+		std::function<void(TCPSocket* s)> m_disconnect_callback;
 
 		std::string m_time_str;
 		Logger& m_logger;
@@ -26,7 +35,7 @@ namespace Common {
 		auto defaultRecvCallback(TCPSocket* socket, Nanos rx_time) noexcept {
 			m_logger.log("%: % %() % TCPServer::defaultRecvCallback() socket: % len : % rx : % \n",
 				__FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&m_time_str),
-				socket->m_fd, socket->m_next_recv_valid_index, rx_time);
+				socket->m_fd, socket->m_recv_ring.size(), rx_time);
 		}
 
 		auto defaultRecvFinishedCallback() noexcept {
@@ -35,11 +44,18 @@ namespace Common {
 				Common::getCurrentTimeStr(&m_time_str));
 		}
 
+		auto defaultDisconnectCallback(TCPSocket* socket) noexcept {
+			m_logger.log("%:% %() % TCPServer::defaultDisconnectCallback() socket: %\n",
+				__FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&m_time_str),
+				socket->m_fd);
+		}
+
 		explicit TCPServer(Logger& logger) :
 			m_listener_socket(logger), m_logger(logger) {
 			m_recv_callback = [this](auto socket, auto rx_time) {
 				defaultRecvCallback(socket, rx_time); };
 			m_recv_finished_callback = [this]() {defaultRecvFinishedCallback(); };
+			m_disconnect_callback = [this](auto socket) { defaultDisconnectCallback(socket); };
 		}
 
 		TCPServer() = delete;
@@ -50,11 +66,13 @@ namespace Common {
 
 		void destroy();
 
-		void listen(const std::string& iface, int port);
+		void listen(const std::string& iface, int port, bool reuse_port = false);
 
 		auto epoll_add(TCPSocket* socket);
 		auto epoll_del(TCPSocket* socket);
 		auto del(TCPSocket* socket);
+		auto addSocket(int fd);
+		auto pollIoUring() noexcept;
 
 		void poll() noexcept;
 		void sendAndRecv() noexcept;
@@ -3,38 +3,214 @@
 namespace Common {
 
 	void TCPSocket::destroy()  {
+		if (m_fd != -1) {
+			m_logger.log("%: % %() % socket: % %\n", __FILE__, __LINE__, __FUNCTION__,
+				Common::getCurrentTimeStr(&m_time_str), m_fd, m_stats.toString());
+		}
+		if (m_io_uring) {
+			if (m_owns_io_uring) {
+				// Closing the ring cancels every pending request on it.
+				delete m_io_uring;
+				m_send_in_flight = 0;
+				m_recv_in_flight = false;
+			}
+			else if (m_fd != -1) {
+				// Their completions still arrive through the owner of the ring.
+				m_io_uring->prepCancel(ioUringUserData(this, IoUringOp::RECV));
+				m_io_uring->prepCancel(ioUringUserData(this, IoUringOp::SEND));
+			}
+			m_io_uring = nullptr;
+			m_owns_io_uring = false;
+		}
 		close(m_fd);
 		m_fd = -1;
 	}
 
 	int TCPSocket::connect(const std::string& ip, const std::string& iface,
-		int port, bool is_listening) {
+		int port, bool is_listening, bool reuse_port) {
 		destroy();
-		m_fd = createSocket(m_logger, ip, iface, port, false, false, is_listening, 0, true);
+		m_fd = createSocket(m_logger, ip, iface, port, false, false, is_listening, 0, true,
+			reuse_port);
 
 		inInAddr.sin_addr.s_addr = INADDR_ANY;
 		inInAddr.sin_port = htons(port);
 		inInAddr.sin_family = AF_INET;
 
+		if (m_fd != -1 && !is_listening && g_socket_backend == SocketBackend::IO_URING) {
+			auto io_uring = new IoUring(g_io_uring_cfg);
+			if (io_uring->valid()) {
+				attachIoUring(io_uring, true);
+				io_uring->submit();
+			}
+			else {
+				m_logger.log("%: % %() % socket: % io_uring setup failed errno: %,"
+					" falling back to recvmsg/sendmsg.\n", __FILE__, __LINE__, __FUNCTION__,
+					Common::getCurrentTimeStr(&m_time_str), m_fd, strerror(errno));
+				delete io_uring;
+			}
+		}
+
 		return m_fd;
 	}
 
+	void TCPSocket::attachIoUring(IoUring* io_uring, bool owns) noexcept {
+		m_io_uring = io_uring;
+		m_owns_io_uring = owns;
+		m_send_in_flight = 0;
+		prepIoUringRecv();
+	}
+
+	void TCPSocket::prepIoUringRecv() noexcept {
+		m_recv_in_flight = true;
+		m_io_uring->prepRecv(m_fd, m_recv_ring.writePtr(), m_recv_ring.freeSpace(),
+			ioUringUserData(this, IoUringOp::RECV));
+	}
+
+	void TCPSocket::onIoUringCompletion(const io_uring_cqe& cqe) noexcept {
+		switch (ioUringOp(cqe.user_data)) {
+		case IoUringOp::RECV: {
+			m_recv_in_flight = false;
+			if (cqe.res > 0) {
+				// The kernel wrote into the ring's free space, as recvmsg() does.
+				m_recv_ring.commitWrite(cqe.res);
+				m_io_uring_rx_time = getCurrentNanos();
+				m_logger.log("%: % %() % read socket: % len: % utime: %\n", __FILE__,
+					__LINE__, __FUNCTION__, Common::getCurrentTimeStr(&m_time_str), m_fd,
+					m_recv_ring.size(), m_io_uring_rx_time);
+				if (!m_recv_ring.freeSpace()) [[unlikely]] {
+					m_logger.log("%: % %() % socket: % receive buffer full, dropping peer.\n",
+						__FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&m_time_str),
+						m_fd);
+					m_recv_disconnected = true;
+				}
+			}
+			else {
+				// 0 is an orderly shutdown by the peer, -ECANCELED follows destroy().
+				m_recv_disconnected = true;
+			}
+
+			if (!m_recv_disconnected && m_fd != -1)
+				prepIoUringRecv();
+		}
+			break;
+		case IoUringOp::SEND: {
+			const auto in_flight = m_send_in_flight;
+			m_send_in_flight = 0;
+			if (cqe.res >= 0) {
+				m_send_ring.consume(cqe.res);
+				m_stats.m_bytes_sent += cqe.res;
+				if (static_cast<size_t>(cqe.res) < in_flight) [[unlikely]]
+					m_stats.m_partial_sends++;
+			}
+			else if (cqe.res == -EAGAIN || cqe.res == -EINTR) {
+				m_stats.m_would_blocks++;
+			}
+			else if (cqe.res != -ECANCELED) {
+				m_logger.log("%: % %() % socket: % send failed errno: %\n", __FILE__, __LINE__,
+					__FUNCTION__, Common::getCurrentTimeStr(&m_time_str), m_fd,
+					strerror(-cqe.res));
+				m_send_disconnected = true;
+			}
+		}
+			break;
+		default:
+			break;
+		}
+	}
+
 	void TCPSocket::send(const void* data, size_t len) noexcept {
-		if (len > 0) {
-			memcpy(m_send_buffer + m_next_send_valid_index, data, len);
-			m_next_send_valid_index += len;
+		if (m_send_disconnected || !len) [[unlikely]]
+			return;
+
+		if (len > m_send_ring.freeSpace()) [[unlikely]] {
+			m_logger.log("%: % %() % socket: % send queue overflow, pending: % len: %."
+				" Disconnecting slow peer.\n", __FILE__, __LINE__, __FUNCTION__,
+				Common::getCurrentTimeStr(&m_time_str), m_fd, m_send_ring.size(), len);
+			m_stats.m_send_overflows++;
+			m_send_disconnected = true;
+			return;
+		}
+
+		m_send_ring.write(data, len);
+		m_stats.m_send_high_water = std::max(m_stats.m_send_high_water, m_send_ring.size());
+	}
+
+	void TCPSocket::flushSend() noexcept {
+		if (!m_send_ring.size() || m_send_disconnected ||
+			(m_send_blocked && m_wait_for_epollout))
+			return;
+
+		if (m_io_uring) {
+			// One send in flight at a time keeps the byte stream ordered, bytes
+			// queued meanwhile go out with the next one.
+			if (!m_send_in_flight) {
+				m_send_in_flight = m_send_ring.size();
+				m_io_uring->prepSend(m_fd, m_send_ring.data(), m_send_in_flight,
+					ioUringUserData(this, IoUringOp::SEND));
+				m_stats.m_send_calls++;
+			}
+			return;
 		}
+
+		// Staged bytes are contiguous in the mirrored ring, so one iovec covers
+		// everything queued, including what a previous partial send left behind.
+		iovec iov{ m_send_ring.data(), m_send_ring.size() };
+		msghdr msg{};
+		msg.msg_iov = &iov;
+		msg.msg_iovlen = 1;
+
+		const auto n = sendmsg(m_fd, &msg, MSG_DONTWAIT | MSG_NOSIGNAL);
+		m_stats.m_send_calls++;
+
+		if (n < 0) [[unlikely]] {
+			if (wouldBlock()) {
+				m_stats.m_would_blocks++;
+				m_send_blocked = true;
+			}
+			else {
+				m_logger.log("%: % %() % socket: % send failed errno: %\n", __FILE__, __LINE__,
+					__FUNCTION__, Common::getCurrentTimeStr(&m_time_str), m_fd, strerror(errno));
+				m_send_disconnected = true;
+			}
+			return;
+		}
+
+		m_logger.log("%: % %() % send socket: % len: % pending: %\n", __FILE__, __LINE__,
+			__FUNCTION__, Common::getCurrentTimeStr(&m_time_str), m_fd, n, m_send_ring.size() - n);
+
+		m_send_ring.consume(n);
+		m_stats.m_bytes_sent += n;
+		m_send_blocked = m_send_ring.size() > 0;
+		if (m_send_blocked) [[unlikely]]
+			m_stats.m_partial_sends++;
 	}
 
 	bool TCPSocket::sendAndRecv() noexcept {
-		char ctrl[CMSG_SPACE(sizeof(struct timeval))];
-		struct cmsghdr* cmsg = (struct cmsghdr*)&ctrl;
+		if (m_io_uring) {
+			if (m_owns_io_uring) {
+				m_io_uring->forEachCompletion([this](const io_uring_cqe& cqe) {
+					onIoUringCompletion(cqe); });
+			}
+
+			const auto rx_time = m_io_uring_rx_time;
+			if (rx_time) {
+				m_io_uring_rx_time = 0;
+				m_recv_callback(this, rx_time);
+			}
+			flushSend();
+
+			if (m_owns_io_uring)
+				m_io_uring->submit();
+			return rx_time != 0;
+		}
+
+		char ctrl[RxTimestampCtrlSize];
 
 		struct iovec iov;
-		iov.iov_base = m_recv_buffer + m_next_recv_valid_index;
-		iov.iov_len = TCPBufferSize - m_next_recv_valid_index;
+		iov.iov_base = m_recv_ring.writePtr();
+		iov.iov_len = m_recv_ring.freeSpace();
 
-		msghdr msg;
+		msghdr msg{};
 		msg.msg_control = ctrl;
 		msg.msg_controllen = sizeof(ctrl);
 		msg.msg_name = &inInAddr;
@@ -42,48 +218,25 @@ namespace Common {
 		msg.msg_iov = &iov;
 		msg.msg_iovlen = 1;
 
-		const auto n_recv = recvmsg(m_fd, &msg, MSG_DONTWAIT);
+		const auto n_recv = iov.iov_len ? recvmsg(m_fd, &msg, MSG_DONTWAIT) : -1;
+		if ((n_recv == 0 && iov.iov_len) || (n_recv < 0 && iov.iov_len && !wouldBlock()))
+			[[unlikely]] {
+			m_recv_disconnected = true;
+		}
 		if (n_recv > 0) {
-			m_next_recv_valid_index += n_recv;
-
-			Nanos kernel_time = 0;
-			struct timeval time_kernel;
-			if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMP &&
-				cmsg->cmsg_len == CMSG_LEN(sizeof(time_kernel))) {
-				memcpy(&time_kernel, CMSG_DATA(cmsg), sizeof(time_kernel));
-				kernel_time = time_kernel.tv_sec * NANOS_TO_SECS +
-					time_kernel.tv_usec * NANOS_TO_MICROS;
-			}
+			m_recv_ring.commitWrite(n_recv);
 
 			const auto user_time = getCurrentNanos();
+			const auto rx_time = rxTimestamp(msg);
+			const auto kernel_time = rx_time ? rx_time : user_time;
 
 			m_logger.log("%: % %() % read socket: % len: % utime: % ktime: % diff: % \n",
 				__FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&m_time_str), m_fd,
-				m_next_recv_valid_index, user_time, kernel_time, user_time - kernel_time);
+				m_recv_ring.size(), user_time, kernel_time, user_time - kernel_time);
 			m_recv_callback(this, kernel_time);
 		}
 
-		ssize_t n_send = std::min(TCPBufferSize, m_next_send_valid_index);
-		while (n_send > 0) {
-			auto n_send_this_msg = std::min(
-				static_cast<ssize_t>(m_next_send_valid_index), n_send);
-			const int flags = MSG_DONTWAIT | MSG_NOSIGNAL |
-				(n_send_this_msg < n_send ? MSG_MORE : 0);
-			auto n = ::send(m_fd, m_send_buffer, n_send_this_msg, flags);
-
-			if (n < 0) [[unlikely]] {
-				if (!wouldBlock())
-					m_send_disconnected = true;
-				break;
-			}
-			m_logger.log("%: % %() % send socket: % len: %\n", __FILE__, __LINE__,
-				__FUNCTION__, Common::getCurrentTimeStr(&m_time_str), m_fd, n);
-
-			n_send -= n;
-
-			ASSERT(n == n_send_this_msg, "Don't support partial send lengths yet.");
-		}
-		m_next_send_valid_index = 0;
+		flushSend();
 
 		return n_recv > 0;
 
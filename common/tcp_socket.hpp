@@ -4,22 +4,63 @@
 
 #include "common/socket_utils.hpp"
 #include "common/logging.hpp"
+#include "common/mirrored_ring.hpp"
+#include "common/io_uring.hpp"
 
 namespace Common {
 
 	constexpr size_t TCPBufferSize = 64 * 1024 * 1024;
 
+	struct TCPSocketStats {
+		size_t m_bytes_sent = 0;
+		size_t m_send_calls = 0;
+		size_t m_partial_sends = 0;
+		size_t m_would_blocks = 0;
+		size_t m_send_overflows = 0;
+		size_t m_send_high_water = 0;
+
+		auto toString() const {
+			std::stringstream ss;
+			ss << "TCPSocketStats[" <<
+				"bytes_sent:" << m_bytes_sent <<
+				" send_calls:" << m_send_calls <<
+				" partial_sends:" << m_partial_sends <<
+				" would_blocks:" << m_would_blocks <<
+				" send_overflows:" << m_send_overflows <<
+				" send_high_water:" << m_send_high_water <<
+				"]";
+			return ss.str();
+		}
+	};
+
 	struct TCPSocket {
 		int m_fd = -1;
 
-		char* m_send_buffer = nullptr;
-		size_t m_next_send_valid_index = 0;
-		char* m_recv_buffer = nullptr;
-		size_t m_next_recv_valid_index = 0;
+		/// Bytes staged by send() and not yet accepted by the kernel.
+		MirroredRing m_send_ring;
+		/// Received bytes not yet consumed by m_recv_callback; see MirroredRing.
+		MirroredRing m_recv_ring;
 
 		bool m_send_disconnected = false;
 		bool m_recv_disconnected = false;
 
+		/// Set when the kernel send buffer filled up. Sockets owned by a TCPServer
+		/// then wait for EPOLLOUT before trying again, others retry on every call.
+		bool m_send_blocked = false;
+		bool m_wait_for_epollout = false;
+
+		TCPSocketStats m_stats;
+
+		/// Non null when the socket is driven through io_uring instead of recvmsg /
+		/// sendmsg. Accepted sockets borrow the ring of their TCPServer, connected
+		/// sockets own one.
+		IoUring* m_io_uring = nullptr;
+		bool m_owns_io_uring = false;
+		size_t m_send_in_flight = 0;
+		bool m_recv_in_flight = false;
+		/// Time the last receive completion was reaped, 0 once consumed.
+		Nanos m_io_uring_rx_time = 0;
+
 		struct sockaddr_in inInAddr;
 
 		std::function<void(TCPSocket* s, Nanos rx_time)> m_recv_callback;
@@ -29,14 +70,13 @@ namespace Common {
 
 		auto defaultRecvCallback(TCPSocket* socket, Nanos rx_time) noexcept {
 			m_logger.log("%: % %() % TCPSocket::defaultRecvCallback() "
-				"socket: % len: % rx: %\n", Common::getCurrentTimeStr(&m_time_str),
-				socket->m_fd, socket->m_next_recv_valid_index, rx_time);
+				"socket: % len: % rx: %\n", __FILE__, __LINE__, __FUNCTION__,
+				Common::getCurrentTimeStr(&m_time_str), socket->m_fd, socket->m_recv_ring.size(), rx_time);
 		}
 
 
-		explicit TCPSocket(Logger& logger) : m_logger(logger) {
-			m_send_buffer = new char[TCPBufferSize];
-			m_recv_buffer = new char[TCPBufferSize];
+		explicit TCPSocket(Logger& logger) :
+			m_send_ring(TCPBufferSize), m_recv_ring(TCPBufferSize), m_logger(logger) {
 			m_recv_callback = [this](auto socket, auto rx_time) {
 				defaultRecvCallback(socket, rx_time); };
 		}
@@ -45,10 +85,6 @@ namespace Common {
 
 		~TCPSocket() {
 			destroy();
-			delete[] m_send_buffer;
-			m_send_buffer = nullptr;
-			delete[] m_recv_buffer;
-			m_recv_buffer = nullptr;
 		}
 
 		TCPSocket() = delete;
@@ -58,9 +94,19 @@ namespace Common {
 		TCPSocket& operator=(const TCPSocket&&) = delete;
 
 
-		int connect(const std::string& ip, const std::string& iface, int port, bool is_listening);
+		int connect(const std::string& ip, const std::string& iface, int port, bool is_listening,
+			bool reuse_port = false);
 		void send(const void* data, size_t len) noexcept;
+		void flushSend() noexcept;
 		bool sendAndRecv() noexcept;
+
+		void attachIoUring(IoUring* io_uring, bool owns) noexcept;
+		/// Requests on a borrowed ring still to complete, they reference this socket
+		/// and its rings, which have to stay until then.
+		auto ioUringPending() const noexcept { return m_recv_in_flight || m_send_in_flight; }
+		/// Receives go straight into the free space of m_recv_ring, one at a time.
+		void prepIoUringRecv() noexcept;
+		void onIoUringCompletion(const io_uring_cqe& cqe) noexcept;
 	};
 
 }
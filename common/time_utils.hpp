@@ -20,7 +20,15 @@ namespace Common {
 
 	inline auto& getCurrentTimeStr(std::string* time_str) {
 		const auto time = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
-		time_str->assign(ctime(&time));
+		// ctime() looks the timezone up on every call, the text only changes once a
+		// second.
+		thread_local time_t last_time = 0;
+		thread_local char last_time_str[32] = {};
+		if (time != last_time) [[unlikely]] {
+			ctime_r(&time, last_time_str);
+			last_time = time;
+		}
+		time_str->assign(last_time_str);
 		if (!time_str->empty())
 			time_str->at(time_str->length() - 1) = '\0';
 		return *time_str;
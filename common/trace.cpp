@@ -0,0 +1,51 @@
+#include "common/trace.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+
+namespace Common {
+
+	namespace {
+		std::mutex g_trace_mutex;
+		std::vector<TraceRing*> g_trace_rings;
+		std::string g_trace_file;
+		double g_tsc_per_nano = 0;
+	}
+
+	void enableTracing(const std::string& file) {
+		g_trace_file = file;
+		g_tsc_per_nano = tscPerNano();
+		g_tracing = true;
+		std::atexit(traceDump);
+	}
+
+	TraceRing* traceRing() {
+		auto ring = new TraceRing();
+		std::lock_guard<std::mutex> lock(g_trace_mutex);
+		g_trace_rings.push_back(ring);
+		return ring;
+	}
+
+	void traceDump() {
+		std::lock_guard<std::mutex> lock(g_trace_mutex);
+		auto file = fopen(g_trace_file.c_str(), "wb");
+		if (!file)
+			return;
+
+		std::vector<TraceRecord> records;
+		for (const auto ring : g_trace_rings) {
+			const auto end = ring->m_next.load(std::memory_order_acquire);
+			const auto begin = end > TraceRingSize ? end - TraceRingSize : 0;
+			for (auto i = begin; i < end; ++i)
+				records.push_back(ring->m_records[i & (TraceRingSize - 1)]);
+		}
+
+		TraceFileHeader header;
+		header.m_tsc_per_nano = g_tsc_per_nano;
+		header.m_num_records = records.size();
+		fwrite(&header, sizeof(header), 1, file);
+		fwrite(records.data(), sizeof(TraceRecord), records.size(), file);
+		fclose(file);
+	}
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "common/tsc.hpp"
+#include "common/types.hpp"
+
+namespace Common {
+
+	/// Points on the tick to trade path that can be stamped. Market data hops are
+	/// keyed by the packet's receive time, order hops by traceOrderKey().
+	enum class TraceHop : uint8_t {
+		INVALID = 0,
+		MCAST_RECV = 1,
+		MD_DECODE = 2,
+		TE_DEQUEUE = 3,
+		BOOK_UPDATE = 4,
+		STRATEGY_DECISION = 5,
+		/// m_key is the order's key, m_link the market data key that caused it.
+		OM_NEW_ORDER = 6,
+		OGW_SEND = 7,
+		OS_RECV = 8,
+		SEQUENCER_PUBLISH = 9,
+		ME_PROCESS = 10,
+		OS_RESPONSE_SEND = 11,
+		MAX = 12
+	};
+
+	inline std::string traceHopToString(TraceHop hop) {
+		switch (hop) {
+		case TraceHop::MCAST_RECV: return "MCAST_RECV";
+		case TraceHop::MD_DECODE: return "MD_DECODE";
+		case TraceHop::TE_DEQUEUE: return "TE_DEQUEUE";
+		case TraceHop::BOOK_UPDATE: return "BOOK_UPDATE";
+		case TraceHop::STRATEGY_DECISION: return "STRATEGY_DECISION";
+		case TraceHop::OM_NEW_ORDER: return "OM_NEW_ORDER";
+		case TraceHop::OGW_SEND: return "OGW_SEND";
+		case TraceHop::OS_RECV: return "OS_RECV";
+		case TraceHop::SEQUENCER_PUBLISH: return "SEQUENCER_PUBLISH";
+		case TraceHop::ME_PROCESS: return "ME_PROCESS";
+		case TraceHop::OS_RESPONSE_SEND: return "OS_RESPONSE_SEND";
+		case TraceHop::INVALID: return "INVALID";
+		case TraceHop::MAX: return "MAX";
+		}
+		return "UNKNOWN";
+	}
+
+	struct TraceRecord {
+		uint64_t m_tsc = 0;
+		uint64_t m_key = 0;
+		uint64_t m_link = 0;
+		TraceHop m_hop = TraceHop::INVALID;
+	};
+
+	/// Records kept per thread, older ones are overwritten.
+	constexpr size_t TraceRingSize = 1024 * 1024;
+
+	/// Written by its thread only, m_next is published after each record so
+	/// traceDump() can copy the ring while the thread keeps running.
+	struct TraceRing {
+		std::vector<TraceRecord> m_records = std::vector<TraceRecord>(TraceRingSize);
+		std::atomic<size_t> m_next = 0;
+	};
+
+	struct TraceFileHeader {
+		char m_magic[8] = { 'L', 'L', 'T', 'R', 'A', 'C', 'E', '1' };
+		double m_tsc_per_nano = 0;
+		uint64_t m_num_records = 0;
+	};
+
+	/// Set once by enableTracing(), every trace() is a single branch until then.
+	inline bool g_tracing = false;
+	/// Market data key of the event this thread is working on, see setTraceKey().
+	inline thread_local uint64_t t_trace_key = 0;
+
+	/// Starts recording and registers traceDump() to run at exit. To be called
+	/// from main() before any thread is started.
+	void enableTracing(const std::string& file);
+	/// Writes every thread's records to the file given to enableTracing().
+	void traceDump();
+	/// This thread's ring, allocated and registered on first use.
+	TraceRing* traceRing();
+
+	inline auto traceOrderKey(ClientId client_id, OrderId order_id) noexcept -> uint64_t {
+		return (uint64_t(client_id) << 32) | (order_id & 0xffffffff);
+	}
+
+	inline auto trace(TraceHop hop, uint64_t key, uint64_t link = 0) noexcept {
+		if (!g_tracing) [[likely]]
+			return;
+
+		static thread_local TraceRing* ring = traceRing();
+		const auto next = ring->m_next.load(std::memory_order_relaxed);
+		ring->m_records[next & (TraceRingSize - 1)] = { rdtsc(), key, link, hop };
+		ring->m_next.store(next + 1, std::memory_order_release);
+	}
+
+	/// Hops further down the same thread, that do not see the market update, are
+	/// stamped with the key set here.
+	inline auto setTraceKey(uint64_t key) noexcept {
+		if (g_tracing) [[unlikely]]
+			t_trace_key = key;
+	}
+
+	inline auto trace(TraceHop hop) noexcept {
+		if (g_tracing) [[unlikely]]
+			trace(hop, t_trace_key);
+	}
+}
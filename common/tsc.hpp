@@ -0,0 +1,43 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "common/time_utils.hpp"
+
+namespace Common {
+
+	/// Cycle counter, a few ns to read and constant rate on any CPU with an
+	/// invariant TSC. Elsewhere it falls back to steady_clock nanoseconds.
+	inline auto rdtsc() noexcept -> uint64_t {
+#if defined(__x86_64__) || defined(__i386__)
+		return __rdtsc();
+#else
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+	}
+
+	/// TSC ticks per nanosecond, measured against steady_clock over interval.
+	inline auto tscTicksPerNano(Nanos interval = 10 * NANOS_TO_MILLIS) -> double {
+		using namespace std::chrono;
+		const auto start_time = steady_clock::now();
+		const auto start_tsc = rdtsc();
+		std::this_thread::sleep_for(nanoseconds(interval));
+		const auto end_tsc = rdtsc();
+		const auto end_time = steady_clock::now();
+		return static_cast<double>(end_tsc - start_tsc) /
+			duration_cast<nanoseconds>(end_time - start_time).count();
+	}
+
+	/// tscTicksPerNano() measured once per process, on first use.
+	inline auto tscPerNano() -> double {
+		static const double tsc_per_nano = tscTicksPerNano();
+		return tsc_per_nano;
+	}
+}
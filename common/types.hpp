@@ -1,5 +1,6 @@
 #pragma once	
 
+#include <array>
 #include <limits>
 #include <cstdint>
 #include <sstream>
@@ -13,6 +14,8 @@ namespace Common {
 
 	constexpr size_t  ME_MAX_CLIENT_UPDATES = 256 * 1024;
 	constexpr size_t  ME_MAX_MARKET_UPDATES = 256 * 1024;
+	/// Recent incremental updates per market data channel kept for retransmission.
+	constexpr size_t  ME_MAX_RETRANSMIT_UPDATES = 64 * 1024;
 
 	constexpr size_t ME_MAX_NUM_CLIENTS = 256;
 	constexpr size_t ME_MAX_ORDER_IDS = 1024 * 1042;
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include "common/macros.hpp"
+#include "common/thread_utils.hpp"
+
+namespace Common {
+
+	/// Runs a batch of coarse tasks, seconds each, on a fixed set of threads. Every
+	/// thread has its own deque, submit() deals tasks out round robin, a thread
+	/// works off the back of its own deque and steals from the front of the
+	/// others once it runs dry, so uneven tasks even out without a shared queue.
+	/// Deques are locked, which costs nothing next to tasks this long.
+	class WorkStealingPool final {
+	public:
+		/// Gets the index of the worker running it, for per-worker state.
+		typedef std::function<void(size_t worker)> Task;
+
+	private:
+		struct Worker {
+			std::mutex m_mutex;
+			std::deque<Task> m_tasks;
+			size_t m_num_run = 0;
+			size_t m_num_stolen = 0;
+		};
+
+		std::vector<Worker*> m_workers;
+		int m_first_core = -1;
+		size_t m_next_worker = 0;
+
+		auto pop(size_t worker, Task* task) noexcept {
+			auto own = m_workers[worker];
+			{
+				std::lock_guard<std::mutex> lock(own->m_mutex);
+				if (!own->m_tasks.empty()) {
+					*task = std::move(own->m_tasks.back());
+					own->m_tasks.pop_back();
+					return true;
+				}
+			}
+			for (size_t i = 1; i < m_workers.size(); ++i) {
+				auto victim = m_workers[(worker + i) % m_workers.size()];
+				std::lock_guard<std::mutex> lock(victim->m_mutex);
+				if (!victim->m_tasks.empty()) {
+					*task = std::move(victim->m_tasks.front());
+					victim->m_tasks.pop_front();
+					++own->m_num_stolen;
+					return true;
+				}
+			}
+			return false;
+		}
+
+		auto work(size_t worker) noexcept {
+			if (m_first_core >= 0)
+				setThreadCore(m_first_core + static_cast<int>(worker));
+			// Nothing is submitted while run() is on, so empty everywhere means done.
+			for (Task task; pop(worker, &task);) {
+				task(worker);
+				++m_workers[worker]->m_num_run;
+			}
+		}
+
+	public:
+		/// Workers are pinned to first_core onwards, -1 leaves them unpinned.
+		explicit WorkStealingPool(size_t num_workers, int first_core = -1) :
+			m_first_core(first_core) {
+			ASSERT(num_workers, "WorkStealingPool needs a worker.");
+			for (size_t i = 0; i < num_workers; ++i)
+				m_workers.push_back(new Worker());
+		}
+
+		~WorkStealingPool() {
+			for (auto worker : m_workers)
+				delete worker;
+			m_workers.clear();
+		}
+
+		WorkStealingPool() = delete;
+		WorkStealingPool(const WorkStealingPool&) = delete;
+		WorkStealingPool(const WorkStealingPool&&) = delete;
+		WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+		WorkStealingPool& operator=(const WorkStealingPool&&) = delete;
+
+		auto numWorkers() const noexcept { return m_workers.size(); }
+
+		auto submit(Task task) {
+			auto worker = m_workers[m_next_worker++ % m_workers.size()];
+			std::lock_guard<std::mutex> lock(worker->m_mutex);
+			worker->m_tasks.push_back(std::move(task));
+		}
+
+		/// Runs everything submitted, the calling thread being worker 0, and
+		/// returns when all of it is done.
+		auto run() {
+			// Plain threads, createAndStartThread() would start them one a second.
+			std::vector<std::thread> threads;
+			for (size_t i = 1; i < m_workers.size(); ++i)
+				threads.emplace_back([this, i]() { work(i); });
+			work(0);
+			for (auto& thread : threads)
+				thread.join();
+		}
+
+		/// Tasks run and tasks stolen by each worker.
+		auto numRun(size_t worker) const noexcept { return m_workers[worker]->m_num_run; }
+		auto numStolen(size_t worker) const noexcept { return m_workers[worker]->m_num_stolen; }
+	};
+}
@@ -8,12 +8,14 @@ Common::Logger* logger = nullptr;
 Exchange::MatchingEngine* matching_engine = nullptr;
 Exchange::MarketDataPublisher* market_data_publisher = nullptr;
 Exchange::OrderServer* order_server = nullptr;
+Common::MetricsRegistry* metrics = nullptr;
 
 
 void signal_handler(int) {
 	using namespace std::literals::chrono_literals;
 	std::this_thread::sleep_for(10s);
 
+	delete metrics; metrics = nullptr;
 	delete logger; logger = nullptr;
 	delete matching_engine; matching_engine = nullptr;
 	delete market_data_publisher; market_data_publisher = nullptr;
@@ -25,11 +27,24 @@ void signal_handler(int) {
 }
 
 
-int main(int, char**) {
+int main(int argc, char** argv) {
 	logger = new Common::Logger("exchange_main.log");
 
 	std::signal(SIGINT, signal_handler);
 
+	// TRACE_FILE=<path> stamps every hop of an order, see tools/trace_report.
+	if (const auto trace_file = getenv("TRACE_FILE"))
+		Common::enableTracing(trace_file);
+
+	// Optional second argument picks the socket backend: epoll (default), io_uring
+	// or io_uring_sqpoll. Unsupported kernels fall back to epoll at socket setup.
+	const std::string socket_backend = argc > 2 ? argv[2] : "epoll";
+	if (socket_backend == "io_uring" || socket_backend == "io_uring_sqpoll") {
+		Common::IoUringCfg io_uring_cfg;
+		io_uring_cfg.m_sqpoll = (socket_backend == "io_uring_sqpoll");
+		Common::useIoUring(io_uring_cfg);
+	}
+
 	const int sleep_time = 100 * 1000;
 
 	Exchange::ClientRequestLFQueue client_requests(ME_MAX_CLIENT_UPDATES);
@@ -45,24 +60,35 @@ int main(int, char**) {
 	matching_engine->start();
 
 	const std::string mkt_pub_iface = "lo";
-	const std::string snap_pub_ip = "233.252.14.1", inc_pub_ip = "233.252.14.3";
-	const int snap_pub_port = 20000, inc_pub_port = 20001;
+	// Optional third argument splits the tickers over that many market data channels,
+	// a fourth "ab" publishes every incremental packet on an A and a B line.
+	const auto mkt_pub_channels = Exchange::makeMarketDataChannelCfgs(
+		argc > 3 ? std::stoul(argv[3]) : 1, argc > 4 && std::string(argv[4]) == "ab");
+	const int mkt_retransmit_port = 20100;
 
 	logger->log("%: % %() % Starting Market Data Publisher...\n", __FILE__,
 		__LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str));
-	market_data_publisher = new Exchange::MarketDataPublisher(&market_updates, 
-		mkt_pub_iface, snap_pub_ip, snap_pub_port, inc_pub_ip, inc_pub_port);
+	market_data_publisher = new Exchange::MarketDataPublisher(&market_updates,
+		mkt_pub_iface, mkt_pub_channels, mkt_retransmit_port);
 	market_data_publisher->start();
 
 	const std::string order_gw_iface = "lo";
 	const int order_gw_port = 12345;
+	const size_t order_gw_session_groups = argc > 1 ? std::stoul(argv[1]) : 1;
 
 	logger->log("%: % %() % Starting Order Server...\n", __FILE__,
 		__LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str));
 	order_server = new Exchange::OrderServer(&client_requests, &client_responses, 
-		order_gw_iface, order_gw_port);
+		order_gw_iface, order_gw_port, order_gw_session_groups);
 	order_server->start();
 
+	// Live counters, queue depths and latencies in /dev/shm/ll_exchange, see llstat.
+	metrics = new Common::MetricsRegistry("ll_exchange");
+	matching_engine->registerMetrics(*metrics);
+	market_data_publisher->registerMetrics(*metrics);
+	order_server->registerMetrics(*metrics);
+	metrics->start();
+
 	while (true) {
 		logger->log("%:% %() % Sleeping for a few milliseconds..\n", __FILE__,
 			__LINE__, __FUNCTION__, Common::getCurrentTimeStr(&time_str));
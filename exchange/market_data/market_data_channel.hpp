@@ -0,0 +1,96 @@
+#pragma once
+
+#include <array>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "common/types.hpp"
+#include "common/macros.hpp"
+
+namespace Exchange {
+
+	/// A partition of the market data feed. Each channel carries a set of
+	/// tickers on its own incremental and snapshot groups, with its own
+	/// incremental sequence numbers, so subscribers only see what they trade.
+	struct MarketDataChannelCfg {
+		size_t m_channel_id = 0;
+
+		std::string m_incremental_ip;
+		int m_incremental_port = -1;
+		/// Optional B line carrying the same incremental packets, see hasLineB().
+		std::string m_incremental_b_ip;
+		int m_incremental_b_port = -1;
+		std::string m_snapshot_ip;
+		int m_snapshot_port = -1;
+
+		std::vector<TickerId> m_tickers;
+
+		auto hasLineB() const noexcept {
+			return m_incremental_b_port >= 0;
+		}
+
+		auto toString() const {
+			std::stringstream ss;
+			ss << "MarketDataChannelCfg[" <<
+				"channel:" << m_channel_id <<
+				" incremental:" << m_incremental_ip << ":" << m_incremental_port <<
+				" incremental_b:" << m_incremental_b_ip << ":" << m_incremental_b_port <<
+				" snapshot:" << m_snapshot_ip << ":" << m_snapshot_port <<
+				" tickers:";
+			for (const auto ticker_id : m_tickers)
+				ss << tickerIdToString(ticker_id) << " ";
+			ss << "]";
+			return ss.str();
+		}
+	};
+
+	typedef std::vector<MarketDataChannelCfg> MarketDataChannelCfgs;
+
+	constexpr size_t MarketDataChannel_INVALID = std::numeric_limits<size_t>::max();
+
+	/// Hash map from TickerId -> channel index.
+	typedef std::array<size_t, ME_MAX_TICKERS> TickerChannelHashMap;
+
+	inline auto tickerChannels(const MarketDataChannelCfgs& channels) {
+		TickerChannelHashMap ticker_channel;
+		ticker_channel.fill(MarketDataChannel_INVALID);
+		for (size_t i = 0; i < channels.size(); ++i) {
+			for (const auto ticker_id : channels[i].m_tickers) {
+				ASSERT(ticker_id < ME_MAX_TICKERS && ticker_channel[ticker_id] ==
+					MarketDataChannel_INVALID, "Ticker " + tickerIdToString(ticker_id) +
+					" invalid or assigned to more than one market data channel.");
+				ticker_channel[ticker_id] = i;
+			}
+		}
+		return ticker_channel;
+	}
+
+	/// Spreads all tickers round robin over num_channels channels. Channel 0 keeps
+	/// the groups of the unpartitioned feed, channel n uses 233.252.16.n for its
+	/// snapshots and 233.252.17.n for its incrementals. With dual_feed the
+	/// incrementals are repeated on a B line 233.252.18.n.
+	inline auto makeMarketDataChannelCfgs(size_t num_channels, bool dual_feed = false) {
+		ASSERT(num_channels >= 1 && num_channels <= ME_MAX_TICKERS,
+			"Invalid number of market data channels: " + std::to_string(num_channels));
+
+		MarketDataChannelCfgs channels(num_channels);
+		for (size_t i = 0; i < num_channels; ++i) {
+			auto& channel = channels[i];
+			channel.m_channel_id = i;
+			channel.m_snapshot_ip = i ? "233.252.16." + std::to_string(i) : "233.252.14.1";
+			channel.m_incremental_ip = i ? "233.252.17." + std::to_string(i) : "233.252.14.3";
+			channel.m_snapshot_port = 20000 + 2 * static_cast<int>(i);
+			channel.m_incremental_port = 20001 + 2 * static_cast<int>(i);
+			if (dual_feed) {
+				channel.m_incremental_b_ip = "233.252.18." + std::to_string(i);
+				channel.m_incremental_b_port = 20051 + 2 * static_cast<int>(i);
+			}
+		}
+		for (TickerId ticker_id = 0; ticker_id < ME_MAX_TICKERS; ++ticker_id)
+			channels[ticker_id % num_channels].m_tickers.push_back(ticker_id);
+
+		return channels;
+	}
+}
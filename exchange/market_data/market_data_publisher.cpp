@@ -4,16 +4,35 @@
 namespace Exchange {
 
 	MarketDataPublisher::MarketDataPublisher(MEMarketUpdateLFQueue* market_updates,
-		const std::string& iface, const std::string& snapshot_ip, int snapshot_port,
-		const std::string& incremental_ip, int incremental_port) :
+		const std::string& iface, const MarketDataChannelCfgs& channels,
+		int retransmit_port, size_t max_packet_size, const SnapshotCfg& snapshot_cfg) :
 		m_outgoing_md_updates(market_updates), m_snapshot_md_updates(ME_MAX_MARKET_UPDATES),
+		m_retransmit_md_updates(ME_MAX_MARKET_UPDATES),
 		m_run(false), m_logger("exchange_market_data_publisher.log"),
-		m_incremental_socket(m_logger) {
-		ASSERT(m_incremental_socket.init(incremental_ip, iface, incremental_port,
-			false) >= 0, "Unable to create incremental mcast socket. error:" +
-			std::string(std::strerror(errno)));
+		m_ticker_channel(tickerChannels(channels)) {
+		for (TickerId ticker_id = 0; ticker_id < ME_MAX_TICKERS; ++ticker_id)
+			ASSERT(m_ticker_channel[ticker_id] != MarketDataChannel_INVALID,
+				"Ticker " + tickerIdToString(ticker_id) + " not on any market data channel.");
+
+		for (const auto& cfg : channels) {
+			auto channel = new Channel(cfg, m_logger, max_packet_size);
+			ASSERT(channel->m_socket.init(cfg.m_incremental_ip, iface,
+				cfg.m_incremental_port, false) >= 0, "Unable to create incremental mcast"
+				" socket for " + cfg.toString() + " error:" + std::string(std::strerror(errno)));
+			if (cfg.hasLineB()) {
+				ASSERT(channel->m_socket_b.init(cfg.m_incremental_b_ip, iface,
+					cfg.m_incremental_b_port, false) >= 0, "Unable to create incremental B"
+					" mcast socket for " + cfg.toString() + " error:" +
+					std::string(std::strerror(errno)));
+			}
+			m_logger.log("%:% %() % Publishing %\n", __FILE__, __LINE__, __FUNCTION__,
+				Common::getCurrentTimeStr(&m_time_str), cfg.toString());
+			m_channels.push_back(channel);
+		}
 		m_snapshot_synthesizer = new SnapshotSynthesizer(&m_snapshot_md_updates,
-			iface, snapshot_ip, snapshot_port);
+			iface, channels, max_packet_size, snapshot_cfg);
+		m_retransmission_server = new RetransmissionServer(&m_retransmit_md_updates,
+			iface, retransmit_port, channels);
 	}
 
 	MarketDataPublisher::~MarketDataPublisher() {
@@ -24,6 +43,13 @@ namespace Exchange {
 
 		delete m_snapshot_synthesizer;
 		m_snapshot_synthesizer = nullptr;
+
+		delete m_retransmission_server;
+		m_retransmission_server = nullptr;
+
+		for (auto channel : m_channels)
+			delete channel;
+		m_channels.clear();
 	}
 
 	void MarketDataPublisher::start() {
@@ -33,11 +59,28 @@ namespace Exchange {
 			[this]() { run(); }) != nullptr, "Failed to start MarketData thread.");
 
 		m_snapshot_synthesizer->start();
+		m_retransmission_server->start();
 	}
 
 	void MarketDataPublisher::stop() {
 		m_run = false;
 		m_snapshot_synthesizer->stop();
+		m_retransmission_server->stop();
+	}
+
+	void MarketDataPublisher::registerMetrics(Common::MetricsRegistry& metrics) {
+		metrics.addCounter("mdp.updates", &m_num_updates);
+		metrics.addGauge("mdp.snapshot_md_updates",
+			[this]() { return m_snapshot_md_updates.size(); });
+		metrics.addGauge("mdp.retransmit_md_updates",
+			[this]() { return m_retransmit_md_updates.size(); });
+		metrics.addGauge("mdp.send_failures", [this]() {
+			uint64_t send_failures = 0;
+			for (const auto channel : m_channels)
+				send_failures += channel->m_socket.m_send_failures +
+					channel->m_socket_b.m_send_failures;
+			return send_failures;
+		});
 	}
 
 	void MarketDataPublisher::run() noexcept {
@@ -47,23 +90,37 @@ namespace Exchange {
 			for (auto market_update = m_outgoing_md_updates->getNextToRead();
 				m_outgoing_md_updates->size() && market_update;
 				market_update = m_outgoing_md_updates->getNextToRead()) {
-				m_logger.log("%:% %() % Sending seq:% %\n", __FILE__, __LINE__, 
-					__FUNCTION__, Common::getCurrentTimeStr(&m_time_str), 
-					m_next_inc_seq_num, market_update->toString().c_str());
-				
-				m_incremental_socket.send(&m_next_inc_seq_num, sizeof(m_next_inc_seq_num));
-				m_incremental_socket.send(&market_update, sizeof(MEMarketUpdate));
+				auto channel = m_channels[m_ticker_channel.at(market_update->m_ticker_id)];
+				m_logger.log("%:% %() % Sending channel:% seq:% %\n", __FILE__, __LINE__,
+					__FUNCTION__, Common::getCurrentTimeStr(&m_time_str),
+					channel->m_cfg.m_channel_id, channel->m_next_inc_seq_num,
+					market_update->toString().c_str());
+
+				const MDPMarketUpdate mdp_market_update{ channel->m_next_inc_seq_num,
+					*market_update };
+				channel->m_writer.add(mdp_market_update);
+				if (channel->m_cfg.hasLineB())
+					channel->m_writer_b.add(mdp_market_update);
 				m_outgoing_md_updates->updateReadIndex();
 
 				auto next_write = m_snapshot_md_updates.getNextToWriteTo();
-				next_write->m_seq_num = m_next_inc_seq_num;
-				next_write->m_me_market_update = *market_update;
+				*next_write = mdp_market_update;
 				m_snapshot_md_updates.updateWriteIndex();
 
-				m_next_inc_seq_num++;
+				next_write = m_retransmit_md_updates.getNextToWriteTo();
+				*next_write = mdp_market_update;
+				m_retransmit_md_updates.updateWriteIndex();
+
+				channel->m_next_inc_seq_num++;
+				m_num_updates.inc();
 			}
 
-			m_incremental_socket.sendAndRecv();
+			for (auto channel : m_channels) {
+				if (channel->m_writer.pending())
+					channel->m_writer.flush();
+				if (channel->m_writer_b.pending())
+					channel->m_writer_b.flush();
+			}
 		}
 	}
 }
@@ -7,37 +7,65 @@
 #include "common/lf_queue.hpp"
 #include "common/time_utils.hpp"
 #include "common/mcast_socket.hpp"
+#include "common/metrics.hpp"
 #include "exchange/market_data/market_update.hpp"
+#include "exchange/market_data/market_data_channel.hpp"
+#include "exchange/market_data/mdp_packet_writer.hpp"
 #include "exchange/market_data/snapshot_sythesizer.hpp"
+#include "exchange/market_data/retransmission_server.hpp"
 
 namespace Exchange {
 
 	class MarketDataPublisher {
 
-		size_t m_next_inc_seq_num = 1;
+		/// Incremental stream of one market data channel. With a B line every
+		/// update goes through both writers, which then build identical packets.
+		struct Channel {
+			MarketDataChannelCfg m_cfg;
+			Common::McastSocket m_socket;
+			MDPPacketWriter m_writer;
+			Common::McastSocket m_socket_b;
+			MDPPacketWriter m_writer_b;
+			size_t m_next_inc_seq_num = 1;
+
+			Channel(const MarketDataChannelCfg& cfg, Common::Logger& logger,
+				size_t max_packet_size) :
+				m_cfg(cfg), m_socket(logger), m_writer(&m_socket, max_packet_size),
+				m_socket_b(logger), m_writer_b(&m_socket_b, max_packet_size) {
+			}
+		};
+
 		MEMarketUpdateLFQueue* m_outgoing_md_updates = nullptr;
 
 		MDPMarketUpdateLFQueue m_snapshot_md_updates;
+		MDPMarketUpdateLFQueue m_retransmit_md_updates;
 
 		volatile bool m_run = false;
 
+		Common::MetricCounter m_num_updates;
+
 		std::string m_time_str;
 		Common::Logger m_logger;
 
-		Common::McastSocket m_incremental_socket;
+		std::vector<Channel*> m_channels;
+		TickerChannelHashMap m_ticker_channel;
 
 		SnapshotSynthesizer* m_snapshot_synthesizer = nullptr;
+		RetransmissionServer* m_retransmission_server = nullptr;
 		
 
 		void run() noexcept;
 
 	public:
-		MarketDataPublisher(MEMarketUpdateLFQueue* market_updates, 
-			const std::string& iface, const std::string& snapshot_ip, 
-			int snapshot_port, const std::string& incremental_ip, int incremental_port);
+		MarketDataPublisher(MEMarketUpdateLFQueue* market_updates,
+			const std::string& iface, const MarketDataChannelCfgs& channels,
+			int retransmit_port, size_t max_packet_size = Common::McastDefaultPacketSize,
+			const SnapshotCfg& snapshot_cfg = {});
 		~MarketDataPublisher();
 
 		void start();
 		void stop();
+
+		void registerMetrics(Common::MetricsRegistry& metrics);
 	};
 }
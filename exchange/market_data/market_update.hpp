@@ -4,6 +4,7 @@
 
 #include "common/types.hpp"
 #include "common/lf_queue.hpp"
+#include "common/time_utils.hpp"
 
 using namespace Common;
 
@@ -85,6 +86,85 @@ namespace Exchange {
 		}
 
 	};
+
+	/// Starts every market data datagram, followed by m_msg_count MDPMarketUpdates.
+	/// Packet sequence numbers are per stream and let subscribers detect loss
+	/// once per packet rather than once per message.
+	struct MDPPacketHeader {
+		size_t m_packet_seq_num = 0;
+		uint16_t m_msg_count = 0;
+		Nanos m_send_time = 0;
+
+		auto toString() const {
+			std::stringstream ss;
+			ss << "MDPPacketHeader" <<
+				" [" <<
+				"packet_seq:" << m_packet_seq_num <<
+				" msg_count:" << m_msg_count <<
+				" send_time:" << m_send_time <<
+				"]";
+			return ss.str();
+		}
+	};
+
+	enum class MDPRetransmitStatus : int8_t {
+		INVALID = 0,
+		ACCEPTED = 1,
+		UNAVAILABLE = 2
+	};
+
+	inline std::string mdpRetransmitStatusToString(MDPRetransmitStatus status) {
+		switch (status) {
+		case MDPRetransmitStatus::ACCEPTED:
+			return "ACCEPTED";
+		case MDPRetransmitStatus::UNAVAILABLE:
+			return "UNAVAILABLE";
+		case MDPRetransmitStatus::INVALID:
+			return "INVALID";
+		}
+		return "UNKNOWN";
+	}
+
+	/// Asks the RetransmissionServer for the incremental updates
+	/// [m_begin_seq_num, m_end_seq_num) of one market data channel.
+	struct MDPRetransmitRequest {
+		size_t m_channel_id = 0;
+		size_t m_begin_seq_num = 0;
+		size_t m_end_seq_num = 0;
+
+		auto toString() const {
+			std::stringstream ss;
+			ss << "MDPRetransmitRequest" <<
+				" [" <<
+				"channel:" << m_channel_id <<
+				" begin:" << m_begin_seq_num <<
+				" end:" << m_end_seq_num <<
+				"]";
+			return ss.str();
+		}
+	};
+
+	/// Answer to an MDPRetransmitRequest, followed by m_msg_count MDPMarketUpdates
+	/// starting at m_begin_seq_num. Large ranges may be answered only in part,
+	/// ranges that aged out of the server's window come back UNAVAILABLE.
+	struct MDPRetransmitResponse {
+		size_t m_channel_id = 0;
+		MDPRetransmitStatus m_status = MDPRetransmitStatus::INVALID;
+		size_t m_begin_seq_num = 0;
+		uint32_t m_msg_count = 0;
+
+		auto toString() const {
+			std::stringstream ss;
+			ss << "MDPRetransmitResponse" <<
+				" [" <<
+				"channel:" << m_channel_id <<
+				" status:" << mdpRetransmitStatusToString(m_status) <<
+				" begin:" << m_begin_seq_num <<
+				" msg_count:" << m_msg_count <<
+				"]";
+			return ss.str();
+		}
+	};
 #pragma pack(pop)
 
 		typedef LFQueue<MEMarketUpdate> MEMarketUpdateLFQueue;
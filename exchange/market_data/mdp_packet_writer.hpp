@@ -0,0 +1,66 @@
+#pragma once
+
+#include "common/mcast_socket.hpp"
+#include "common/time_utils.hpp"
+
+#include "exchange/market_data/market_update.hpp"
+
+namespace Exchange {
+
+	/// Packs MDPMarketUpdates into the socket's datagrams, each starting with an
+	/// MDPPacketHeader. A packet is stamped with its send time when it is closed,
+	/// either because the next update does not fit or on flush().
+	class MDPPacketWriter {
+
+		Common::McastSocket* m_socket = nullptr;
+		size_t m_next_packet_seq_num = 1;
+
+		auto openHeader() noexcept {
+			return reinterpret_cast<MDPPacketHeader*>(m_socket->openPacket());
+		}
+
+		auto closePacket() noexcept {
+			if (auto header = openHeader()) {
+				header->m_send_time = Common::getCurrentNanos();
+				m_socket->closePacket();
+			}
+		}
+
+	public:
+		MDPPacketWriter(Common::McastSocket* socket, size_t max_packet_size) :
+			m_socket(socket) {
+			ASSERT(max_packet_size >= sizeof(MDPPacketHeader) + sizeof(MDPMarketUpdate),
+				"Market data packet size " + std::to_string(max_packet_size) +
+				" cannot hold a single update.");
+			m_socket->setMaxPacketSize(max_packet_size);
+		}
+
+		MDPPacketWriter() = delete;
+		MDPPacketWriter(const MDPPacketWriter&) = delete;
+		MDPPacketWriter(const MDPPacketWriter&&) = delete;
+		MDPPacketWriter& operator=(const MDPPacketWriter&) = delete;
+		MDPPacketWriter& operator=(const MDPPacketWriter&&) = delete;
+
+		auto add(const MDPMarketUpdate& market_update) noexcept {
+			if (!openHeader() || m_socket->openPacketSize() + sizeof(MDPMarketUpdate) >
+				m_socket->m_max_packet_size) {
+				closePacket();
+				const MDPPacketHeader header{ m_next_packet_seq_num++, 0, 0 };
+				m_socket->send(&header, sizeof(MDPPacketHeader));
+			}
+			m_socket->send(&market_update, sizeof(MDPMarketUpdate));
+			++openHeader()->m_msg_count;
+		}
+
+		/// Packets queued or still in flight, flush() has work to do.
+		auto pending() const noexcept {
+			return m_socket->m_outbound_count != 0;
+		}
+
+		/// Close the open packet and send everything queued.
+		auto flush() noexcept {
+			closePacket();
+			m_socket->sendAndRecv();
+		}
+	};
+}
@@ -0,0 +1,117 @@
+#include "exchange/market_data/retransmission_server.hpp"
+
+namespace Exchange {
+
+	RetransmissionServer::RetransmissionServer(MDPMarketUpdateLFQueue* market_updates,
+		const std::string& iface, int port, const MarketDataChannelCfgs& channels) :
+		m_md_updates(market_updates), m_iface(iface), m_port(port),
+		m_logger("exchange_retransmission_server.log"), m_tcp_server(m_logger),
+		m_ticker_channel(tickerChannels(channels)) {
+		for (const auto& cfg : channels)
+			m_channels.push_back(new Channel(cfg));
+
+		m_tcp_server.m_recv_callback = [this](auto socket, auto rx_time) {
+			recvCallback(socket, rx_time); };
+		m_tcp_server.m_recv_finished_callback = []() {};
+	}
+
+	RetransmissionServer::~RetransmissionServer() {
+		stop();
+
+		using namespace std::literals::chrono_literals;
+		std::this_thread::sleep_for(1s);
+
+		for (auto channel : m_channels)
+			delete channel;
+		m_channels.clear();
+	}
+
+	void RetransmissionServer::start() {
+		m_run = true;
+
+		m_tcp_server.listen(m_iface, m_port);
+
+		ASSERT(Common::createAndStartThread(-1, "Exchange/RetransmissionServer",
+			[this]() { run(); }) != nullptr, "Failed to start RetransmissionServer thread.");
+	}
+
+	void RetransmissionServer::stop() {
+		m_run = false;
+	}
+
+	void RetransmissionServer::run() noexcept {
+		m_logger.log("%:% %() % port:%\n", __FILE__, __LINE__, __FUNCTION__,
+			Common::getCurrentTimeStr(&m_time_str), m_port);
+
+		while (m_run) {
+			// Updates are queued before their packet goes out, so anything a
+			// subscriber can have missed is in the window before its request is read.
+			for (auto market_update = m_md_updates->getNextToRead();
+				m_md_updates->size() && market_update;
+				market_update = m_md_updates->getNextToRead()) {
+				auto channel = m_channels[m_ticker_channel.at(
+					market_update->m_me_market_update.m_ticker_id)];
+				ASSERT(market_update->m_seq_num == channel->m_next_seq_num,
+					"Expected incremental seq_nums to increase on " + channel->m_cfg.toString());
+
+				channel->m_updates[market_update->m_seq_num % ME_MAX_RETRANSMIT_UPDATES] =
+					*market_update;
+				channel->m_next_seq_num++;
+				m_md_updates->updateReadIndex();
+			}
+
+			m_tcp_server.poll();
+			m_tcp_server.sendAndRecv();
+		}
+	}
+
+	void RetransmissionServer::recvCallback(Common::TCPSocket* socket, Nanos rx_time) noexcept {
+		const auto recv_data = socket->m_recv_ring.data();
+		const auto recv_len = socket->m_recv_ring.size();
+		size_t i = 0;
+		for (; i + sizeof(MDPRetransmitRequest) <= recv_len; i += sizeof(MDPRetransmitRequest)) {
+			auto request = reinterpret_cast<const MDPRetransmitRequest*>(recv_data + i);
+			m_logger.log("%:% %() % Received socket:% rx:% %\n", __FILE__, __LINE__,
+				__FUNCTION__, Common::getCurrentTimeStr(&m_time_str), socket->m_fd, rx_time,
+				request->toString());
+			retransmit(socket, *request);
+		}
+		socket->m_recv_ring.consume(i);
+	}
+
+	void RetransmissionServer::retransmit(Common::TCPSocket* socket,
+		const MDPRetransmitRequest& request) noexcept {
+		MDPRetransmitResponse response{ request.m_channel_id,
+			MDPRetransmitStatus::UNAVAILABLE, request.m_begin_seq_num, 0 };
+
+		Channel* channel = nullptr;
+		for (auto c : m_channels) {
+			if (c->m_cfg.m_channel_id == request.m_channel_id)
+				channel = c;
+		}
+
+		if (channel && request.m_begin_seq_num >= channel->oldestSeqNum() &&
+			request.m_begin_seq_num < request.m_end_seq_num &&
+			request.m_begin_seq_num < channel->m_next_seq_num) {
+			const auto end_seq_num = std::min(request.m_end_seq_num, channel->m_next_seq_num);
+			response.m_status = MDPRetransmitStatus::ACCEPTED;
+			response.m_msg_count = static_cast<uint32_t>(end_seq_num - request.m_begin_seq_num);
+		}
+
+		m_logger.log("%:% %() % Sending socket:% %\n", __FILE__, __LINE__, __FUNCTION__,
+			Common::getCurrentTimeStr(&m_time_str), socket->m_fd, response.toString());
+		socket->send(&response, sizeof(MDPRetransmitResponse));
+
+		// The window wraps at most once within a range.
+		const auto begin = response.m_begin_seq_num % ME_MAX_RETRANSMIT_UPDATES;
+		const auto first = std::min<size_t>(response.m_msg_count,
+			ME_MAX_RETRANSMIT_UPDATES - begin);
+		if (first) {
+			socket->send(&channel->m_updates[begin], first * sizeof(MDPMarketUpdate));
+			if (first < response.m_msg_count) {
+				socket->send(channel->m_updates.data(),
+					(response.m_msg_count - first) * sizeof(MDPMarketUpdate));
+			}
+		}
+	}
+}
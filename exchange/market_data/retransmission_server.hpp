@@ -0,0 +1,70 @@
+#pragma once
+
+#include <vector>
+
+#include "common/thread_utils.hpp"
+#include "common/macros.hpp"
+#include "common/lf_queue.hpp"
+#include "common/logging.hpp"
+#include "common/tcp_server.hpp"
+
+#include "exchange/market_data/market_update.hpp"
+#include "exchange/market_data/market_data_channel.hpp"
+
+namespace Exchange {
+
+	/// Keeps the last ME_MAX_RETRANSMIT_UPDATES incremental updates of every market
+	/// data channel and answers MDPRetransmitRequests for them over TCP, so that
+	/// subscribers can fill small gaps without waiting for the next snapshot.
+	class RetransmissionServer {
+
+		/// Window of recent updates of one channel, indexed by seq_num.
+		struct Channel {
+			MarketDataChannelCfg m_cfg;
+			std::vector<MDPMarketUpdate> m_updates;
+			size_t m_next_seq_num = 1;
+
+			explicit Channel(const MarketDataChannelCfg& cfg) :
+				m_cfg(cfg), m_updates(ME_MAX_RETRANSMIT_UPDATES) {
+			}
+
+			auto oldestSeqNum() const noexcept {
+				return m_next_seq_num > ME_MAX_RETRANSMIT_UPDATES ?
+					m_next_seq_num - ME_MAX_RETRANSMIT_UPDATES : 1;
+			}
+		};
+
+		MDPMarketUpdateLFQueue* m_md_updates = nullptr;
+
+		const std::string m_iface;
+		const int m_port = 0;
+
+		volatile bool m_run = false;
+
+		std::string m_time_str;
+		Logger m_logger;
+
+		Common::TCPServer m_tcp_server;
+
+		std::vector<Channel*> m_channels;
+		TickerChannelHashMap m_ticker_channel;
+
+		void run() noexcept;
+		void recvCallback(Common::TCPSocket* socket, Nanos rx_time) noexcept;
+		void retransmit(Common::TCPSocket* socket, const MDPRetransmitRequest& request) noexcept;
+
+	public:
+		RetransmissionServer(MDPMarketUpdateLFQueue* market_updates,
+			const std::string& iface, int port, const MarketDataChannelCfgs& channels);
+		~RetransmissionServer();
+
+		RetransmissionServer() = delete;
+		RetransmissionServer(const RetransmissionServer&) = delete;
+		RetransmissionServer(const RetransmissionServer&&) = delete;
+		RetransmissionServer& operator=(const RetransmissionServer&) = delete;
+		RetransmissionServer& operator=(const RetransmissionServer&&) = delete;
+
+		void start();
+		void stop();
+	};
+}
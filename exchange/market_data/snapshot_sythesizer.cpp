@@ -3,16 +3,29 @@
 namespace Exchange {
 
 	SnapshotSynthesizer::SnapshotSynthesizer(MDPMarketUpdateLFQueue* market_updates,
-		const std::string& iface, const std::string& snapshot_ip, int snapshot_port) :
+		const std::string& iface, const MarketDataChannelCfgs& channels,
+		size_t max_packet_size, const SnapshotCfg& cfg) :
 		m_snapshot_md_updates(market_updates), m_logger("exchange_snapshot_synthesizer.log"),
-		m_snapshot_socket(m_logger), m_order_pool(ME_MAX_ORDER_IDS) {
-
-		ASSERT(m_snapshot_socket.init(snapshot_ip, iface, snapshot_port, false) >= 0,
-			"Unable to create snapshot mcast socket. error:" +
-			std::string(std::strerror(errno)));
+		m_ticker_channel(tickerChannels(channels)), m_cfg(cfg),
+		m_updates_per_packet((max_packet_size - sizeof(MDPPacketHeader)) /
+			sizeof(MDPMarketUpdate)) {
+		ASSERT(m_cfg.m_bytes_per_ms, "Snapshot pacing budget must not be 0: " +
+			m_cfg.toString());
+
+		for (const auto& cfg : channels) {
+			auto channel = new Channel(cfg, m_logger, max_packet_size);
+			ASSERT(channel->m_socket.init(cfg.m_snapshot_ip, iface, cfg.m_snapshot_port,
+				false) >= 0, "Unable to create snapshot mcast socket for " +
+				cfg.toString() + " error:" + std::string(std::strerror(errno)));
+			m_channels.push_back(channel);
+		}
 	}
 	SnapshotSynthesizer::~SnapshotSynthesizer() {
 		stop();
+
+		for (auto channel : m_channels)
+			delete channel;
+		m_channels.clear();
 	}
 
 	void SnapshotSynthesizer::start() {
@@ -26,9 +39,10 @@ namespace Exchange {
 	}
 
 	void SnapshotSynthesizer::run() {
-		m_logger.log("%:% %() %\n", __FILE__, __LINE__,
-			__FUNCTION__, getCurrentTimeStr(&m_time_str));
+		m_logger.log("%:% %() % %\n", __FILE__, __LINE__,
+			__FUNCTION__, getCurrentTimeStr(&m_time_str), m_cfg.toString());
 
+		m_budget_time = getCurrentNanos();
 		while (m_run) {
 			for (auto market_update = m_snapshot_md_updates->getNextToRead();
 				m_snapshot_md_updates->size() && market_update;
@@ -41,29 +55,37 @@ namespace Exchange {
 				m_snapshot_md_updates->updateReadIndex();
 			}
 
-			if (getCurrentNanos() - m_last_snapshot_time > 60 * NANOS_TO_SECS) {
-				m_last_snapshot_time = getCurrentNanos();
-				publishSnapshot();
+			if (!m_snapshot_channel) {
+				const auto now = getCurrentNanos();
+				for (auto channel : m_channels) {
+					if (now >= channel->m_next_snapshot_time) {
+						channel->m_next_snapshot_time = now + m_cfg.m_cycle_interval;
+						captureSnapshot(channel);
+						break;
+					}
+				}
 			}
+			if (m_snapshot_channel)
+				publishSnapshotPackets();
 		}
 	}
 
 	void SnapshotSynthesizer::addToSnapshot(const MDPMarketUpdate* market_update) {
 		const auto& me_market_update = market_update->m_me_market_update;
-		auto* orders = &m_ticker_orders.at(me_market_update.m_ticker_id);
+		auto& orders = m_ticker_orders.at(me_market_update.m_ticker_id);
 
 		switch (me_market_update.m_type)
 		{
 		case MarketUpdateType::ADD: {
-			auto order = orders->at(me_market_update.m_order_id);
+			auto order = orders.find(me_market_update.m_order_id);
 			ASSERT(order == nullptr, "Received: " + me_market_update.toString() +
 				" but order already exists: " + (order ? order->toString() : ""));
-			orders->at(me_market_update.m_ticker_id) = m_order_pool.allocate(me_market_update);
+			orders.add(me_market_update);
 		}
 			break;
 
 		case MarketUpdateType::MODIFY: {
-			auto order = orders->at(me_market_update.m_order_id);
+			auto order = orders.find(me_market_update.m_order_id);
 			ASSERT(order != nullptr, "Received: " + me_market_update.toString() +
 				" but order does not exist.");
 			ASSERT(order->m_order_id == me_market_update.m_order_id,
@@ -76,15 +98,14 @@ namespace Exchange {
 			break;
 
 		case MarketUpdateType::CANCEL: {
-			auto order = orders->at(me_market_update.m_order_id);
+			auto order = orders.find(me_market_update.m_order_id);
 			ASSERT(order != nullptr, "Received: " + me_market_update.toString() +
 				" but order does not exist.");
 			ASSERT(order->m_order_id == me_market_update.m_order_id,
 				"Expecting existing order to match new one.");
 			ASSERT(order->m_side == me_market_update.m_side,
 				"Expecting existing order to match new one.");
-			m_order_pool.deallocate(order);
-			orders->at(me_market_update.m_order_id) = nullptr;
+			orders.remove(me_market_update.m_order_id);
 		}
 			break;
 
@@ -97,51 +118,72 @@ namespace Exchange {
 			break;
 		}
 
-		ASSERT(market_update->m_seq_num == m_last_inc_seq_num + 1,
-			"Expected incremental seq_nums to increase.");
-		m_last_inc_seq_num = market_update->m_seq_num;
+		auto channel = m_channels[m_ticker_channel.at(me_market_update.m_ticker_id)];
+		ASSERT(market_update->m_seq_num == channel->m_last_inc_seq_num + 1,
+			"Expected incremental seq_nums to increase on " + channel->m_cfg.toString());
+		channel->m_last_inc_seq_num = market_update->m_seq_num;
 	}
 
-	void SnapshotSynthesizer::publishSnapshot() {
-		size_t snapshot_size = 0;
+	void SnapshotSynthesizer::captureSnapshot(Channel* channel) {
+		auto& snapshot = channel->m_snapshot;
+		snapshot.clear();
+		channel->m_snapshot_next = 0;
 
-		const MDPMarketUpdate start_market_update{ snapshot_size++,
-			{MarketUpdateType::SNAPSHOT_START, m_last_inc_seq_num} };
-		m_logger.log("%: % %() % %\n", __FILE__, __LINE__, __FUNCTION__,
-			getCurrentTimeStr(&m_time_str), start_market_update.toString());
-		m_snapshot_socket.send(&start_market_update, sizeof(MDPMarketUpdate));
-
-		for (size_t ticker_id = 0; ticker_id < m_ticker_orders.size(); ticker_id++) {
-			const auto& orders = m_ticker_orders.at(ticker_id);
+		snapshot.push_back({ snapshot.size(),
+			{MarketUpdateType::SNAPSHOT_START, channel->m_last_inc_seq_num} });
 
+		for (const auto ticker_id : channel->m_cfg.m_tickers) {
 			MEMarketUpdate me_market_update;
 			me_market_update.m_type = MarketUpdateType::CLEAR;
 			me_market_update.m_ticker_id = ticker_id;
+			snapshot.push_back({ snapshot.size(), me_market_update });
 
-			const MDPMarketUpdate clear_market_update{ snapshot_size++, me_market_update };
-			m_logger.log("%: % %() % %\n", __FILE__, __LINE__, __FUNCTION__,
-				getCurrentTimeStr(&m_time_str), clear_market_update.toString());
-			m_snapshot_socket.send(&clear_market_update, sizeof(MDPMarketUpdate));
-
-			for (const auto order : orders) {
-				if (order) {
-					const MDPMarketUpdate market_update{ snapshot_size++, *order };
-					m_logger.log("%: % %() % %\n", __FILE__, __LINE__, __FUNCTION__,
-						getCurrentTimeStr(&m_time_str), market_update.toString());
-					m_snapshot_socket.send(&market_update, sizeof(MDPMarketUpdate));
-					m_snapshot_socket.sendAndRecv();
-				}
-			}
+			for (const auto& order : m_ticker_orders.at(ticker_id).m_orders)
+				snapshot.push_back({ snapshot.size(), order });
 		}
 
-		const MDPMarketUpdate end_market_update{ snapshot_size++,
-		{MarketUpdateType::SNAPSHOT_END, m_last_inc_seq_num} };
-		m_logger.log("%: % %() % %\n", __FILE__, __LINE__, __FUNCTION__,
-			getCurrentTimeStr(&m_time_str), end_market_update.toString());
-		m_snapshot_socket.send(&end_market_update, sizeof(MDPMarketUpdate));
-		m_snapshot_socket.sendAndRecv();
+		snapshot.push_back({ snapshot.size(),
+			{MarketUpdateType::SNAPSHOT_END, channel->m_last_inc_seq_num} });
+
+		m_logger.log("%:% %() % Captured snapshot of % orders on channel % at seq:%.\n",
+			__FILE__, __LINE__, __FUNCTION__, getCurrentTimeStr(&m_time_str),
+			snapshot.size() - 1, channel->m_cfg.m_channel_id, channel->m_last_inc_seq_num);
+		m_snapshot_channel = channel;
+	}
+
+	void SnapshotSynthesizer::publishSnapshotPackets() {
+		const auto max_packet_bytes = sizeof(MDPPacketHeader) +
+			m_updates_per_packet * sizeof(MDPMarketUpdate);
+		const auto now = getCurrentNanos();
+		const auto refill = m_cfg.m_bytes_per_ms * static_cast<size_t>(now - m_budget_time) /
+			NANOS_TO_MILLIS;
+		if (refill) {
+			m_budget_bytes = std::min(m_budget_bytes + refill,
+				std::max(m_cfg.m_bytes_per_ms, max_packet_bytes));
+			m_budget_time = now;
+		}
+
+		auto channel = m_snapshot_channel;
+		const auto& snapshot = channel->m_snapshot;
+		auto& next = channel->m_snapshot_next;
+		while (next < snapshot.size()) {
+			const auto count = std::min(m_updates_per_packet, snapshot.size() - next);
+			const auto packet_bytes = sizeof(MDPPacketHeader) + count * sizeof(MDPMarketUpdate);
+			if (packet_bytes > m_budget_bytes)
+				return;
+
+			for (const auto end = next + count; next < end; ++next) {
+				m_logger.log("%: % %() % %\n", __FILE__, __LINE__, __FUNCTION__,
+					getCurrentTimeStr(&m_time_str), snapshot[next].toString());
+				channel->m_writer.add(snapshot[next]);
+			}
+			channel->m_writer.flush();
+			m_budget_bytes -= packet_bytes;
+		}
 
-		m_logger.log("%:% %() % Published snapshot of % orders.\n", __FILE__,
-			__LINE__, __FUNCTION__, getCurrentTimeStr(&m_time_str), snapshot_size - 1);
+		m_logger.log("%:% %() % Published snapshot of % orders on channel %.\n", __FILE__,
+			__LINE__, __FUNCTION__, getCurrentTimeStr(&m_time_str), snapshot.size() - 1,
+			channel->m_cfg.m_channel_id);
+		m_snapshot_channel = nullptr;
 	}
 }
@@ -5,43 +5,125 @@
 #include "common/time_utils.hpp"
 #include "common/macros.hpp"
 #include "common/lf_queue.hpp"
-#include "common/mem_pool.hpp"
 #include "common/logging.hpp"
 #include "common/mcast_socket.hpp"
 
 #include "exchange/market_data/market_update.hpp"
+#include "exchange/market_data/mdp_packet_writer.hpp"
+#include "exchange/market_data/market_data_channel.hpp"
 #include "exchange/matcher/me_order.hpp"
 
+#include <algorithm>
 #include <cstring>
+#include <vector>
 
 using namespace Common;
 
 namespace Exchange {
 
+	struct SnapshotCfg {
+		/// A channel's next snapshot starts this long after its previous one started.
+		Nanos m_cycle_interval = 1 * NANOS_TO_SECS;
+		/// Pacing budget shared by all snapshot groups, bursts never exceed one
+		/// millisecond worth of it (or one packet).
+		size_t m_bytes_per_ms = 16 * 1024;
+
+		auto toString() const {
+			std::stringstream ss;
+			ss << "SnapshotCfg[" <<
+				"cycle_interval:" << m_cycle_interval <<
+				" bytes_per_ms:" << m_bytes_per_ms <<
+				"]";
+			return ss.str();
+		}
+	};
+
 	class SnapshotSynthesizer {
 
+		/// Snapshot stream of one market data channel.
+		struct Channel {
+			MarketDataChannelCfg m_cfg;
+			McastSocket m_socket;
+			MDPPacketWriter m_writer;
+			size_t m_last_inc_seq_num = 0;
+
+			/// Snapshot captured at one incremental seq_num, sent out a packet at a
+			/// time from m_snapshot_next while the live state moves on.
+			std::vector<MDPMarketUpdate> m_snapshot;
+			size_t m_snapshot_next = 0;
+			Nanos m_next_snapshot_time = 0;
+
+			Channel(const MarketDataChannelCfg& cfg, Logger& logger,
+				size_t max_packet_size) :
+				m_cfg(cfg), m_socket(logger), m_writer(&m_socket, max_packet_size) {
+			}
+		};
+
+		/// Live orders of one ticker, kept dense so a snapshot only walks those.
+		/// Removal swaps the last order into the freed slot.
+		struct TickerOrders {
+			static constexpr uint32_t Slot_INVALID = std::numeric_limits<uint32_t>::max();
+
+			std::vector<MEMarketUpdate> m_orders;
+			/// OrderId -> index into m_orders. Market order ids are handed out in
+			/// sequence per ticker, so this grows with the ids actually seen.
+			std::vector<uint32_t> m_order_slot;
+
+			auto find(OrderId order_id) noexcept -> MEMarketUpdate* {
+				if (order_id >= m_order_slot.size() || m_order_slot[order_id] == Slot_INVALID)
+					return nullptr;
+				return &m_orders[m_order_slot[order_id]];
+			}
+
+			auto add(const MEMarketUpdate& order) noexcept {
+				ASSERT(order.m_order_id < ME_MAX_ORDER_IDS, "OrderId " +
+					orderIdToString(order.m_order_id) + " out of range.");
+				if (order.m_order_id >= m_order_slot.size())
+					m_order_slot.resize(std::max<size_t>(order.m_order_id + 1,
+						2 * m_order_slot.size()), Slot_INVALID);
+				m_order_slot[order.m_order_id] = static_cast<uint32_t>(m_orders.size());
+				m_orders.push_back(order);
+			}
+
+			auto remove(OrderId order_id) noexcept {
+				const auto slot = m_order_slot[order_id];
+				if (slot + 1 != m_orders.size()) {
+					m_orders[slot] = m_orders.back();
+					m_order_slot[m_orders[slot].m_order_id] = slot;
+				}
+				m_orders.pop_back();
+				m_order_slot[order_id] = Slot_INVALID;
+			}
+		};
+
 		MDPMarketUpdateLFQueue* m_snapshot_md_updates = nullptr;
 
 		Logger m_logger;
 		volatile bool m_run;
 		std::string m_time_str;
 
-		McastSocket m_snapshot_socket;
+		std::vector<Channel*> m_channels;
+		TickerChannelHashMap m_ticker_channel;
 
-		std::array<std::array<MEMarketUpdate*, ME_MAX_ORDER_IDS>, ME_MAX_TICKERS> 
-			m_ticker_orders;
-		size_t m_last_inc_seq_num = 0;
-		Nanos m_last_snapshot_time = 0;
+		std::array<TickerOrders, ME_MAX_TICKERS> m_ticker_orders;
 
-		MemPool<MEMarketUpdate> m_order_pool;
+		const SnapshotCfg m_cfg;
+		const size_t m_updates_per_packet;
+		/// Channel whose snapshot is being sent, one at a time.
+		Channel* m_snapshot_channel = nullptr;
+		size_t m_budget_bytes = 0;
+		Nanos m_budget_time = 0;
 
 		void run();
 		void addToSnapshot(const MDPMarketUpdate* market_update);
-		void publishSnapshot();
+		void captureSnapshot(Channel* channel);
+		void publishSnapshotPackets();
 
 	public:
 		SnapshotSynthesizer(MDPMarketUpdateLFQueue* market_updates, 
-			const std::string& iface, const std::string& snapshot_ip, int snapshot_port);
+			const std::string& iface, const MarketDataChannelCfgs& channels,
+			size_t max_packet_size = Common::McastDefaultPacketSize,
+			const SnapshotCfg& cfg = {});
 		~SnapshotSynthesizer();
 
 		void start();
@@ -16,8 +16,15 @@ namespace Exchange {
 	MatchingEngine::~MatchingEngine() {
 		m_run = false;
 
-		using namespace std::literals::chrono_literals;
-		std::this_thread::sleep_for(1s);
+		// Lets the thread see m_run, engines driven directly never had one.
+		if (m_thread) {
+			using namespace std::literals::chrono_literals;
+			std::this_thread::sleep_for(1s);
+		}
+
+		m_logger.log("%:% %() % processClientRequest ns %\n", __FILE__, __LINE__,
+			__FUNCTION__, Common::getCurrentTimeStr(&m_time_str),
+			m_process_latency.snapshot().toString(Common::tscPerNano()));
 
 		m_incoming_requests = nullptr;
 		m_outgoing_ogw_responses = nullptr;
@@ -31,14 +38,37 @@ namespace Exchange {
 
 	void MatchingEngine::start() {
 		m_run = true;
-		ASSERT(Common::createAndStartThread(-1, "Exchange/MatchingEngine",
-			[this]() { run(); }) != nullptr, "Failed to start MatchingEngine thread.");
+		m_thread = Common::createAndStartThread(-1, "Exchange/MatchingEngine",
+			[this]() { run(); });
+		ASSERT(m_thread != nullptr, "Failed to start MatchingEngine thread.");
 	}
 
 	void MatchingEngine::stop() {
 		m_run = false;
 	}
 
+	void MatchingEngine::registerMetrics(Common::MetricsRegistry& metrics) {
+		metrics.addCounter("me.requests", &m_num_requests);
+		metrics.addHistogram("me.process_ns", &m_process_latency, Common::tscPerNano());
+		metrics.addGauge("me.incoming_requests", [this]() { return m_incoming_requests->size(); });
+		metrics.addGauge("me.outgoing_responses",
+			[this]() { return m_outgoing_ogw_responses->size(); });
+		metrics.addGauge("me.outgoing_md_updates",
+			[this]() { return m_outgoing_md_updates->size(); });
+		metrics.addGauge("me.order_pool", [this]() {
+			size_t num_used = 0;
+			for (const auto order_book : m_ticker_order_book)
+				num_used += order_book->orderPool().numUsed();
+			return num_used;
+		});
+		metrics.addGauge("me.orders_at_price_pool", [this]() {
+			size_t num_used = 0;
+			for (const auto order_book : m_ticker_order_book)
+				num_used += order_book->ordersAtPricePool().numUsed();
+			return num_used;
+		});
+	}
+
 	void MatchingEngine::run() noexcept {
 		m_logger.log("%: % %() %\n", __FILE__, __LINE__,
 			__FUNCTION__, Common::getCurrentTimeStr(&m_time_str));
@@ -49,13 +79,23 @@ namespace Exchange {
 			if (me_client_request) [[likely]] {
 				m_logger.log("%:% %() % Processing %\n", __FILE__, __LINE__, __FUNCTION__,
 					Common::getCurrentTimeStr(&m_time_str), me_client_request->toString());
+				const auto start_tsc = Common::rdtsc();
 				processClientRequest(me_client_request);
+				m_process_latency.record(Common::rdtsc() - start_tsc);
+				m_num_requests.inc();
 				m_incoming_requests->updateReadIndex();
 			}
 		}
 	}
 
+	void MatchingEngine::reset() noexcept {
+		for (auto order_book : m_ticker_order_book)
+			order_book->reset();
+	}
+
 	void MatchingEngine::processClientRequest(const MEClientRequest* client_request) noexcept {
+		Common::trace(Common::TraceHop::ME_PROCESS, Common::traceOrderKey(
+			client_request->m_client_id, client_request->m_order_id));
 		auto order_book = m_ticker_order_book[client_request->m_ticker_id];
 
 		switch (client_request->m_type)
@@ -68,6 +108,7 @@ namespace Exchange {
 		case ClientRequestType::CANCEL:
 			order_book->cancel(client_request->m_client_id, client_request->m_order_id,
 				client_request->m_ticker_id);
+			break;
 		default:
 			FATAL("Receive invalid client-request-type: " +
 				clientRequestTypeToString(client_request->m_type));
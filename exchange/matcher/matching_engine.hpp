@@ -3,7 +3,10 @@
 #include "common/lf_queue.hpp"
 #include "common/macros.hpp"
 #include "common/logging.hpp"
+#include "common/latency_histogram.hpp"
+#include "common/metrics.hpp"
 #include "common/time_utils.hpp"
+#include "common/trace.hpp"
 
 #include "exchange/order_server/client_request.hpp"
 #include "exchange/order_server/client_response.hpp"
@@ -24,6 +27,11 @@ namespace Exchange {
 		MEMarketUpdateLFQueue* m_outgoing_md_updates = nullptr;
 
 		volatile bool m_run = false;
+		std::thread* m_thread = nullptr;
+
+		/// TSC ticks spent in processClientRequest().
+		Common::LatencyRecorder m_process_latency;
+		Common::MetricCounter m_num_requests;
 
 		std::string m_time_str;
 		Common::Logger m_logger;
@@ -42,9 +50,14 @@ namespace Exchange {
 		void start();
 		void stop();
 
+		const auto& processLatency() const noexcept { return m_process_latency; }
+		void registerMetrics(Common::MetricsRegistry& metrics);
+
 		void run() noexcept;
 
 		void processClientRequest(const MEClientRequest* client_request) noexcept;
+		/// Empties every book, for a Backtester to start over with.
+		void reset() noexcept;
 		void sendClientResponse(const MEClientResponse* client_response) noexcept;
 		void sendMarketUpdate(const MEMarketUpdate* market_update) noexcept;
 	};
@@ -20,9 +20,16 @@ namespace Exchange {
 
 		m_matching_engine = nullptr;
 		m_bids_by_price = m_asks_by_price = nullptr;
-		for (auto& itr : m_cid_oid_to_order) {
-			itr.fill(nullptr);
-		}
+	}
+
+	void MEOrderBook::reset() noexcept {
+		while (m_bids_by_price)
+			removeOrder(m_bids_by_price->m_first_me_order);
+		while (m_asks_by_price)
+			removeOrder(m_asks_by_price->m_first_me_order);
+		m_order_pool.reset();
+		m_orders_at_price_pool.reset();
+		m_next_market_order_id = 1;
 	}
 
 	void MEOrderBook::add(ClientId client_id, OrderId client_order_id,
@@ -36,7 +43,7 @@ namespace Exchange {
 			ticker_id, side, price, qty, new_market_order_id);
 		if (leaves_qty) [[likely]] {
 			const auto priority = getNextPriority(price);
-			auto order = m_order_pool.allocate(ticker_id, client_id, client_order_id,
+			auto order = m_order_pool.allocate(client_id, ticker_id, client_order_id,
 				new_market_order_id, side, price, leaves_qty, priority, nullptr, nullptr);
 			addOrder(order);
 
@@ -120,20 +127,20 @@ namespace Exchange {
 			auto target = best_orders_by_price;
 			bool add_after = ((new_orders_at_price->m_side == Side::SELL &&
 				new_orders_at_price->m_price > target->m_price) ||
-				(new_orders_at_price->m_side == Side::BUY && new_orders_at_price->m_price));
+				(new_orders_at_price->m_side == Side::BUY && new_orders_at_price->m_price < target->m_price));
 
 			if (add_after) {
 				target = target->m_next_entry;
 				add_after = ((new_orders_at_price->m_side == Side::SELL &&
 					new_orders_at_price->m_price > target->m_price) ||
 					(new_orders_at_price->m_side == Side::BUY &&
-						new_orders_at_price->m_price));
+						new_orders_at_price->m_price < target->m_price));
 			}
 			while (add_after && target != best_orders_by_price) {
 				add_after = ((new_orders_at_price->m_side == Side::SELL &&
 					new_orders_at_price->m_price > target->m_price) ||
 					(new_orders_at_price->m_side == Side::BUY &&
-						new_orders_at_price->m_price));
+						new_orders_at_price->m_price < target->m_price));
 				if (add_after)
 					target = target->m_next_entry;
 			}
@@ -148,15 +155,14 @@ namespace Exchange {
 				target->m_next_entry = new_orders_at_price;
 			}
 			else {
-				new_orders_at_price->m_prev_entry = target->m_next_entry;
+				new_orders_at_price->m_prev_entry = target->m_prev_entry;
 				new_orders_at_price->m_next_entry = target;
 				target->m_prev_entry->m_next_entry = new_orders_at_price;
+				target->m_prev_entry = new_orders_at_price;
 				if ((new_orders_at_price->m_side == Side::BUY &&
 					new_orders_at_price->m_price > best_orders_by_price->m_price) ||
 					(new_orders_at_price->m_side == Side::SELL &&
 						new_orders_at_price->m_price < best_orders_by_price->m_price)) {
-					target->m_next_entry = (target->m_next_entry == best_orders_by_price ?
-						new_orders_at_price : target->m_next_entry);
 					(new_orders_at_price->m_side == Side::BUY ?
 						m_bids_by_price : m_asks_by_price) = new_orders_at_price;
 				}
@@ -229,7 +235,7 @@ namespace Exchange {
 		if (side == Side::SELL) {
 			while (leaves_qty && m_bids_by_price) {
 				const auto bid_itr = m_bids_by_price->m_first_me_order;
-				if (price < bid_itr->m_price) [[likely]]
+				if (price > bid_itr->m_price) [[likely]]
 					break;
 
 				match(ticker_id, client_id, side, client_order_id,
@@ -71,6 +71,12 @@ namespace Exchange {
 			TickerId ticker_id, Side side, Price price, Qty qty) noexcept;
 
 		void cancel(ClientId client_id, OrderId order_id, TickerId ticker_id) noexcept;
+
+		/// Drops every order without a response or update, back to a new book.
+		void reset() noexcept;
+
+		const auto& orderPool() const noexcept { return m_order_pool; }
+		const auto& ordersAtPricePool() const noexcept { return m_orders_at_price_pool; }
 	};
 
 	typedef std::array<MEOrderBook*, ME_MAX_TICKERS> OrderBookHashMap;
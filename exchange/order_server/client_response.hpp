@@ -82,4 +82,5 @@ namespace Exchange {
 #pragma pack(pop)
 
 	typedef LFQueue<MEClientResponse> ClientResponseLFQueue;
+	typedef LFQueue<OMClientResponse> OMClientResponseLFQueue;
 }
\ No newline at end of file
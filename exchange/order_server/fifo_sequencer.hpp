@@ -6,6 +6,8 @@
 #include "common/macros.hpp"
 #include "common/thread_utils.hpp"
 #include "common/time_utils.hpp"
+#include "common/trace.hpp"
+#include "common/metrics.hpp"
 
 #include "exchange/order_server/client_request.hpp"
 
@@ -13,36 +15,56 @@ namespace Exchange {
 
 	constexpr size_t ME_MAX_PENDING_REQUESTS = 1024;
 
+	struct RecvTimeClientRequest {
+		Nanos m_recv_time = 0;
+		MEClientRequest m_request;
+		auto operator<(const RecvTimeClientRequest& rhs) const {
+			return m_recv_time < rhs.m_recv_time;
+		}
+	};
+
+	typedef LFQueue<RecvTimeClientRequest> RecvTimeClientRequestLFQueue;
+
 	class FIFOSequencer {
 
 		ClientRequestLFQueue* m_incoming_requests = nullptr;
 		std::string m_time_str;
 		Common::Logger* m_logger = nullptr;
 
-		struct RecvTimeClientRequest {
+		struct PendingClientRequest {
 			Nanos m_recv_time = 0;
-			MEClientRequest m_request;
-			auto operator<(const RecvTimeClientRequest& rhs) const {
+			const MEClientRequest* m_request = nullptr;
+			auto operator<(const PendingClientRequest& rhs) const {
 				return m_recv_time < rhs.m_recv_time;
 			}
 		};
 
-		std::array<RecvTimeClientRequest, ME_MAX_PENDING_REQUESTS> m_pending_client_requests;
+		std::array<PendingClientRequest, ME_MAX_PENDING_REQUESTS> m_pending_client_requests;
 		size_t m_pending_size = 0;
 
+		Common::MetricCounter m_num_published;
+
 	public:
 		FIFOSequencer(ClientRequestLFQueue* client_requests, Logger* logger) :
 			m_incoming_requests(client_requests), m_logger(logger) {
 		}
 
+		/// Only a reference to the request is kept, it has to stay valid until
+		/// sequenceAndPublish(), which does the single copy into the matching engine queue.
 		auto addClientRequest(Nanos rx_time, const MEClientRequest& request) {
 			if (m_pending_size >= m_pending_client_requests.size()) {
 				FATAL("Too many pending requests");
 			}
 			m_pending_client_requests.at(m_pending_size++) =
-				std::move(RecvTimeClientRequest{ rx_time, request });
+				PendingClientRequest{ rx_time, &request };
+		}
+
+		auto pendingSize() const noexcept {
+			return m_pending_size;
 		}
 
+		const auto& numPublished() const noexcept { return m_num_published; }
+
 		auto sequenceAndPublish() {
 			if (!m_pending_size) [[unlikely]]
 				return;
@@ -57,13 +79,16 @@ namespace Exchange {
 				const auto& client_request = m_pending_client_requests.at(i);
 				m_logger->log("%: % %() % Writing RX: % Req: % to FIFO.\n", __FILE__,
 					__LINE__, __FUNCTION__, Common::getCurrentTimeStr(&m_time_str), 
-					client_request.m_recv_time, client_request.m_request.toString());
+					client_request.m_recv_time, client_request.m_request->toString());
 
+				Common::trace(Common::TraceHop::SEQUENCER_PUBLISH, Common::traceOrderKey(
+					client_request.m_request->m_client_id, client_request.m_request->m_order_id));
 				auto next_write = m_incoming_requests->getNextToWriteTo();
-				*next_write = std::move(client_request.m_request);
+				*next_write = *client_request.m_request;
 				m_incoming_requests->updateWriteIndex();
 			}
 
+			m_num_published.inc(m_pending_size);
 			m_pending_size = 0;
 		}
 	};
@@ -3,7 +3,8 @@
 namespace Exchange {
 
 	OrderServer::OrderServer(ClientRequestLFQueue* client_requests,
-		ClientResponseLFQueue* client_responses, const std::string& iface, int port) :
+		ClientResponseLFQueue* client_responses, const std::string& iface, int port,
+		size_t num_session_groups, const std::vector<int>& session_group_cores) :
 		m_iface(iface), m_port(port), m_outgoing_responses(client_responses),
 		m_logger("exchange_order_server.log"), m_tcp_server(m_logger),
 		m_fifo_sequencer(client_requests, &m_logger) {
@@ -15,7 +16,20 @@ namespace Exchange {
 		m_tcp_server.m_recv_callback = [this](auto socket, auto rx_time) {
 			recvCallback(socket, rx_time);	};
 		m_tcp_server.m_recv_finished_callback = [this]() {recvFinishedCallback(); };
+		m_tcp_server.m_disconnect_callback = [this](auto socket) {
+			disconnectCallback(socket); };
 
+		for (auto& session_group : m_cid_session_group) {
+			session_group = SessionGroup_INVALID;
+		}
+		if (num_session_groups > 1) {
+			for (size_t i = 0; i < num_session_groups; i++) {
+				const auto core_id = i < session_group_cores.size() ? session_group_cores[i] : -1;
+				m_session_groups.push_back(new OrderSessionGroup(static_cast<int>(i),
+					&m_cid_session_group, m_iface, m_port, core_id));
+			}
+			m_session_group_num_requests.resize(num_session_groups, 0);
+		}
 	}
 
 	OrderServer::~OrderServer() {
@@ -23,10 +37,26 @@ namespace Exchange {
 
 		using namespace std::literals::chrono_literals;
 		std::this_thread::sleep_for(1s);
+
+		for (auto& session_group : m_session_groups) {
+			delete session_group;
+			session_group = nullptr;
+		}
 	}
 
 	void OrderServer::start() {
 		m_run = true;
+
+		if (!m_session_groups.empty()) {
+			for (auto session_group : m_session_groups) {
+				session_group->start();
+			}
+			ASSERT(Common::createAndStartThread(-1, "Exchange/OrderServer",
+				[this]() { runSessionGroups(); }) != nullptr,
+				"Failed to start OrderServer thread.");
+			return;
+		}
+
 		m_tcp_server.listen(m_iface, m_port);
 
 		ASSERT(Common::createAndStartThread(-1, "Exchange/OrderServer", [this]() {run(); }) !=
@@ -35,6 +65,22 @@ namespace Exchange {
 
 	void OrderServer::stop() {
 		m_run = false;
+		for (auto session_group : m_session_groups) {
+			session_group->stop();
+		}
+	}
+
+	void OrderServer::registerMetrics(Common::MetricsRegistry& metrics) {
+		metrics.addCounter("os.requests", &m_fifo_sequencer.numPublished());
+		metrics.addCounter("os.responses", &m_num_responses);
+		metrics.addGauge("os.outgoing_responses", [this]() { return m_outgoing_responses->size(); });
+		for (size_t i = 0; i < m_session_groups.size(); ++i) {
+			const auto session_group = m_session_groups[i];
+			metrics.addGauge("os.group" + std::to_string(i) + ".incoming_requests",
+				[session_group]() { return session_group->incomingRequests()->size(); });
+			metrics.addGauge("os.group" + std::to_string(i) + ".outgoing_responses",
+				[session_group]() { return session_group->outgoingResponses()->size(); });
+		}
 	}
 
 	void OrderServer::run() noexcept {
@@ -55,14 +101,66 @@ namespace Exchange {
 					client_id, next_outgoing_seq_num,
 					client_response->toString());
 
-				ASSERT(m_cid_tcp_socket[client_id] != nullptr,	
-					"Don't have a TCPSocket for ClientId:" + std::to_string(client_id));
+				if (m_cid_tcp_socket[client_id] == nullptr) [[unlikely]] {
+					m_logger.log("%: % %() % Dropping response for disconnected ClientId: %\n",
+						__FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&m_time_str),
+						client_id);
+					m_outgoing_responses->updateReadIndex();
+					continue;
+				}
 
-				m_cid_tcp_socket[client_id]->send(&next_outgoing_seq_num, sizeof(next_outgoing_seq_num));
-				m_cid_tcp_socket[client_id]->send(client_response, sizeof(MEClientResponse));
+				const OMClientResponse om_client_response{ next_outgoing_seq_num, *client_response };
+				Common::trace(Common::TraceHop::OS_RESPONSE_SEND, Common::traceOrderKey(client_id,
+					client_response->m_client_order_id));
+				m_cid_tcp_socket[client_id]->send(&om_client_response, sizeof(OMClientResponse));
 
 				m_outgoing_responses->updateReadIndex();
 				next_outgoing_seq_num++;
+				m_num_responses.inc();
+			}
+		}
+	}
+
+	void OrderServer::runSessionGroups() noexcept {
+		m_logger.log("%: % %() % session groups: %\n", __FILE__, __LINE__,
+			__FUNCTION__, Common::getCurrentTimeStr(&m_time_str), m_session_groups.size());
+
+		while (m_run) {
+			for (size_t i = 0; i < m_session_groups.size(); i++) {
+				auto incoming_requests = m_session_groups[i]->incomingRequests();
+				size_t num_requests = 0;
+				for (auto request = incoming_requests->getNextToRead(num_requests);
+					request && m_fifo_sequencer.pendingSize() < ME_MAX_PENDING_REQUESTS;
+					request = incoming_requests->getNextToRead(++num_requests)) {
+					m_fifo_sequencer.addClientRequest(request->m_recv_time, request->m_request);
+				}
+				m_session_group_num_requests[i] = num_requests;
+			}
+			m_fifo_sequencer.sequenceAndPublish();
+			for (size_t i = 0; i < m_session_groups.size(); i++) {
+				m_session_groups[i]->incomingRequests()->updateReadIndex(
+					m_session_group_num_requests[i]);
+			}
+
+			for (auto client_response = m_outgoing_responses->getNextToRead();
+				m_outgoing_responses->size() && client_response;
+				client_response = m_outgoing_responses->getNextToRead()) {
+				const auto client_id = client_response->m_client_id;
+				const auto session_group = m_cid_session_group[client_id].load();
+				if (session_group == SessionGroup_INVALID) [[unlikely]] {
+					m_logger.log("%: % %() % Dropping response for disconnected ClientId: %\n",
+						__FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&m_time_str),
+						client_id);
+					m_outgoing_responses->updateReadIndex();
+					continue;
+				}
+
+				auto outgoing_responses = m_session_groups[session_group]->outgoingResponses();
+				*outgoing_responses->getNextToWriteTo() = *client_response;
+				outgoing_responses->updateWriteIndex();
+
+				m_outgoing_responses->updateReadIndex();
+				m_num_responses.inc();
 			}
 		}
 	}
@@ -70,13 +168,15 @@ namespace Exchange {
 	void OrderServer::recvCallback(Common::TCPSocket* socket, Nanos rx_time) noexcept {
 		m_logger.log("%: % %() % Received socket: % len: % rx: %\n", __FILE__,
 			__LINE__, __FUNCTION__, Common::getCurrentTimeStr(&m_time_str),
-			socket->m_fd, socket->m_next_recv_valid_index, rx_time);
+			socket->m_fd, socket->m_recv_ring.size(), rx_time);
 
-		if (socket->m_next_recv_valid_index >= sizeof(OMClientRequest)) {
+		if (socket->m_recv_ring.size() >= sizeof(OMClientRequest)) {
+			const auto recv_data = socket->m_recv_ring.data();
+			const auto recv_len = socket->m_recv_ring.size();
 			size_t i = 0;
-			for (; i + sizeof(OMClientRequest) <= socket->m_next_recv_valid_index;
+			for (; i + sizeof(OMClientRequest) <= recv_len;
 				i += sizeof(OMClientRequest)) {
-				auto request = reinterpret_cast<const OMClientRequest*> (socket->m_recv_buffer + i);
+				auto request = reinterpret_cast<const OMClientRequest*> (recv_data + i);
 				m_logger.log("% :% %() % Received %\n", __FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&m_time_str), request->toString());
 
 				auto& client_id = request->m_me_client_request.m_client_id;
@@ -104,15 +204,33 @@ namespace Exchange {
 
 				next_exp_seq_num++;
 
+				Common::trace(Common::TraceHop::OS_RECV, Common::traceOrderKey(client_id,
+					request->m_me_client_request.m_order_id));
 				m_fifo_sequencer.addClientRequest(rx_time, request->m_me_client_request);
 			}
-			memcpy(socket->m_recv_buffer, socket->m_recv_buffer + i,
-				socket->m_next_recv_valid_index - i);
-			socket->m_next_recv_valid_index -= i;
+			// The sequencer keeps pointers into the ring, the consumed bytes are not
+			// overwritten before the next recv on this socket. TCPServer reads each
+			// socket once per sendAndRecv(), before recvFinishedCallback() publishes.
+			socket->m_recv_ring.consume(i);
 		}
 	}
 
 	void OrderServer::recvFinishedCallback() noexcept {
 		m_fifo_sequencer.sequenceAndPublish();
 	}
+
+	void OrderServer::disconnectCallback(Common::TCPSocket* socket) noexcept {
+		for (size_t client_id = 0; client_id < ME_MAX_NUM_CLIENTS; ++client_id) {
+			if (m_cid_tcp_socket[client_id] != socket)
+				continue;
+
+			m_logger.log("%: % %() % ClientId: % disconnected, socket: %\n", __FILE__,
+				__LINE__, __FUNCTION__, Common::getCurrentTimeStr(&m_time_str), client_id,
+				socket->m_fd);
+			// A client connecting again starts a new session from SeqNum 1.
+			m_cid_tcp_socket[client_id] = nullptr;
+			m_cid_next_exp_seq_num[client_id] = 1;
+			m_cid_next_outgoing_seq_num[client_id] = 1;
+		}
+	}
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include <functional>
 #include <array>
+#include <vector>
 
 #include "common/thread_utils.hpp"
 #include "common/macros.hpp"
@@ -10,6 +11,7 @@
 #include "exchange/order_server/client_request.hpp"
 #include "exchange/order_server/client_response.hpp"
 #include "exchange/order_server/fifo_sequencer.hpp"
+#include "exchange/order_server/order_session_group.hpp"
 
 
 namespace Exchange {
@@ -23,6 +25,8 @@ namespace Exchange {
 
 		volatile bool m_run = false;
 
+		Common::MetricCounter m_num_responses;
+
 		std::string m_time_str;
 		Logger m_logger;
 
@@ -34,17 +38,29 @@ namespace Exchange {
 
 		FIFOSequencer m_fifo_sequencer;
 
+		std::vector<OrderSessionGroup*> m_session_groups;
+		std::vector<size_t> m_session_group_num_requests;
+		ClientSessionGroupHashMap m_cid_session_group;
+
 		void recvCallback(Common::TCPSocket* socket, Nanos rx_time) noexcept;
 		void recvFinishedCallback() noexcept;
+		void disconnectCallback(Common::TCPSocket* socket) noexcept;
+
+		void runSessionGroups() noexcept;
 
 	public:
+		/// With num_session_groups > 1 client sessions are spread over that many
+		/// OrderSessionGroup threads and this thread only sequences and routes.
 		OrderServer(ClientRequestLFQueue* client_requests,
-			ClientResponseLFQueue* client_responses, const std::string& iface, int port);
+			ClientResponseLFQueue* client_responses, const std::string& iface, int port,
+			size_t num_session_groups = 1, const std::vector<int>& session_group_cores = {});
 		~OrderServer();
 
 		void start();
 		void stop();
 
+		void registerMetrics(Common::MetricsRegistry& metrics);
+
 		void run() noexcept;
 	};
 }
\ No newline at end of file
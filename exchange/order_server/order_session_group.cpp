@@ -0,0 +1,163 @@
+#include "exchange/order_server/order_session_group.hpp"
+
+namespace Exchange {
+
+	OrderSessionGroup::OrderSessionGroup(int group_id,
+		ClientSessionGroupHashMap* cid_session_group, const std::string& iface,
+		int port, int core_id) :
+		m_group_id(group_id), m_iface(iface), m_port(port), m_core_id(core_id),
+		m_cid_session_group(cid_session_group), m_incoming_requests(ME_MAX_CLIENT_UPDATES),
+		m_outgoing_responses(ME_MAX_CLIENT_UPDATES),
+		m_logger("exchange_order_session_group_" + std::to_string(group_id) + ".log"),
+		m_tcp_server(m_logger) {
+
+		m_cid_next_outgoing_seq_num.fill(1);
+		m_cid_next_exp_seq_num.fill(1);
+		m_cid_tcp_socket.fill(nullptr);
+
+		m_tcp_server.m_recv_callback = [this](auto socket, auto rx_time) {
+			recvCallback(socket, rx_time); };
+		m_tcp_server.m_recv_finished_callback = []() {};
+		m_tcp_server.m_disconnect_callback = [this](auto socket) {
+			disconnectCallback(socket); };
+	}
+
+	OrderSessionGroup::~OrderSessionGroup() {
+		stop();
+
+		using namespace std::literals::chrono_literals;
+		std::this_thread::sleep_for(1s);
+	}
+
+	void OrderSessionGroup::start() {
+		m_run = true;
+		m_tcp_server.listen(m_iface, m_port, /*reuse_port*/ true);
+
+		ASSERT(Common::createAndStartThread(m_core_id, "Exchange/OrderSessionGroup-" +
+			std::to_string(m_group_id), [this]() { run(); }) != nullptr,
+			"Failed to start OrderSessionGroup thread.");
+	}
+
+	void OrderSessionGroup::stop() {
+		m_run = false;
+	}
+
+	void OrderSessionGroup::run() noexcept {
+		m_logger.log("%: % %() % group: %\n", __FILE__, __LINE__,
+			__FUNCTION__, Common::getCurrentTimeStr(&m_time_str), m_group_id);
+
+		while (m_run) {
+			m_tcp_server.poll();
+			m_tcp_server.sendAndRecv();
+
+			for (auto client_response = m_outgoing_responses.getNextToRead();
+				m_outgoing_responses.size() && client_response;
+				client_response = m_outgoing_responses.getNextToRead()) {
+				const auto client_id = client_response->m_client_id;
+				auto& next_outgoing_seq_num = m_cid_next_outgoing_seq_num[client_id];
+				m_logger.log("%: % %() % Sending cid: % seq: % %\n", __FILE__, __LINE__,
+					__FUNCTION__, Common::getCurrentTimeStr(&m_time_str), client_id,
+					next_outgoing_seq_num, client_response->toString());
+
+				if (m_cid_tcp_socket[client_id] == nullptr) [[unlikely]] {
+					m_logger.log("%: % %() % Dropping response for disconnected ClientId: %\n",
+						__FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&m_time_str),
+						client_id);
+					m_outgoing_responses.updateReadIndex();
+					continue;
+				}
+
+				// Numbered here, a session only lives in one group at a time.
+				const OMClientResponse om_client_response{ next_outgoing_seq_num, *client_response };
+				Common::trace(Common::TraceHop::OS_RESPONSE_SEND, Common::traceOrderKey(client_id,
+					client_response->m_client_order_id));
+				m_cid_tcp_socket[client_id]->send(&om_client_response, sizeof(OMClientResponse));
+
+				m_outgoing_responses.updateReadIndex();
+				next_outgoing_seq_num++;
+			}
+		}
+	}
+
+	void OrderSessionGroup::recvCallback(Common::TCPSocket* socket, Nanos rx_time) noexcept {
+		m_logger.log("%: % %() % Received socket: % len: % rx: %\n", __FILE__,
+			__LINE__, __FUNCTION__, Common::getCurrentTimeStr(&m_time_str),
+			socket->m_fd, socket->m_recv_ring.size(), rx_time);
+
+		if (socket->m_recv_ring.size() >= sizeof(OMClientRequest)) {
+			const auto recv_data = socket->m_recv_ring.data();
+			const auto recv_len = socket->m_recv_ring.size();
+			size_t i = 0;
+			for (; i + sizeof(OMClientRequest) <= recv_len;
+				i += sizeof(OMClientRequest)) {
+				auto request = reinterpret_cast<const OMClientRequest*>(recv_data + i);
+				m_logger.log("%: % %() % Received %\n", __FILE__, __LINE__, __FUNCTION__,
+					Common::getCurrentTimeStr(&m_time_str), request->toString());
+
+				const auto client_id = request->m_me_client_request.m_client_id;
+				if (client_id >= ME_MAX_NUM_CLIENTS) [[unlikely]] {
+					m_logger.log("%: % %() % Received invalid ClientId: % on socket: %\n",
+						__FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&m_time_str),
+						client_id, socket->m_fd);
+					continue;
+				}
+
+				if (m_cid_tcp_socket[client_id] == nullptr) [[unlikely]] {
+					auto expected_group = SessionGroup_INVALID;
+					if (!(*m_cid_session_group)[client_id].compare_exchange_strong(
+						expected_group, m_group_id) && expected_group != m_group_id) {
+						m_logger.log("%: % %() % Received ClientRequest from ClientId:"
+							" % owned by session group: % \n", __FILE__, __LINE__,
+							__FUNCTION__, Common::getCurrentTimeStr(&m_time_str), client_id,
+							expected_group);
+						continue;
+					}
+					m_cid_tcp_socket[client_id] = socket;
+				}
+
+				if (m_cid_tcp_socket[client_id] != socket) {
+					m_logger.log("%: % %() % Received ClientRequest from ClientId:"
+						" % on different socket: % expected: % \n", __FILE__, __LINE__,
+						__FUNCTION__, Common::getCurrentTimeStr(&m_time_str), client_id,
+						socket->m_fd, m_cid_tcp_socket[client_id]->m_fd);
+					continue;
+				}
+
+				auto& next_exp_seq_num = m_cid_next_exp_seq_num[client_id];
+				if (request->m_seq_num != next_exp_seq_num) {
+					m_logger.log("%: % %() % Incorrect sequence number. ClientId: %"
+						" SeqNum expected: % received: % \n", __FILE__, __LINE__,
+						__FUNCTION__, Common::getCurrentTimeStr(&m_time_str), client_id,
+						next_exp_seq_num, request->m_seq_num);
+					continue;
+				}
+
+				next_exp_seq_num++;
+
+				Common::trace(Common::TraceHop::OS_RECV, Common::traceOrderKey(client_id,
+					request->m_me_client_request.m_order_id));
+				auto next_write = m_incoming_requests.getNextToWriteTo();
+				*next_write = RecvTimeClientRequest{ rx_time, request->m_me_client_request };
+				m_incoming_requests.updateWriteIndex();
+			}
+			socket->m_recv_ring.consume(i);
+		}
+	}
+
+	void OrderSessionGroup::disconnectCallback(Common::TCPSocket* socket) noexcept {
+		for (size_t client_id = 0; client_id < ME_MAX_NUM_CLIENTS; ++client_id) {
+			if (m_cid_tcp_socket[client_id] != socket)
+				continue;
+
+			m_logger.log("%: % %() % ClientId: % disconnected, socket: %\n", __FILE__,
+				__LINE__, __FUNCTION__, Common::getCurrentTimeStr(&m_time_str), client_id,
+				socket->m_fd);
+			// A client connecting again starts a new session from SeqNum 1, in
+			// whichever group it lands.
+			m_cid_tcp_socket[client_id] = nullptr;
+			m_cid_next_outgoing_seq_num[client_id] = 1;
+			m_cid_next_exp_seq_num[client_id] = 1;
+			(*m_cid_session_group)[client_id].store(SessionGroup_INVALID);
+		}
+	}
+}
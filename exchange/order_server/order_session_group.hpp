@@ -0,0 +1,72 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+
+#include "common/thread_utils.hpp"
+#include "common/macros.hpp"
+#include "common/tcp_server.hpp"
+
+#include "exchange/order_server/client_request.hpp"
+#include "exchange/order_server/client_response.hpp"
+#include "exchange/order_server/fifo_sequencer.hpp"
+
+namespace Exchange {
+
+	constexpr int SessionGroup_INVALID = -1;
+
+	typedef std::array<std::atomic<int>, ME_MAX_NUM_CLIENTS> ClientSessionGroupHashMap;
+
+	/// One gateway thread owning a subset of the client TCP sessions.
+	/// Every group listens on the same port with SO_REUSEPORT so the kernel
+	/// spreads new connections across groups. A group parses and validates the
+	/// requests of its own sessions and hands them to the central sequencer, and
+	/// sends out the responses the central thread routes back to it. A client
+	/// belongs to the group it sent its first request to until it disconnects.
+	class OrderSessionGroup {
+
+		const int m_group_id;
+		const std::string m_iface;
+		const int m_port = 0;
+		const int m_core_id = -1;
+
+		ClientSessionGroupHashMap* m_cid_session_group = nullptr;
+
+		RecvTimeClientRequestLFQueue m_incoming_requests;
+		ClientResponseLFQueue m_outgoing_responses;
+
+		volatile bool m_run = false;
+
+		std::string m_time_str;
+		Logger m_logger;
+
+		std::array<size_t, ME_MAX_NUM_CLIENTS> m_cid_next_outgoing_seq_num;
+		std::array<size_t, ME_MAX_NUM_CLIENTS> m_cid_next_exp_seq_num;
+		std::array<Common::TCPSocket*, ME_MAX_NUM_CLIENTS> m_cid_tcp_socket;
+
+		Common::TCPServer m_tcp_server;
+
+		void run() noexcept;
+		void recvCallback(Common::TCPSocket* socket, Nanos rx_time) noexcept;
+		void disconnectCallback(Common::TCPSocket* socket) noexcept;
+
+	public:
+		OrderSessionGroup(int group_id, ClientSessionGroupHashMap* cid_session_group,
+			const std::string& iface, int port, int core_id);
+		~OrderSessionGroup();
+
+		OrderSessionGroup() = delete;
+		OrderSessionGroup(const OrderSessionGroup&) = delete;
+		OrderSessionGroup(const OrderSessionGroup&&) = delete;
+		OrderSessionGroup& operator=(const OrderSessionGroup&) = delete;
+		OrderSessionGroup& operator=(const OrderSessionGroup&&) = delete;
+
+		void start();
+		void stop();
+
+		/// Validated requests waiting for the central sequencer, consumed by the OrderServer thread.
+		auto incomingRequests() noexcept { return &m_incoming_requests; }
+		/// Responses for this group's sessions, produced by the OrderServer thread.
+		auto outgoingResponses() noexcept { return &m_outgoing_responses; }
+	};
+}
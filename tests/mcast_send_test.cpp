@@ -0,0 +1,43 @@
+#include "common/macros.hpp"
+#include "common/mcast_socket.hpp"
+#include "common/time_utils.hpp"
+
+// Publishes twice as many packets as a McastSocket has slots, one per
+// sendAndRecv() as a busy publisher does, so new packets are always queued
+// while earlier ones are in flight. With io_uring the slots are only given back
+// by SEND completions, a socket that never reclaims them fails its buffer ASSERT.
+// Kernels without io_uring run the same over sendmmsg().
+
+using namespace Common;
+
+namespace {
+	constexpr auto TestTimeout = 5 * NANOS_TO_SECS;
+}
+
+int main(int, char**) {
+	useIoUring(IoUringCfg{});
+
+	Logger logger("mcast_send_test.log");
+	McastSocket socket(logger);
+	ASSERT(socket.init("233.252.14.105", "lo", 21002, false) >= 0,
+		"Unable to create publisher.");
+
+	const auto num_packets = 2 * McastBufferSize / socket.m_max_packet_size;
+	char packet[McastDefaultPacketSize] = {};
+	for (size_t i = 0; i < num_packets; ++i) {
+		socket.closePacket();
+		socket.send(packet, sizeof(packet));
+		socket.sendAndRecv();
+	}
+
+	const auto deadline = getCurrentNanos() + TestTimeout;
+	while (socket.m_outbound_count || socket.m_send_in_flight) {
+		ASSERT(getCurrentNanos() < deadline, "Packets still queued: " +
+			std::to_string(socket.m_outbound_count) + " in flight: " +
+			std::to_string(socket.m_send_in_flight));
+		socket.sendAndRecv();
+	}
+	ASSERT(!socket.m_send_failures, std::to_string(socket.m_send_failures) +
+		" packets failed to send.");
+	return 0;
+}
@@ -0,0 +1,129 @@
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "common/macros.hpp"
+#include "common/mcast_socket.hpp"
+#include "common/time_utils.hpp"
+
+#include "trading/market_data/market_data_consumer.hpp"
+
+// Recovers a MarketDataConsumer channel from a snapshot packet that completes a
+// snapshot cycle and goes on with the next one, as the snapshot publisher's
+// packets do. Once the first cycle ends recovery, the rest of the packet must
+// be dropped, not taken for incrementals: its SNAPSHOT_END carries the SeqNum
+// the incremental stream continues with. An io_uring argument runs the sockets
+// on that backend.
+
+using namespace Common;
+using namespace Exchange;
+
+namespace {
+	constexpr TickerId TestTickerId = 0;
+	constexpr auto TestTimeout = 5 * NANOS_TO_SECS;
+
+	auto makeChannelCfg() {
+		MarketDataChannelCfg cfg;
+		cfg.m_snapshot_ip = "233.252.14.101";
+		cfg.m_snapshot_port = 21000;
+		cfg.m_incremental_ip = "233.252.14.103";
+		cfg.m_incremental_port = 21001;
+		cfg.m_tickers = { TestTickerId };
+		return cfg;
+	}
+
+	auto add(OrderId order_id) {
+		return MEMarketUpdate{ MarketUpdateType::ADD, order_id, TestTickerId, Side::BUY,
+			100, 10, static_cast<Priority>(order_id) };
+	}
+
+	/// Publishes updates as one packet.
+	auto publish(McastSocket& socket, size_t packet_seq_num,
+		const std::vector<MDPMarketUpdate>& updates) {
+		const MDPPacketHeader header{ packet_seq_num, static_cast<uint16_t>(updates.size()),
+			getCurrentNanos() };
+		socket.closePacket();
+		socket.send(&header, sizeof(header));
+		for (const auto& update : updates)
+			socket.send(&update, sizeof(update));
+		socket.sendAndRecv();
+	}
+
+	auto waitFor(Trading::RecvTimeMarketUpdateLFQueue& queue, size_t count) {
+		const auto deadline = getCurrentNanos() + TestTimeout;
+		while (queue.size() < count && getCurrentNanos() < deadline)
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		return queue.size() >= count;
+	}
+}
+
+int main(int argc, char** argv) {
+	if (argc > 1 && std::string(argv[1]) == "io_uring")
+		useIoUring(IoUringCfg{});
+
+	Logger logger("md_snapshot_batch_test.log");
+	const auto cfg = makeChannelCfg();
+
+	Trading::RecvTimeMarketUpdateLFQueue queue(ME_MAX_MARKET_UPDATES);
+	Trading::MarketDataConsumer consumer(1, &queue, "lo", { cfg }, { TestTickerId });
+	consumer.start();
+
+	McastSocket incremental(logger);
+	McastSocket snapshot(logger);
+	ASSERT(incremental.init(cfg.m_incremental_ip, "lo", cfg.m_incremental_port, false) >= 0,
+		"Unable to create incremental publisher.");
+	ASSERT(snapshot.init(cfg.m_snapshot_ip, "lo", cfg.m_snapshot_port, false) >= 0,
+		"Unable to create snapshot publisher.");
+
+	// SeqNum 2 goes missing, without a RetransmissionServer the consumer joins
+	// the snapshot group.
+	publish(incremental, 1, { { 1, add(1) } });
+	ASSERT(waitFor(queue, 1), "Incremental SeqNum 1 not received.");
+	publish(incremental, 2, { { 3, add(3) } });
+
+	// Snapshot up to SeqNum 2, then the next cycle up to SeqNum 4, which lines
+	// its SNAPSHOT_END up with the next expected incremental.
+	const std::vector<MDPMarketUpdate> snapshot_updates = {
+		{ 0, { MarketUpdateType::SNAPSHOT_START, 2 } },
+		{ 1, { MarketUpdateType::CLEAR, OrderId_INVALID, TestTickerId } },
+		{ 2, add(1) },
+		{ 3, add(2) },
+		{ 4, { MarketUpdateType::SNAPSHOT_END, 2 } },
+		{ 0, { MarketUpdateType::SNAPSHOT_START, 4 } },
+		{ 1, { MarketUpdateType::CLEAR, OrderId_INVALID, TestTickerId } },
+		{ 2, add(1) },
+		{ 3, add(2) },
+		{ 4, { MarketUpdateType::SNAPSHOT_END, 4 } },
+	};
+	// The consumer joins in its own time, the snapshot is repeated until it has
+	// recovered and left the group again.
+	const auto deadline = getCurrentNanos() + TestTimeout;
+	for (size_t packet_seq_num = 1; queue.size() < 5; ++packet_seq_num) {
+		ASSERT(getCurrentNanos() < deadline, "Channel did not recover from the snapshot.");
+		publish(snapshot, packet_seq_num, snapshot_updates);
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+
+	publish(incremental, 3, { { 4, add(4) } });
+	ASSERT(waitFor(queue, 6), "Incremental SeqNum 4 not received after recovery.");
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+	const std::vector<MEMarketUpdate> expected = {
+		add(1),
+		{ MarketUpdateType::CLEAR, OrderId_INVALID, TestTickerId },
+		add(1),
+		add(2),
+		add(3),
+		add(4),
+	};
+	ASSERT(queue.size() == expected.size(), "Expected " + std::to_string(expected.size()) +
+		" updates, got " + std::to_string(queue.size()));
+	for (const auto& expected_update : expected) {
+		const auto& update = queue.getNextToRead()->m_market_update;
+		ASSERT(update.m_type == expected_update.m_type &&
+			update.m_order_id == expected_update.m_order_id,
+			"Expected " + expected_update.toString() + " got " + update.toString());
+		queue.updateReadIndex();
+	}
+	return 0;
+}
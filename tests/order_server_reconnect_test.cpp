@@ -0,0 +1,130 @@
+#include <chrono>
+#include <optional>
+#include <thread>
+
+#include "common/macros.hpp"
+#include "common/tcp_socket.hpp"
+#include "common/time_utils.hpp"
+
+#include "exchange/order_server/order_server.hpp"
+
+// Connects a client to an OrderServer, sends a request and reads the response
+// to it, disconnects and does the same again over a new connection. The second
+// session starts from SeqNum 1 both ways, as a restarted OrderGateway does.
+// Then the same with two OrderSessionGroups, the client's second session going
+// to the other group, which may only take it once the first let go of it. An
+// io_uring argument runs the sockets on that backend.
+
+using namespace Common;
+using namespace Exchange;
+
+namespace {
+	constexpr int TestPort = 21020;
+	constexpr ClientId TestClientId = 3;
+	constexpr auto TestTimeout = 5 * NANOS_TO_SECS;
+
+	/// Runs one session of TestClientId with the server on port. receive()
+	/// returns the next request the server took in, respond() hands it a response.
+	template<typename Receive, typename Respond>
+	auto runSession(Logger& logger, int port, OrderId order_id, Receive&& receive,
+		Respond&& respond) {
+		TCPSocket client(logger);
+		ASSERT(client.connect("127.0.0.1", "lo", port, false) >= 0,
+			"Unable to connect to port " + std::to_string(port));
+
+		const OMClientRequest request{ 1, { ClientRequestType::NEW, TestClientId, 0,
+			order_id, Side::BUY, 100, 10 } };
+		client.send(&request, sizeof(request));
+
+		const auto deadline = getCurrentNanos() + TestTimeout;
+		std::optional<MEClientRequest> received;
+		while (!(received = receive())) {
+			ASSERT(getCurrentNanos() < deadline, "Request of order " +
+				std::to_string(order_id) + " not received on port " + std::to_string(port));
+			client.sendAndRecv();
+		}
+		ASSERT(received->m_client_id == TestClientId && received->m_order_id == order_id,
+			"Unexpected request " + received->toString());
+
+		respond(MEClientResponse{ ClientResponseType::ACCEPTED, TestClientId, 0, order_id,
+			order_id, Side::BUY, 100, 0, 10 });
+		while (client.m_recv_ring.size() < sizeof(OMClientResponse)) {
+			ASSERT(getCurrentNanos() < deadline, "Response to order " +
+				std::to_string(order_id) + " not received on port " + std::to_string(port));
+			client.sendAndRecv();
+		}
+		const auto response = reinterpret_cast<const OMClientResponse*>(
+			client.m_recv_ring.data());
+		ASSERT(response->m_seq_num == 1 &&
+			response->m_me_client_response.m_client_order_id == order_id,
+			"Unexpected response " + response->toString());
+
+		client.destroy();
+		// The server drops the session before the client comes back.
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	}
+
+	auto testOrderServer(Logger& logger) {
+		ClientRequestLFQueue requests(ME_MAX_CLIENT_UPDATES);
+		ClientResponseLFQueue responses(ME_MAX_CLIENT_UPDATES);
+		OrderServer order_server(&requests, &responses, "lo", TestPort);
+		order_server.start();
+
+		auto receive = [&requests]() -> std::optional<MEClientRequest> {
+			if (!requests.size())
+				return std::nullopt;
+			const auto request = *requests.getNextToRead();
+			requests.updateReadIndex();
+			return request;
+		};
+		auto respond = [&responses](const MEClientResponse& response) {
+			*responses.getNextToWriteTo() = response;
+			responses.updateWriteIndex();
+		};
+		runSession(logger, TestPort, 1, receive, respond);
+		runSession(logger, TestPort, 2, receive, respond);
+	}
+
+	auto testSessionGroups(Logger& logger) {
+		ClientSessionGroupHashMap cid_session_group;
+		for (auto& session_group : cid_session_group)
+			session_group = SessionGroup_INVALID;
+
+		// Own ports pick the group a connection goes to, SO_REUSEPORT would hash it.
+		OrderSessionGroup group_0(0, &cid_session_group, "lo", TestPort + 1, -1);
+		OrderSessionGroup group_1(1, &cid_session_group, "lo", TestPort + 2, -1);
+		group_0.start();
+		group_1.start();
+
+		auto receive = [](OrderSessionGroup& group) {
+			return [&group]() -> std::optional<MEClientRequest> {
+				auto requests = group.incomingRequests();
+				if (!requests->size())
+					return std::nullopt;
+				const auto request = requests->getNextToRead()->m_request;
+				requests->updateReadIndex();
+				return request;
+			};
+		};
+		auto respond = [](OrderSessionGroup& group) {
+			return [&group](const MEClientResponse& response) {
+				*group.outgoingResponses()->getNextToWriteTo() = response;
+				group.outgoingResponses()->updateWriteIndex();
+			};
+		};
+		runSession(logger, TestPort + 1, 1, receive(group_0), respond(group_0));
+		ASSERT(cid_session_group[TestClientId] == SessionGroup_INVALID,
+			"Session group 0 kept ClientId " + std::to_string(TestClientId));
+		runSession(logger, TestPort + 2, 2, receive(group_1), respond(group_1));
+	}
+}
+
+int main(int argc, char** argv) {
+	if (argc > 1 && std::string(argv[1]) == "io_uring")
+		useIoUring(IoUringCfg{});
+
+	Logger logger("order_server_reconnect_test.log");
+	testOrderServer(logger);
+	testSessionGroups(logger);
+	return 0;
+}
@@ -0,0 +1,73 @@
+#include <cstring>
+
+#include "common/macros.hpp"
+#include "common/tcp_server.hpp"
+#include "common/time_utils.hpp"
+
+// Streams a counter through a TCPSocket to a TCPServer until the receive ring
+// of the accepted socket wrapped around a few times, consuming a little less
+// than was received on each callback so messages straddle the wrap. Every word
+// must arrive once and in order. An io_uring argument runs the sockets on that
+// backend, where the kernel writes straight into the ring.
+
+using namespace Common;
+
+namespace {
+	constexpr int TestPort = 21010;
+	constexpr size_t NumWords = 3 * TCPBufferSize / sizeof(uint64_t);
+	constexpr size_t ChunkWords = 8 * 1024 - 1;
+	constexpr auto TestTimeout = 20 * NANOS_TO_SECS;
+}
+
+int main(int argc, char** argv) {
+	if (argc > 1 && std::string(argv[1]) == "io_uring")
+		useIoUring(IoUringCfg{});
+
+	Logger logger("tcp_recv_test.log");
+	TCPServer server(logger);
+	size_t next_word = 0;
+	server.m_recv_callback = [&next_word](TCPSocket* socket, Nanos) {
+		// Leaves a partial word and one whole word behind for the next callback.
+		const auto num_words = socket->m_recv_ring.size() / sizeof(uint64_t);
+		const auto num_consumed = num_words > 1 ? num_words - 1 : 0;
+		const auto words = reinterpret_cast<const uint64_t*>(socket->m_recv_ring.data());
+		for (size_t i = 0; i < num_consumed; ++i, ++next_word)
+			ASSERT(words[i] == next_word, "Expected word " + std::to_string(next_word) +
+				" got " + std::to_string(words[i]));
+		socket->m_recv_ring.consume(num_consumed * sizeof(uint64_t));
+	};
+	server.listen("lo", TestPort);
+
+	TCPSocket client(logger);
+	ASSERT(client.connect("127.0.0.1", "lo", TestPort, false) >= 0,
+		"Unable to connect to the server.");
+
+	const auto deadline = getCurrentNanos() + TestTimeout;
+	auto poll = [&]() {
+		ASSERT(getCurrentNanos() < deadline, "Received " + std::to_string(next_word) +
+			" of " + std::to_string(NumWords) + " words.");
+		client.sendAndRecv();
+		server.poll();
+		server.sendAndRecv();
+		ASSERT(!client.m_send_disconnected && !client.m_recv_disconnected &&
+			server.m_disconnected_sockets.empty(), "Connection lost.");
+	};
+	while (server.m_sockets.empty())
+		poll();
+
+	uint64_t chunk[ChunkWords];
+	size_t word = 0;
+	while (word < NumWords) {
+		if (client.m_send_ring.freeSpace() >= sizeof(chunk)) {
+			for (size_t i = 0; i < ChunkWords; ++i)
+				chunk[i] = word++;
+			client.send(chunk, sizeof(chunk));
+		}
+		poll();
+	}
+	// The callback always leaves the last word received behind.
+	while (next_word + 1 < word)
+		poll();
+
+	return 0;
+}
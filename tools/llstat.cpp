@@ -0,0 +1,76 @@
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "common/metrics.hpp"
+
+/// Shows the metrics a process publishes with Common::MetricsRegistry, refreshed
+/// every interval. Only maps the page read only, the process is not disturbed.
+///
+/// Usage: llstat <name, e.g. ll_exchange> [interval ms, default 1000] [refreshes, 0 = forever]
+
+using namespace Common;
+
+int main(int argc, char** argv) {
+	if (argc < 2) {
+		fprintf(stderr, "Usage: %s <name> [interval_ms] [refreshes]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+	const std::string name = argv[1];
+	const auto interval_ms = argc > 2 ? std::stol(argv[2]) : 1000;
+	const auto refreshes = argc > 3 ? std::stoul(argv[3]) : 0;
+
+	MetricsReader reader(name);
+	if (!reader.valid()) {
+		fprintf(stderr, "No metrics page /dev/shm/%s\n", name.c_str());
+		return EXIT_FAILURE;
+	}
+
+	std::vector<MetricValue> last_metrics;
+	Nanos last_sample_time = 0;
+	for (size_t refresh = 1; !refreshes || refresh <= refreshes; ++refresh) {
+		const auto sample_time = reader.sampleTime();
+		const auto metrics = reader.read();
+		const auto elapsed = sample_time - last_sample_time;
+
+		// Refresh in place when writing to a terminal.
+		if (isatty(fileno(stdout)))
+			printf("\033[H\033[2J");
+		printf("%s pid:%lu sample_time:%ld\n", name.c_str(), reader.pid(), sample_time);
+		printf("%-40s %12s %12s\n", "COUNTER / GAUGE", "value", "per sec");
+		for (size_t i = 0; i < metrics.size(); ++i) {
+			const auto& metric = metrics[i];
+			if (metric.m_type == MetricType::COUNTER) {
+				const auto last = i < last_metrics.size() ? last_metrics[i].m_values[0] : 0;
+				const auto rate = last_sample_time && elapsed > 0 ?
+					static_cast<double>(metric.m_values[0] - last) * NANOS_TO_SECS / elapsed : 0.0;
+				printf("%-40s %12lu %12.0f\n", metric.m_name.c_str(), metric.m_values[0], rate);
+			}
+			else if (metric.m_type == MetricType::GAUGE) {
+				printf("%-40s %12lu\n", metric.m_name.c_str(), metric.m_values[0]);
+			}
+		}
+
+		printf("\n%-40s %10s %8s %8s %8s %8s %8s %8s %8s\n", "HISTOGRAM (ns)", "count",
+			"min", "mean", "p50", "p90", "p99", "p99.9", "max");
+		for (const auto& metric : metrics) {
+			if (metric.m_type != MetricType::HISTOGRAM)
+				continue;
+			const auto& values = metric.m_values;
+			printf("%-40s %10lu %8lu %8lu %8lu %8lu %8lu %8lu %8lu\n", metric.m_name.c_str(),
+				values[METRIC_COUNT], values[METRIC_MIN], values[METRIC_MEAN],
+				values[METRIC_P50], values[METRIC_P90], values[METRIC_P99],
+				values[METRIC_P999], values[METRIC_MAX]);
+		}
+		fflush(stdout);
+
+		last_metrics = metrics;
+		last_sample_time = sample_time;
+		if (!refreshes || refresh < refreshes)
+			std::this_thread::sleep_for(std::chrono::milliseconds(interval_ms));
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,136 @@
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+#include "common/latency_histogram.hpp"
+#include "common/trace.hpp"
+
+/// Reads the files written by Common::traceDump(), from the trading and the
+/// exchange processes of one run, and prints a latency histogram per hop.
+///
+/// Usage: trace_report <trace file>...
+
+using namespace Common;
+
+namespace {
+	/// First stamp of every (hop, key), later ones are retransmits or repeats.
+	std::array<std::unordered_map<uint64_t, uint64_t>, size_t(TraceHop::MAX)> first_tsc;
+	/// OM_NEW_ORDER's order key -> market data key of the update that caused it.
+	std::unordered_map<uint64_t, uint64_t> order_cause;
+
+	auto loadFile(const char* path, double& tsc_per_nano) {
+		auto file = fopen(path, "rb");
+		if (!file) {
+			fprintf(stderr, "Cannot open %s: %s\n", path, strerror(errno));
+			return false;
+		}
+
+		TraceFileHeader header;
+		if (fread(&header, sizeof(header), 1, file) != 1 ||
+			memcmp(header.m_magic, TraceFileHeader().m_magic, sizeof(header.m_magic))) {
+			fprintf(stderr, "%s is not a trace file.\n", path);
+			fclose(file);
+			return false;
+		}
+		if (!tsc_per_nano)
+			tsc_per_nano = header.m_tsc_per_nano;
+
+		std::vector<TraceRecord> records(header.m_num_records);
+		records.resize(fread(records.data(), sizeof(TraceRecord), records.size(), file));
+		fclose(file);
+
+		for (const auto& record : records) {
+			if (record.m_hop == TraceHop::INVALID || record.m_hop >= TraceHop::MAX)
+				continue;
+			auto& stamps = first_tsc[size_t(record.m_hop)];
+			auto [it, inserted] = stamps.try_emplace(record.m_key, record.m_tsc);
+			if (!inserted)
+				it->second = std::min(it->second, record.m_tsc);
+			if (record.m_hop == TraceHop::OM_NEW_ORDER)
+				order_cause.try_emplace(record.m_key, record.m_link);
+		}
+		return true;
+	}
+
+	auto stamp(TraceHop hop, uint64_t key, uint64_t& tsc) {
+		const auto& stamps = first_tsc[size_t(hop)];
+		const auto it = stamps.find(key);
+		if (it == stamps.end())
+			return false;
+		tsc = it->second;
+		return true;
+	}
+
+	auto elapsed(uint64_t from, uint64_t to, double tsc_per_nano) -> uint64_t {
+		return to > from ? static_cast<uint64_t>((to - from) / tsc_per_nano) : 0;
+	}
+
+	/// from -> to for keys stamped at both hops.
+	auto sameKey(TraceHop from, TraceHop to, double tsc_per_nano) {
+		LatencyHistogram histogram;
+		for (const auto& [key, from_tsc] : first_tsc[size_t(from)]) {
+			uint64_t to_tsc;
+			if (stamp(to, key, to_tsc))
+				histogram.record(elapsed(from_tsc, to_tsc, tsc_per_nano));
+		}
+		return histogram;
+	}
+
+	/// from, stamped with the market data key, -> to, stamped with the order key.
+	auto mdToOrder(TraceHop from, TraceHop to, double tsc_per_nano) {
+		LatencyHistogram histogram;
+		for (const auto& [order_key, md_key] : order_cause) {
+			uint64_t from_tsc, to_tsc;
+			if (stamp(from, md_key, from_tsc) && stamp(to, order_key, to_tsc))
+				histogram.record(elapsed(from_tsc, to_tsc, tsc_per_nano));
+		}
+		return histogram;
+	}
+}
+
+int main(int argc, char** argv) {
+	if (argc < 2) {
+		fprintf(stderr, "Usage: %s <trace file>...\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	double tsc_per_nano = 0;
+	for (int i = 1; i < argc; ++i) {
+		if (!loadFile(argv[i], tsc_per_nano))
+			return EXIT_FAILURE;
+	}
+	if (!tsc_per_nano) {
+		fprintf(stderr, "Trace files are missing the TSC frequency.\n");
+		return EXIT_FAILURE;
+	}
+
+	const auto report = [](TraceHop from, TraceHop to, const LatencyHistogram& histogram) {
+		printf("%s->%s %s\n", traceHopToString(from).c_str(), traceHopToString(to).c_str(),
+			histogram.toString().c_str());
+	};
+
+	constexpr TraceHop md_hops[] = { TraceHop::MCAST_RECV, TraceHop::MD_DECODE,
+		TraceHop::TE_DEQUEUE, TraceHop::BOOK_UPDATE, TraceHop::STRATEGY_DECISION };
+	for (size_t i = 1; i < std::size(md_hops); ++i)
+		report(md_hops[i - 1], md_hops[i], sameKey(md_hops[i - 1], md_hops[i], tsc_per_nano));
+
+	report(TraceHop::STRATEGY_DECISION, TraceHop::OM_NEW_ORDER,
+		mdToOrder(TraceHop::STRATEGY_DECISION, TraceHop::OM_NEW_ORDER, tsc_per_nano));
+
+	constexpr TraceHop order_hops[] = { TraceHop::OM_NEW_ORDER, TraceHop::OGW_SEND,
+		TraceHop::OS_RECV, TraceHop::SEQUENCER_PUBLISH, TraceHop::ME_PROCESS,
+		TraceHop::OS_RESPONSE_SEND };
+	for (size_t i = 1; i < std::size(order_hops); ++i)
+		report(order_hops[i - 1], order_hops[i],
+			sameKey(order_hops[i - 1], order_hops[i], tsc_per_nano));
+
+	// Totals: tick to trade on the trading side and the exchange round trip.
+	report(TraceHop::MCAST_RECV, TraceHop::OGW_SEND,
+		mdToOrder(TraceHop::MCAST_RECV, TraceHop::OGW_SEND, tsc_per_nano));
+	report(TraceHop::OGW_SEND, TraceHop::OS_RESPONSE_SEND,
+		sameKey(TraceHop::OGW_SEND, TraceHop::OS_RESPONSE_SEND, tsc_per_nano));
+
+	return EXIT_SUCCESS;
+}
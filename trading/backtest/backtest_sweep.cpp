@@ -0,0 +1,220 @@
+#include "trading/backtest/backtest_sweep.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <thread>
+
+#include <unistd.h>
+
+namespace Trading {
+
+	namespace {
+		/// Bytes the kernel can hand out without swapping, page cache included.
+		size_t availableMemory() noexcept {
+			std::ifstream meminfo("/proc/meminfo");
+			std::string key;
+			size_t kb = 0;
+			while (meminfo >> key >> kb) {
+				if (key == "MemAvailable:")
+					return kb * 1024;
+				meminfo.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+			}
+			const auto pages = sysconf(_SC_AVPHYS_PAGES);
+			const auto page_size = sysconf(_SC_PAGESIZE);
+			return (pages > 0 && page_size > 0) ?
+				static_cast<size_t>(pages) * static_cast<size_t>(page_size) : 0;
+		}
+	}
+
+	size_t sweepDefaultWorkers() noexcept {
+		const size_t cores = std::max(1u, std::thread::hardware_concurrency());
+		return std::clamp<size_t>(availableMemory() / SweepWorkerMemory, 1, cores);
+	}
+
+	std::string SweepPoint::toString() const {
+		std::stringstream ss;
+		ss << "SweepPoint[" <<
+			"algo:" << algoTypeToString(m_algo_type) <<
+			" " << m_ticker_cfg.toString() <<
+			"]";
+		return ss.str();
+	}
+
+	std::vector<SweepPoint> SweepCfg::points() const {
+		std::vector<SweepPoint> points;
+		for (const auto algo_type : m_algo_types)
+			for (const auto clip : m_clips)
+				for (const auto threshold : m_thresholds)
+					for (const auto max_order_size : m_max_order_sizes)
+						for (const auto max_position : m_max_positions)
+							for (const auto max_loss : m_max_losses)
+								points.push_back({ algo_type, { clip, threshold,
+									{ max_order_size, max_position, max_loss } } });
+		return points;
+	}
+
+	BacktestSweep::BacktestSweep(const SweepCfg& cfg, const std::vector<std::string>& md_files) :
+		m_cfg(cfg), m_points(cfg.points()), m_backtesters(cfg.m_num_workers, nullptr),
+		m_worker_run(cfg.m_num_workers),
+		m_worker_stolen(cfg.m_num_workers) {
+		ASSERT(!m_points.empty(), "Empty sweep grid.");
+		ASSERT(m_cfg.m_num_tickers && m_cfg.m_num_tickers <= ME_MAX_TICKERS,
+			"Invalid number of swept tickers " + std::to_string(m_cfg.m_num_tickers));
+
+		for (const auto& md_file : md_files) {
+			const auto market_updates = new CaptureReader(md_file);
+			ASSERT(market_updates->header().m_stream == CaptureStream::MARKET_UPDATES,
+				"Sweep needs MARKET_UPDATES captures, not " + md_file);
+			m_days[market_updates->header().m_day].push_back(market_updates);
+		}
+		for (auto& [day, market_updates] : m_days) {
+			std::stable_sort(market_updates.begin(), market_updates.end(),
+				[](const auto lhs, const auto rhs) {
+					return captureFirstRecvTime(*lhs) < captureFirstRecvTime(*rhs);
+				});
+		}
+		for (const auto& md_file : md_files) {
+			const CaptureReader market_updates(md_file);
+			const auto day = market_updates.header().m_day;
+			if (m_own_orders.count(day))
+				continue;
+			const auto own_orders = new RecordedOwnOrders();
+			if (!own_orders->addDay(captureDir(md_file), day))
+				m_days_without_own_orders.push_back(day);
+			m_own_orders[day] = own_orders;
+		}
+	}
+
+	BacktestSweep::~BacktestSweep() {
+		for (auto& [day, market_updates] : m_days) {
+			for (auto capture : market_updates)
+				delete capture;
+		}
+		m_days.clear();
+		for (auto& backtester : m_backtesters) {
+			delete backtester;
+			backtester = nullptr;
+		}
+		for (auto& [day, own_orders] : m_own_orders)
+			delete own_orders;
+		m_own_orders.clear();
+	}
+
+	void BacktestSweep::runTask(size_t point, uint32_t day, size_t worker,
+		SweepResult* result) {
+		const auto start_time = Common::getCurrentNanos();
+
+		auto backtest_cfg = m_cfg.m_backtest;
+		backtest_cfg.m_algo_type = m_points[point].m_algo_type;
+		backtest_cfg.m_ticker_cfg = {};
+		for (size_t ticker_id = 0; ticker_id < m_cfg.m_num_tickers; ++ticker_id)
+			backtest_cfg.m_ticker_cfg[ticker_id] = m_points[point].m_ticker_cfg;
+
+		auto& backtester = m_backtesters[worker];
+		if (backtester)
+			backtester->reset(backtest_cfg);
+		else
+			backtester = new Backtester(backtest_cfg);
+		for (const auto market_updates : m_days.at(day))
+			backtester->run(*market_updates, m_own_orders.at(day));
+
+		*result = { point, day, backtester->pnl(), backtester->minPnl(),
+			backtester->maxDrawdown(), backtester->maxPosition(), backtester->volume(),
+			backtester->numFills(), backtester->numRequests(), backtester->numReplayed(),
+			backtester->numOwnSkipped(), 0, worker };
+		result->m_wall_time = Common::getCurrentNanos() - start_time;
+	}
+
+	void BacktestSweep::run() {
+		const auto start_time = Common::getCurrentNanos();
+
+		m_results.assign(m_points.size() * m_days.size(), {});
+		Common::WorkStealingPool pool(m_cfg.m_num_workers, m_cfg.m_first_core);
+		size_t task = 0;
+		for (size_t point = 0; point < m_points.size(); ++point) {
+			for (const auto& [day, market_updates] : m_days) {
+				const auto result = &m_results[task++];
+				pool.submit([this, point, day = day, result](size_t worker) {
+					runTask(point, day, worker, result);
+				});
+			}
+		}
+		pool.run();
+
+		for (size_t worker = 0; worker < pool.numWorkers(); ++worker) {
+			m_worker_run[worker] = pool.numRun(worker);
+			m_worker_stolen[worker] = pool.numStolen(worker);
+		}
+		m_wall_time = Common::getCurrentNanos() - start_time;
+	}
+
+	std::string BacktestSweep::report() const {
+		std::stringstream ss;
+		ss << m_cfg.m_backtest.toString() << " tickers:" << m_cfg.m_num_tickers << "\n";
+
+		Nanos task_time = 0;
+		for (const auto& result : m_results) {
+			ss << "point:" << result.m_point <<
+				" day:" << result.m_day <<
+				" pnl:" << result.m_pnl <<
+				" min_pnl:" << result.m_min_pnl <<
+				" max_drawdown:" << result.m_max_drawdown <<
+				" max_position:" << result.m_max_position <<
+				" volume:" << result.m_volume <<
+				" fills:" << result.m_fills <<
+				" requests:" << result.m_requests <<
+				" replayed:" << result.m_replayed <<
+				" own_skipped:" << result.m_own_skipped <<
+				" wall_ns:" << result.m_wall_time <<
+				" worker:" << result.m_worker << "\n";
+			task_time += result.m_wall_time;
+		}
+
+		struct Summary {
+			size_t m_point = 0;
+			double m_pnl = 0;
+			double m_worst_day_pnl = std::numeric_limits<double>::max();
+			double m_max_drawdown = 0;
+			int32_t m_max_position = 0;
+			Qty m_volume = 0;
+			size_t m_fills = 0;
+		};
+		std::vector<Summary> summaries(m_points.size());
+		for (size_t point = 0; point < m_points.size(); ++point)
+			summaries[point].m_point = point;
+		for (const auto& result : m_results) {
+			auto& summary = summaries[result.m_point];
+			summary.m_pnl += result.m_pnl;
+			summary.m_worst_day_pnl = std::min(summary.m_worst_day_pnl, result.m_pnl);
+			summary.m_max_drawdown = std::max(summary.m_max_drawdown, result.m_max_drawdown);
+			summary.m_max_position = std::max(summary.m_max_position, result.m_max_position);
+			summary.m_volume += result.m_volume;
+			summary.m_fills += result.m_fills;
+		}
+		std::stable_sort(summaries.begin(), summaries.end(),
+			[](const auto& lhs, const auto& rhs) { return lhs.m_pnl > rhs.m_pnl; });
+		for (const auto& summary : summaries) {
+			ss << "point:" << summary.m_point <<
+				" days:" << m_days.size() <<
+				" pnl:" << summary.m_pnl <<
+				" worst_day_pnl:" << summary.m_worst_day_pnl <<
+				" max_drawdown:" << summary.m_max_drawdown <<
+				" max_position:" << summary.m_max_position <<
+				" volume:" << summary.m_volume <<
+				" fills:" << summary.m_fills <<
+				" " << m_points[summary.m_point].toString() << "\n";
+		}
+
+		ss << "tasks:" << m_results.size() <<
+			" workers:" << m_worker_run.size() <<
+			" wall_ns:" << m_wall_time <<
+			" task_ns:" << task_time <<
+			" parallelism:" << (m_wall_time ? static_cast<double>(task_time) / m_wall_time : 0);
+		for (size_t worker = 0; worker < m_worker_run.size(); ++worker) {
+			ss << "\nworker:" << worker <<
+				" run:" << m_worker_run[worker] <<
+				" stolen:" << m_worker_stolen[worker];
+		}
+		return ss.str();
+	}
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <map>
+#include <vector>
+
+#include "common/macros.hpp"
+#include "common/work_stealing_pool.hpp"
+
+#include "trading/backtest/backtester.hpp"
+
+namespace Trading {
+
+	/// One point of a sweep's grid, applied to every swept ticker.
+	struct SweepPoint {
+		AlgoType m_algo_type = AlgoType::MAKER;
+		TradeEngineCfg m_ticker_cfg;
+
+		std::string toString() const;
+	};
+
+	/// Memory a worker's Backtester takes, its MatchingEngine and TradeEngine
+	/// pools at most.
+	constexpr size_t SweepWorkerMemory = size_t(2) << 30;
+
+	/// Workers for a machine: a core each, as many as the available memory holds
+	/// Backtesters of SweepWorkerMemory.
+	size_t sweepDefaultWorkers() noexcept;
+
+	struct SweepCfg {
+		/// Client id and latencies of every backtest, the algo and ticker config
+		/// come from the grid.
+		BacktestCfg m_backtest;
+		/// Tickers 0 to m_num_tickers - 1 get the point's TradeEngineCfg, the
+		/// others none.
+		size_t m_num_tickers = 1;
+
+		/// Values of each parameter, the grid is every combination of them.
+		std::vector<AlgoType> m_algo_types;
+		std::vector<Qty> m_clips;
+		std::vector<double> m_thresholds;
+		std::vector<Qty> m_max_order_sizes;
+		std::vector<Qty> m_max_positions;
+		std::vector<double> m_max_losses;
+
+		size_t m_num_workers = 1;
+		/// Workers are pinned to m_first_core onwards, -1 leaves them unpinned.
+		int m_first_core = -1;
+
+		std::vector<SweepPoint> points() const;
+	};
+
+	/// Outcome of the backtest of one point on one day.
+	struct SweepResult {
+		size_t m_point = 0;
+		uint32_t m_day = 0;
+		double m_pnl = 0;
+		double m_min_pnl = 0;
+		double m_max_drawdown = 0;
+		int32_t m_max_position = 0;
+		Qty m_volume = 0;
+		size_t m_fills = 0;
+		size_t m_requests = 0;
+		size_t m_replayed = 0;
+		size_t m_own_skipped = 0;
+		Nanos m_wall_time = 0;
+		size_t m_worker = 0;
+	};
+
+	/// Backtests every point of a SweepCfg grid on every day of captured market
+	/// data, one backtest per point and day, on a WorkStealingPool.
+	///
+	/// Capture files are mapped once and only read, shared by all workers. Each
+	/// worker builds a Backtester on its first task and resets it for the next,
+	/// so the workers share nothing they write but their own slot of the results;
+	/// a Backtester is up to SweepWorkerMemory of pools though, which caps the
+	/// workers a machine can take. Days are made of the captures' header days,
+	/// their parts ordered by their first receive time. The recording client's
+	/// orders are kept out of each day's replay, see RecordedOwnOrders. Loggers
+	/// should be off, see Logger::setEnabled(), every Backtester would write the
+	/// same files.
+	class BacktestSweep final {
+		const SweepCfg m_cfg;
+		const std::vector<SweepPoint> m_points;
+
+		std::map<uint32_t, std::vector<const CaptureReader*>> m_days;
+		/// Recording client's orders of each day, from the CLIENT_RESPONSES
+		/// captures next to its first MARKET_UPDATES one.
+		std::map<uint32_t, const RecordedOwnOrders*> m_own_orders;
+		std::vector<uint32_t> m_days_without_own_orders;
+
+		/// Of each worker, built by it.
+		std::vector<Backtester*> m_backtesters;
+
+		std::vector<SweepResult> m_results;
+		std::vector<size_t> m_worker_run;
+		std::vector<size_t> m_worker_stolen;
+		Nanos m_wall_time = 0;
+
+		void runTask(size_t point, uint32_t day, size_t worker, SweepResult* result);
+
+	public:
+		BacktestSweep(const SweepCfg& cfg, const std::vector<std::string>& md_files);
+		~BacktestSweep();
+
+		BacktestSweep() = delete;
+		BacktestSweep(const BacktestSweep&) = delete;
+		BacktestSweep(const BacktestSweep&&) = delete;
+		BacktestSweep& operator=(const BacktestSweep&) = delete;
+		BacktestSweep& operator=(const BacktestSweep&&) = delete;
+
+		void run();
+
+		/// By point and day.
+		const auto& results() const noexcept { return m_results; }
+
+		/// Days without CLIENT_RESPONSES captures, whose recording client's orders
+		/// are replayed as the market's.
+		const auto& daysWithoutOwnOrders() const noexcept { return m_days_without_own_orders; }
+
+		/// Each backtest, then each point over all days best total PnL first, then
+		/// how the work spread over the workers.
+		std::string report() const;
+	};
+}
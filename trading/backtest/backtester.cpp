@@ -0,0 +1,426 @@
+#include "trading/backtest/backtester.hpp"
+
+#include <algorithm>
+
+namespace Trading {
+
+	namespace {
+		/// Capacity of the queues the engines are built with but the Backtester
+		/// never fills, it calls them directly instead.
+		constexpr size_t BacktestUnusedQueueSize = 16;
+	}
+
+	std::string BacktestCfg::toString() const {
+		std::stringstream ss;
+		ss << "BacktestCfg[" <<
+			"client:" << m_client_id <<
+			" algo:" << algoTypeToString(m_algo_type);
+		for (const auto& strategy : m_strategies)
+			ss << " " << strategy.toString();
+		ss <<
+			" order_latency:" << m_order_latency <<
+			" response_latency:" << m_response_latency <<
+			" md_latency:" << m_md_latency <<
+			"]";
+		return ss.str();
+	}
+
+	Backtester::Backtester(const BacktestCfg& cfg) : m_cfg(cfg),
+		m_te_requests(ME_MAX_CLIENT_UPDATES), m_te_responses(BacktestUnusedQueueSize),
+		m_te_md_updates(BacktestUnusedQueueSize), m_me_requests(BacktestUnusedQueueSize),
+		m_me_responses(ME_MAX_CLIENT_UPDATES), m_me_md_updates(ME_MAX_MARKET_UPDATES),
+		m_replay_order_keys(ME_MAX_ORDER_IDS, ReplayKeyFree) {
+		ASSERT(m_cfg.m_client_id < BacktestReplayClientId,
+			"Invalid backtest client id " + std::to_string(m_cfg.m_client_id));
+
+		m_free_replay_order_ids.reserve(ME_MAX_ORDER_IDS);
+		for (auto order_id = ME_MAX_ORDER_IDS; order_id > 0; --order_id)
+			m_free_replay_order_ids.push_back(order_id - 1);
+
+		m_matching_engine = new Exchange::MatchingEngine(&m_me_requests, &m_me_responses,
+			&m_me_md_updates);
+		buildTradeEngine();
+	}
+
+	void Backtester::buildTradeEngine() {
+		if (m_cfg.m_strategies.empty()) {
+			m_trade_engine = Trading::createTradeEngine(m_cfg.m_client_id, m_cfg.m_algo_type,
+				m_cfg.m_ticker_cfg, &m_te_requests, &m_te_responses, &m_te_md_updates);
+		}
+		else {
+			m_trade_engine = Trading::createTradeEngine(m_cfg.m_client_id, m_cfg.m_strategies,
+				m_cfg.m_ticker_cfg, &m_te_requests, &m_te_responses, &m_te_md_updates);
+		}
+	}
+
+	void Backtester::reset(const BacktestCfg& cfg) {
+		ASSERT(cfg.m_client_id < BacktestReplayClientId,
+			"Invalid backtest client id " + std::to_string(cfg.m_client_id));
+		const auto same_engine = cfg.m_client_id == m_cfg.m_client_id &&
+			cfg.m_algo_type == m_cfg.m_algo_type && cfg.m_strategies == m_cfg.m_strategies;
+		m_cfg = cfg;
+
+		m_matching_engine->reset();
+		if (same_engine) {
+			m_trade_engine->reset(m_cfg.m_ticker_cfg);
+		}
+		else {
+			delete m_trade_engine;
+			buildTradeEngine();
+		}
+
+		m_to_exchange.clear();
+		m_to_engine_responses.clear();
+		m_to_engine_md_updates.clear();
+		m_now = 0;
+
+		m_replay_orders.clear();
+		std::fill(m_replay_order_keys.begin(), m_replay_order_keys.end(), ReplayKeyFree);
+		m_free_replay_order_ids.clear();
+		for (auto order_id = ME_MAX_ORDER_IDS; order_id > 0; --order_id)
+			m_free_replay_order_ids.push_back(order_id - 1);
+		m_hidden_market_order_id = OrderId_INVALID;
+
+		m_own_orders = nullptr;
+		m_next_own_fill = {};
+
+		m_num_replayed = m_num_own_skipped = m_num_md_updates = m_num_responses =
+			m_num_requests = m_num_fills = 0;
+		m_volume = 0;
+		m_first_time = m_wall_time = 0;
+		m_pnl = m_min_pnl = m_peak_pnl = m_max_drawdown = 0;
+		m_max_position = 0;
+	}
+
+	Backtester::~Backtester() {
+		delete m_trade_engine; m_trade_engine = nullptr;
+		delete m_matching_engine; m_matching_engine = nullptr;
+	}
+
+	void Backtester::run(const CaptureReader& market_updates,
+		const RecordedOwnOrders* own_orders) noexcept {
+		ASSERT(market_updates.header().m_stream == CaptureStream::MARKET_UPDATES,
+			"Backtest needs a MARKET_UPDATES capture, not " +
+			captureStreamToString(market_updates.header().m_stream));
+		if (own_orders != m_own_orders) {
+			m_own_orders = own_orders;
+			m_next_own_fill = {};
+		}
+
+		using Column = MarketUpdateColumn;
+		const auto recv_times = market_updates.column<Nanos>(size_t(Column::RECV_TIME));
+		const auto types = market_updates.column<int8_t>(size_t(Column::TYPE));
+		const auto ticker_ids = market_updates.column<TickerId>(size_t(Column::TICKER_ID));
+		const auto sides = market_updates.column<int8_t>(size_t(Column::SIDE));
+		const auto order_ids = market_updates.column<OrderId>(size_t(Column::ORDER_ID));
+		const auto prices = market_updates.column<Price>(size_t(Column::PRICE));
+		const auto qtys = market_updates.column<Qty>(size_t(Column::QTY));
+		const auto priorities = market_updates.column<Priority>(size_t(Column::PRIORITY));
+
+		const auto num_rows = market_updates.count();
+		if (num_rows && !m_first_time)
+			m_first_time = recv_times[0];
+
+		const auto update_of = [&](uint64_t row) {
+			return Exchange::MEMarketUpdate{
+				static_cast<Exchange::MarketUpdateType>(types[row]), order_ids[row],
+				ticker_ids[row], static_cast<Side>(sides[row]), prices[row], qtys[row],
+				priorities[row] };
+		};
+
+		enum class Next { NONE, RESPONSE, MARKET_UPDATE, REQUEST, REPLAY };
+
+		const auto start_time = Common::getCurrentNanos();
+		for (uint64_t row = 0;;) {
+			// Earliest event first, ties in the order checked.
+			auto next = Next::NONE;
+			auto next_time = std::numeric_limits<Nanos>::max();
+			if (!m_to_engine_responses.empty()) {
+				next = Next::RESPONSE;
+				next_time = m_to_engine_responses.front().m_time;
+			}
+			if (!m_to_engine_md_updates.empty() &&
+				m_to_engine_md_updates.front().m_time < next_time) {
+				next = Next::MARKET_UPDATE;
+				next_time = m_to_engine_md_updates.front().m_time;
+			}
+			if (!m_to_exchange.empty() && m_to_exchange.front().m_time < next_time) {
+				next = Next::REQUEST;
+				next_time = m_to_exchange.front().m_time;
+			}
+			if (row < num_rows && recv_times[row] < next_time) {
+				next = Next::REPLAY;
+				next_time = recv_times[row];
+			}
+			if (next == Next::NONE)
+				break;
+			// Receive times of different channels can be slightly out of order.
+			m_now = std::max(m_now, next_time);
+
+			switch (next) {
+			case Next::RESPONSE: {
+				const RecvTimeClientResponse client_response = { m_now,
+					m_to_engine_responses.front().m_event };
+				m_to_engine_responses.pop_front();
+				m_trade_engine->processClientResponse(&client_response, m_now);
+				++m_num_responses;
+				drainEngine();
+				updateRisk();
+			}
+				break;
+			case Next::MARKET_UPDATE: {
+				const RecvTimeMarketUpdate market_update = { m_now,
+					m_to_engine_md_updates.front().m_event };
+				m_to_engine_md_updates.pop_front();
+				m_trade_engine->processMarketUpdate(&market_update, m_now);
+				++m_num_md_updates;
+				drainEngine();
+				updateRisk();
+			}
+				break;
+			case Next::REQUEST: {
+				const auto client_request = m_to_exchange.front().m_event;
+				m_to_exchange.pop_front();
+				processRequest(client_request);
+			}
+				break;
+			case Next::REPLAY: {
+				const auto market_update = update_of(row);
+				auto own = false;
+				if (m_own_orders) {
+					// A fill's update of its passive order follows its TRADE.
+					const auto next_update = (row + 1 < num_rows) ? update_of(row + 1) :
+						Exchange::MEMarketUpdate{};
+					own = isOwn(market_update, recv_times[row],
+						(row + 1 < num_rows) ? &next_update : nullptr);
+				}
+				++row;
+				if (own)
+					++m_num_own_skipped;
+				else
+					replay(market_update);
+			}
+				break;
+			case Next::NONE:
+				break;
+			}
+		}
+		m_wall_time += Common::getCurrentNanos() - start_time;
+	}
+
+	bool Backtester::isOwn(const Exchange::MEMarketUpdate& market_update, Nanos recv_time,
+		const Exchange::MEMarketUpdate* next_update) noexcept {
+		const auto ticker_id = market_update.m_ticker_id;
+		switch (market_update.m_type) {
+		case Exchange::MarketUpdateType::ADD:
+		case Exchange::MarketUpdateType::CANCEL:
+		case Exchange::MarketUpdateType::MODIFY:
+			return m_own_orders->has(ticker_id, market_update.m_order_id);
+		case Exchange::MarketUpdateType::TRADE: {
+			const auto& fills = m_own_orders->aggressiveFills(ticker_id);
+			auto& next_fill = m_next_own_fill[ticker_id];
+			while (next_fill < fills.size() &&
+				fills[next_fill].m_recv_time + BacktestOwnFillWindow < recv_time)
+				++next_fill;
+			const auto aggressive = next_fill < fills.size() &&
+				fills[next_fill].m_recv_time < recv_time + BacktestOwnFillWindow &&
+				fills[next_fill].m_side == market_update.m_side &&
+				fills[next_fill].m_price == market_update.m_price &&
+				fills[next_fill].m_qty == market_update.m_qty;
+			if (aggressive)
+				++next_fill;
+
+			const auto passive = next_update && next_update->m_ticker_id == ticker_id &&
+				(next_update->m_type == Exchange::MarketUpdateType::MODIFY ||
+					(next_update->m_type == Exchange::MarketUpdateType::CANCEL &&
+						next_update->m_priority == Priority_INVALID)) &&
+				m_own_orders->has(ticker_id, next_update->m_order_id);
+			return aggressive || passive;
+		}
+		default:
+			return false;
+		}
+	}
+
+	void Backtester::replay(const Exchange::MEMarketUpdate& market_update) noexcept {
+		++m_num_replayed;
+		const auto key = replayKey(market_update.m_ticker_id, market_update.m_order_id);
+
+		switch (market_update.m_type) {
+		case Exchange::MarketUpdateType::ADD: {
+			if (m_replay_orders.count(key))
+				break;
+			ASSERT(!m_free_replay_order_ids.empty(), "No client order id left to replay " +
+				market_update.toString());
+			const auto order_id = m_free_replay_order_ids.back();
+			m_free_replay_order_ids.pop_back();
+			m_replay_order_keys[order_id] = key;
+			m_replay_orders[key] = order_id;
+			replayRequest(Exchange::ClientRequestType::NEW, market_update.m_ticker_id,
+				order_id, market_update.m_side, market_update.m_price, market_update.m_qty);
+		}
+			break;
+		case Exchange::MarketUpdateType::CANCEL: {
+			// Fills remove their passive order with a CANCEL without priority, the
+			// replayed TRADE did that already.
+			if (market_update.m_priority == Priority_INVALID)
+				break;
+			const auto itr = m_replay_orders.find(key);
+			if (itr != m_replay_orders.end()) {
+				replayRequest(Exchange::ClientRequestType::CANCEL, market_update.m_ticker_id,
+					itr->second, market_update.m_side, market_update.m_price, 0);
+			}
+		}
+			break;
+		case Exchange::MarketUpdateType::TRADE: {
+			ASSERT(!m_free_replay_order_ids.empty(), "No client order id left to replay " +
+				market_update.toString());
+			const auto order_id = m_free_replay_order_ids.back();
+			m_free_replay_order_ids.pop_back();
+			m_replay_order_keys[order_id] = ReplayKeyTrade;
+			replayRequest(Exchange::ClientRequestType::NEW, market_update.m_ticker_id,
+				order_id, market_update.m_side, market_update.m_price, market_update.m_qty);
+			// Less liquidity than recorded at the price, what is left does not rest.
+			if (m_replay_order_keys[order_id] != ReplayKeyFree) {
+				replayRequest(Exchange::ClientRequestType::CANCEL, market_update.m_ticker_id,
+					order_id, market_update.m_side, market_update.m_price, 0);
+			}
+			m_hidden_market_order_id = OrderId_INVALID;
+		}
+			break;
+		case Exchange::MarketUpdateType::CLEAR: {
+			// Book recovered from a snapshot, whose ADDs follow.
+			std::vector<std::pair<OrderId, uint64_t>> orders;
+			for (const auto& [order_key, order_id] : m_replay_orders) {
+				if ((order_key >> 56) == market_update.m_ticker_id)
+					orders.emplace_back(order_id, order_key);
+			}
+			std::sort(orders.begin(), orders.end());
+			for (const auto& order : orders) {
+				replayRequest(Exchange::ClientRequestType::CANCEL, market_update.m_ticker_id,
+					order.first, Side::INVALID, Price_INVALID, 0);
+			}
+		}
+			break;
+		case Exchange::MarketUpdateType::MODIFY:
+			// Only fills modify, see TRADE.
+		case Exchange::MarketUpdateType::SNAPSHOT_START:
+		case Exchange::MarketUpdateType::SNAPSHOT_END:
+		case Exchange::MarketUpdateType::INVALID:
+			break;
+		}
+	}
+
+	void Backtester::replayRequest(Exchange::ClientRequestType type, TickerId ticker_id,
+		OrderId order_id, Side side, Price price, Qty qty) noexcept {
+		const Exchange::MEClientRequest client_request = { type, BacktestReplayClientId,
+			ticker_id, order_id, side, price, qty };
+		processRequest(client_request);
+	}
+
+	void Backtester::releaseReplayOrder(OrderId order_id) noexcept {
+		const auto key = m_replay_order_keys[order_id];
+		if (key == ReplayKeyFree)
+			return;
+		if (key != ReplayKeyTrade)
+			m_replay_orders.erase(key);
+		m_replay_order_keys[order_id] = ReplayKeyFree;
+		m_free_replay_order_ids.push_back(order_id);
+	}
+
+	void Backtester::processRequest(const Exchange::MEClientRequest& client_request)
+		noexcept {
+		m_matching_engine->processClientRequest(&client_request);
+		drainExchange();
+	}
+
+	void Backtester::drainExchange() noexcept {
+		for (auto client_response = m_me_responses.getNextToRead(); client_response;
+			client_response = m_me_responses.getNextToRead()) {
+			if (client_response->m_client_id == BacktestReplayClientId) {
+				const auto order_id = client_response->m_client_order_id;
+				switch (client_response->m_type) {
+				case Exchange::ClientResponseType::ACCEPTED:
+					if (m_replay_order_keys[order_id] == ReplayKeyTrade)
+						m_hidden_market_order_id = client_response->m_market_order_id;
+					break;
+				case Exchange::ClientResponseType::FILLED:
+					if (!client_response->m_leaves_qty)
+						releaseReplayOrder(order_id);
+					break;
+				case Exchange::ClientResponseType::CANCELED:
+					releaseReplayOrder(order_id);
+					break;
+				default:
+					break;
+				}
+			}
+			else {
+				if (client_response->m_type == Exchange::ClientResponseType::FILLED) {
+					++m_num_fills;
+					m_volume += client_response->m_exec_qty;
+				}
+				m_to_engine_responses.push_back({ m_now + m_cfg.m_response_latency,
+					*client_response });
+			}
+			m_me_responses.updateReadIndex();
+		}
+
+		for (auto market_update = m_me_md_updates.getNextToRead(); market_update;
+			market_update = m_me_md_updates.getNextToRead()) {
+			const auto hidden = market_update->m_order_id == m_hidden_market_order_id &&
+				(market_update->m_type == Exchange::MarketUpdateType::ADD ||
+					market_update->m_type == Exchange::MarketUpdateType::CANCEL);
+			if (!hidden)
+				m_to_engine_md_updates.push_back({ m_now + m_cfg.m_md_latency, *market_update });
+			m_me_md_updates.updateReadIndex();
+		}
+	}
+
+	void Backtester::drainEngine() noexcept {
+		for (auto client_request = m_te_requests.getNextToRead(); client_request;
+			client_request = m_te_requests.getNextToRead()) {
+			m_to_exchange.push_back({ m_now + m_cfg.m_order_latency, *client_request });
+			++m_num_requests;
+			m_te_requests.updateReadIndex();
+		}
+	}
+
+	void Backtester::updateRisk() noexcept {
+		const auto& position_keeper = m_trade_engine->positionKeeper();
+		double pnl = 0;
+		for (TickerId ticker_id = 0; ticker_id < ME_MAX_TICKERS; ++ticker_id) {
+			const auto position_info = position_keeper.getPositionInfo(ticker_id);
+			// m_total_pnl is left stale when a position closes.
+			pnl += position_info->m_real_pnl + position_info->m_unreal_pnl;
+			m_max_position = std::max(m_max_position, std::abs(position_info->m_position));
+		}
+		m_pnl = pnl;
+		m_min_pnl = std::min(m_min_pnl, pnl);
+		m_peak_pnl = std::max(m_peak_pnl, pnl);
+		m_max_drawdown = std::max(m_max_drawdown, m_peak_pnl - pnl);
+	}
+
+	std::string Backtester::report() const {
+		std::stringstream ss;
+		const auto sim_time = m_now - m_first_time;
+		ss << m_cfg.toString() << "\n" <<
+			"replayed:" << m_num_replayed <<
+			" own_skipped:" << m_num_own_skipped <<
+			" md_updates:" << m_num_md_updates <<
+			" responses:" << m_num_responses <<
+			" requests:" << m_num_requests <<
+			" fills:" << m_num_fills <<
+			" volume:" << m_volume << "\n" <<
+			"sim_ns:" << sim_time <<
+			" wall_ns:" << m_wall_time <<
+			" replayed_per_sec:" << (m_wall_time ? static_cast<double>(m_num_replayed) *
+				NANOS_TO_SECS / m_wall_time : 0) << "\n" <<
+			"pnl:" << m_pnl <<
+			" min_pnl:" << m_min_pnl <<
+			" max_drawdown:" << m_max_drawdown <<
+			" max_position:" << m_max_position << "\n" <<
+			m_trade_engine->positionKeeper().toString();
+		return ss.str();
+	}
+}
@@ -0,0 +1,182 @@
+#pragma once
+
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+#include "common/macros.hpp"
+#include "common/time_utils.hpp"
+
+#include "exchange/matcher/matching_engine.hpp"
+
+#include "trading/strategy/trade_engine.hpp"
+#include "trading/capture/market_data_capture.hpp"
+#include "trading/backtest/recorded_own_orders.hpp"
+
+namespace Trading {
+
+	/// ClientId the recorded market's orders are replayed under, strategies cannot
+	/// use it.
+	constexpr ClientId BacktestReplayClientId = ME_MAX_NUM_CLIENTS - 1;
+
+	/// How far apart the receive times of an aggressive own fill and its TRADE
+	/// can be, older fills were never seen in the market data. Wider windows
+	/// take more of the market's TRADEs of the same price and quantity for own.
+	constexpr Nanos BacktestOwnFillWindow = 100 * NANOS_TO_MICROS;
+
+	struct BacktestCfg {
+		ClientId m_client_id = 1;
+		AlgoType m_algo_type = AlgoType::MAKER;
+		TradeEngineCfgHashMap m_ticker_cfg;
+		/// Strategies to run side by side in a MultiAlgo instead of m_algo_type
+		/// alone, if any.
+		std::vector<StrategyCfg> m_strategies;
+
+		/// One way delays around the simulated exchange, constant so events on each
+		/// path stay in order.
+		Nanos m_order_latency = 20 * NANOS_TO_MICROS;
+		Nanos m_response_latency = 20 * NANOS_TO_MICROS;
+		Nanos m_md_latency = 20 * NANOS_TO_MICROS;
+
+		std::string toString() const;
+	};
+
+	/// Runs a TradeEngine against a simulated exchange on simulated time, on the
+	/// calling thread, as fast as the events can be handled.
+	///
+	/// The exchange is a MatchingEngine, driven directly instead of from its
+	/// thread. Market updates from a capture are replayed into it as orders of
+	/// BacktestReplayClientId at their receive times: ADD and user CANCEL as they
+	/// are, TRADE as an immediate-or-cancel order of the aggressor for the traded
+	/// quantity. The CANCEL and MODIFY a fill leaves behind are skipped, the
+	/// replayed TRADE already did that. The engine's orders queue behind the
+	/// recorded ones at their price in MEOrderBook's FIFO, so it is only filled by
+	/// trades that reach it, and what it takes is gone from the replayed book.
+	/// The engine sees the MatchingEngine's updates and responses, its own
+	/// orders included, as it would live. Same capture and config, same result.
+	///
+	/// The recording client's own orders are in the capture too. Given its
+	/// RecordedOwnOrders, their ADD, CANCEL and MODIFY are skipped, and so is a
+	/// TRADE followed by the fill's update of an own order, or matching the next
+	/// aggressive own fill. Without them the recording client's orders are
+	/// replayed as liquidity of the market, which the backtested engine may then
+	/// trade against.
+	class Backtester final {
+		/// Event on its way to the engine or the exchange, due at m_time.
+		template<typename T>
+		struct Timed {
+			Nanos m_time = 0;
+			T m_event;
+		};
+
+		/// m_replay_order_keys entries for client order ids not in use, and for the
+		/// one replaying a TRADE.
+		static constexpr uint64_t ReplayKeyFree = std::numeric_limits<uint64_t>::max();
+		static constexpr uint64_t ReplayKeyTrade = ReplayKeyFree - 1;
+
+		BacktestCfg m_cfg;
+
+		Exchange::ClientRequestLFQueue m_te_requests;
+		RecvTimeClientResponseLFQueue m_te_responses;
+		RecvTimeMarketUpdateLFQueue m_te_md_updates;
+		Exchange::ClientRequestLFQueue m_me_requests;
+		Exchange::ClientResponseLFQueue m_me_responses;
+		Exchange::MEMarketUpdateLFQueue m_me_md_updates;
+
+		Exchange::MatchingEngine* m_matching_engine = nullptr;
+		TradeEngine* m_trade_engine = nullptr;
+
+		std::deque<Timed<Exchange::MEClientRequest>> m_to_exchange;
+		std::deque<Timed<Exchange::MEClientResponse>> m_to_engine_responses;
+		std::deque<Timed<Exchange::MEMarketUpdate>> m_to_engine_md_updates;
+
+		Nanos m_now = 0;
+
+		/// Recorded orders resting in the exchange, by replayKey(), to the client
+		/// order id they were replayed with.
+		std::unordered_map<uint64_t, OrderId> m_replay_orders;
+		std::vector<uint64_t> m_replay_order_keys;
+		std::vector<OrderId> m_free_replay_order_ids;
+		/// Market order id of the replayed TRADE order, its ADD and CANCEL are
+		/// not published.
+		OrderId m_hidden_market_order_id = OrderId_INVALID;
+
+		/// Recording client's orders of the capture being run, and the next of its
+		/// aggressive fills of each ticker to be seen as a TRADE.
+		const RecordedOwnOrders* m_own_orders = nullptr;
+		std::array<size_t, ME_MAX_TICKERS> m_next_own_fill = {};
+
+		size_t m_num_replayed = 0;
+		size_t m_num_own_skipped = 0;
+		size_t m_num_md_updates = 0;
+		size_t m_num_responses = 0;
+		size_t m_num_requests = 0;
+		size_t m_num_fills = 0;
+		Qty m_volume = 0;
+		Nanos m_first_time = 0;
+		Nanos m_wall_time = 0;
+
+		/// Sampled after every event the engine handles, PnL over all tickers.
+		double m_pnl = 0;
+		double m_min_pnl = 0;
+		double m_peak_pnl = 0;
+		double m_max_drawdown = 0;
+		int32_t m_max_position = 0;
+
+		static auto replayKey(TickerId ticker_id, OrderId market_order_id) noexcept {
+			return (static_cast<uint64_t>(ticker_id) << 56) | market_order_id;
+		}
+
+		bool isOwn(const Exchange::MEMarketUpdate& market_update, Nanos recv_time,
+			const Exchange::MEMarketUpdate* next_update) noexcept;
+		void replay(const Exchange::MEMarketUpdate& market_update) noexcept;
+		void replayRequest(Exchange::ClientRequestType type, TickerId ticker_id,
+			OrderId order_id, Side side, Price price, Qty qty) noexcept;
+		void releaseReplayOrder(OrderId order_id) noexcept;
+		void processRequest(const Exchange::MEClientRequest& client_request) noexcept;
+		void drainExchange() noexcept;
+		void drainEngine() noexcept;
+		void updateRisk() noexcept;
+		void buildTradeEngine();
+
+	public:
+		explicit Backtester(const BacktestCfg& cfg);
+		~Backtester();
+
+		Backtester() = delete;
+		Backtester(const Backtester&) = delete;
+		Backtester(const Backtester&&) = delete;
+		Backtester& operator=(const Backtester&) = delete;
+		Backtester& operator=(const Backtester&&) = delete;
+
+		/// Back to the state of a new Backtester of cfg. The exchange's and the
+		/// engine's pools are reused, the engine is only rebuilt when cfg runs
+		/// other strategies or another client.
+		void reset(const BacktestCfg& cfg);
+
+		/// Replays the rows of a MARKET_UPDATES capture and everything they lead
+		/// to, but the orders of own_orders if given. Captures of one session go in
+		/// one after the other.
+		void run(const CaptureReader& market_updates,
+			const RecordedOwnOrders* own_orders = nullptr) noexcept;
+
+		const auto& tradeEngine() const noexcept { return *m_trade_engine; }
+		auto numFills() const noexcept { return m_num_fills; }
+		auto volume() const noexcept { return m_volume; }
+		auto numRequests() const noexcept { return m_num_requests; }
+		auto numReplayed() const noexcept { return m_num_replayed; }
+		auto numOwnSkipped() const noexcept { return m_num_own_skipped; }
+		auto wallTime() const noexcept { return m_wall_time; }
+
+		/// Realized plus unrealized PnL at the end, its lowest and the largest
+		/// fall from a high along the way, and the largest absolute position of
+		/// any ticker.
+		auto pnl() const noexcept { return m_pnl; }
+		auto minPnl() const noexcept { return m_min_pnl; }
+		auto maxDrawdown() const noexcept { return m_max_drawdown; }
+		auto maxPosition() const noexcept { return m_max_position; }
+
+		/// Counters, simulated and wall clock time, then the engine's positions.
+		std::string report() const;
+	};
+}
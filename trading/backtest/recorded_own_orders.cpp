@@ -0,0 +1,57 @@
+#include "trading/backtest/recorded_own_orders.hpp"
+
+#include "exchange/order_server/client_response.hpp"
+
+namespace Trading {
+
+	void RecordedOwnOrders::add(const CaptureReader& client_responses) {
+		ASSERT(client_responses.header().m_stream == CaptureStream::CLIENT_RESPONSES,
+			"Own orders come from a CLIENT_RESPONSES capture, not " +
+			captureStreamToString(client_responses.header().m_stream));
+
+		using Column = ClientResponseColumn;
+		const auto recv_times = client_responses.column<Nanos>(size_t(Column::RECV_TIME));
+		const auto types = client_responses.column<int8_t>(size_t(Column::TYPE));
+		const auto ticker_ids = client_responses.column<TickerId>(size_t(Column::TICKER_ID));
+		const auto market_order_ids =
+			client_responses.column<OrderId>(size_t(Column::MARKET_ORDER_ID));
+		const auto sides = client_responses.column<int8_t>(size_t(Column::SIDE));
+		const auto prices = client_responses.column<Price>(size_t(Column::PRICE));
+		const auto exec_qtys = client_responses.column<Qty>(size_t(Column::EXEC_QTY));
+
+		const auto num_rows = client_responses.count();
+		for (uint64_t row = 0; row < num_rows; ++row) {
+			const auto ticker_id = ticker_ids[row];
+			const auto market_order_id = market_order_ids[row];
+			switch (static_cast<Exchange::ClientResponseType>(types[row])) {
+			case Exchange::ClientResponseType::ACCEPTED:
+				ASSERT(ticker_id < ME_MAX_TICKERS, "Invalid ticker in own order " +
+					std::to_string(market_order_id));
+				m_orders.insert(key(ticker_id, market_order_id));
+				m_aggressor_ticker_id = ticker_id;
+				m_aggressor_order_id = market_order_id;
+				break;
+			case Exchange::ClientResponseType::FILLED:
+				// Fills of other orders in between are the passive side of a self trade.
+				if (ticker_id == m_aggressor_ticker_id && market_order_id == m_aggressor_order_id) {
+					m_aggressive_fills[ticker_id].push_back({ recv_times[row],
+						static_cast<Side>(sides[row]), prices[row], exec_qtys[row] });
+				}
+				break;
+			default:
+				m_aggressor_ticker_id = TickerId_INVALID;
+				m_aggressor_order_id = OrderId_INVALID;
+				break;
+			}
+		}
+	}
+
+	size_t RecordedOwnOrders::addDay(const std::string& dir, uint32_t day) {
+		const auto paths = capturePaths(dir, CaptureStream::CLIENT_RESPONSES, day);
+		for (const auto& path : paths) {
+			CaptureReader client_responses(path);
+			add(client_responses);
+		}
+		return paths.size();
+	}
+}
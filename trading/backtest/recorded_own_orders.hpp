@@ -0,0 +1,66 @@
+#pragma once
+
+#include <array>
+#include <unordered_set>
+#include <vector>
+
+#include "common/macros.hpp"
+#include "common/types.hpp"
+
+#include "trading/capture/market_data_capture.hpp"
+
+namespace Trading {
+
+	/// Fill the recording client got as the aggressor, which the market data
+	/// shows as a TRADE of m_side.
+	struct RecordedOwnFill {
+		Nanos m_recv_time = 0;
+		Side m_side = Side::INVALID;
+		Price m_price = Price_INVALID;
+		Qty m_qty = Qty_INVALID;
+	};
+
+	/// The recording client's own orders, from the CLIENT_RESPONSES captures of
+	/// the day of a MARKET_UPDATES capture, so a Backtester can keep them out of
+	/// the replayed market.
+	///
+	/// Orders are known by the market order id of their ACCEPTED. Aggressive fills
+	/// are the FILLED of an order between its ACCEPTED and the client's next
+	/// response to anything but a fill, in the order they were received.
+	class RecordedOwnOrders final {
+		std::unordered_set<uint64_t> m_orders;
+		std::array<std::vector<RecordedOwnFill>, ME_MAX_TICKERS> m_aggressive_fills;
+
+		/// Order whose aggressive fills are coming in, carried across parts.
+		TickerId m_aggressor_ticker_id = TickerId_INVALID;
+		OrderId m_aggressor_order_id = OrderId_INVALID;
+
+		static auto key(TickerId ticker_id, OrderId market_order_id) noexcept {
+			return (static_cast<uint64_t>(ticker_id) << 56) | market_order_id;
+		}
+
+	public:
+		RecordedOwnOrders() = default;
+
+		RecordedOwnOrders(const RecordedOwnOrders&) = delete;
+		RecordedOwnOrders(const RecordedOwnOrders&&) = delete;
+		RecordedOwnOrders& operator=(const RecordedOwnOrders&) = delete;
+		RecordedOwnOrders& operator=(const RecordedOwnOrders&&) = delete;
+
+		/// Adds the rows of a CLIENT_RESPONSES capture, parts of one session in order.
+		void add(const CaptureReader& client_responses);
+		/// Adds every part of day's CLIENT_RESPONSES capture under dir, returns how
+		/// many there were.
+		size_t addDay(const std::string& dir, uint32_t day);
+
+		auto has(TickerId ticker_id, OrderId market_order_id) const noexcept {
+			return m_orders.count(key(ticker_id, market_order_id)) != 0;
+		}
+
+		const auto& aggressiveFills(TickerId ticker_id) const noexcept {
+			return m_aggressive_fills[ticker_id];
+		}
+
+		auto numOrders() const noexcept { return m_orders.size(); }
+	};
+}
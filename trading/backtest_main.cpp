@@ -0,0 +1,83 @@
+#include <map>
+
+#include "trading/trading_args.hpp"
+#include "trading/backtest/backtester.hpp"
+
+// Backtest of a strategy on captured market data, see Trading::Backtester.
+//
+// Usage: backtest_main CLIENT_ID ALGO_TYPE [CLIP THRESHOLD MAX_ORDER_SIZE MAX_POSITION
+//   MAX_LOSS]... md=<capture>... [key=value]...
+// Ticker configuration as for trading_main. Options:
+// - md=<file>: an md_*.cap file of MarketDataCapture, repeat for more, in order.
+//   The resp_*.cap files of its day next to it hold the recording client's own
+//   orders, which are left out of the replay.
+// - config=<file>: more arguments, whitespace separated, # starts a comment.
+// - order_latency_us=, response_latency_us=, md_latency_us=: one way delays
+//   between the engine and the simulated exchange, 20 by default.
+// - log=1: keep the engines' logs, off by default as they cost more than the
+//   simulation.
+// - strategy=ALGO_TYPE:TICKER,...: another strategy in the same engine, as for
+//   trading_main.
+// Prints the counters and the positions at the end.
+
+int main(int argc, char** argv) {
+	const auto args = Trading::readArgs(argc, argv);
+
+	Trading::BacktestCfg cfg;
+	bool log = false;
+	std::vector<std::string> md_files;
+	std::vector<Trading::StrategyCfg> extra_strategies;
+	std::vector<std::string> positional;
+	for (const auto& arg : args) {
+		const auto equals = arg.find('=');
+		if (equals == std::string::npos) {
+			positional.push_back(arg);
+			continue;
+		}
+		const auto key = arg.substr(0, equals);
+		const auto value = arg.substr(equals + 1);
+		if (key == "md")
+			md_files.push_back(value);
+		else if (key == "order_latency_us")
+			cfg.m_order_latency = static_cast<Nanos>(std::stod(value) * NANOS_TO_MICROS);
+		else if (key == "response_latency_us")
+			cfg.m_response_latency = static_cast<Nanos>(std::stod(value) * NANOS_TO_MICROS);
+		else if (key == "md_latency_us")
+			cfg.m_md_latency = static_cast<Nanos>(std::stod(value) * NANOS_TO_MICROS);
+		else if (key == "log")
+			log = std::stoi(value);
+		else if (key == "strategy")
+			extra_strategies.push_back(Trading::stringToStrategyCfg(value));
+		else
+			FATAL("Unknown argument " + arg);
+	}
+
+	ASSERT(positional.size() >= 2 && (positional.size() - 2) % 5 == 0 && !md_files.empty(),
+		"Usage: backtest_main CLIENT_ID ALGO_TYPE [CLIP THRESHOLD MAX_ORDER_SIZE MAX_POSITION"
+		" MAX_LOSS]... md=<capture>... [key=value]...");
+	cfg.m_client_id = static_cast<Common::ClientId>(std::stoul(positional[0]));
+	cfg.m_algo_type = Common::stringToAlgoType(positional[1]);
+	ASSERT(cfg.m_algo_type != Common::AlgoType::INVALID &&
+		cfg.m_algo_type != Common::AlgoType::MAX && cfg.m_algo_type != Common::AlgoType::RANDOM,
+		"Invalid algo type " + positional[1]);
+	const auto num_tickers = Trading::parseTickerCfg(positional, 2, &cfg.m_ticker_cfg);
+
+	cfg.m_strategies = Trading::strategiesOf(cfg.m_algo_type, num_tickers, extra_strategies);
+
+	Common::Logger::setEnabled(log);
+	Trading::Backtester backtester(cfg);
+	std::map<uint32_t, Trading::RecordedOwnOrders> own_orders;
+	for (const auto& md_file : md_files) {
+		Trading::CaptureReader market_updates(md_file);
+		const auto day = market_updates.header().m_day;
+		const auto [day_own_orders, added] = own_orders.try_emplace(day);
+		if (added && !day_own_orders->second.addDay(Trading::captureDir(md_file), day)) {
+			std::cerr << "No resp_" << day << "_*.cap next to " << md_file <<
+				", the recording client's orders are replayed as the market's." << std::endl;
+		}
+		backtester.run(market_updates, &day_own_orders->second);
+	}
+	std::cout << backtester.report() << std::endl;
+
+	return 0;
+}
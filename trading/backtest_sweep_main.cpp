@@ -0,0 +1,104 @@
+#include "trading/trading_args.hpp"
+#include "trading/backtest/backtest_sweep.hpp"
+
+// Parameter sweep of backtests over days of captured market data, see
+// Trading::BacktestSweep.
+//
+// Usage: backtest_sweep_main md=<capture>... [key=value]...
+// Lists are comma separated, the grid is every combination of them. Options:
+// - md=<file>: an md_*.cap file of MarketDataCapture, repeat for more, grouped
+//   into days by their header. The resp_*.cap files of a day next to them hold
+//   the recording client's own orders, which are left out of the replay.
+// - config=<file>: more arguments, whitespace separated, # starts a comment.
+// - algo=MAKER,TAKER: algo types, MAKER by default.
+// - clip=, threshold=, max_order_size=, max_position=, max_loss=: lists of
+//   TradeEngineCfg values, required.
+// - tickers=N: tickers 0 to N-1 get each point's config, 1 by default.
+// - client_id=, order_latency_us=, response_latency_us=, md_latency_us=: as
+//   for backtest_main.
+// - workers=N: threads, by default the number of cores or of Backtesters the
+//   available memory holds, whichever is less, see SweepWorkerMemory.
+// - core=C: pins the workers to cores C onwards, unpinned by default.
+// Prints every backtest, then every point over all days best first.
+
+namespace {
+	template<typename T, typename Parse>
+	auto parseList(const std::string& value, Parse parse) {
+		std::vector<T> values;
+		std::stringstream ss(value);
+		std::string item;
+		while (std::getline(ss, item, ','))
+			values.push_back(static_cast<T>(parse(item)));
+		return values;
+	}
+
+	auto parseQty(const std::string& item) { return std::stoul(item); }
+	auto parseDouble(const std::string& item) { return std::stod(item); }
+}
+
+int main(int argc, char** argv) {
+	const auto args = Trading::readArgs(argc, argv);
+
+	Trading::SweepCfg cfg;
+	cfg.m_algo_types = { Common::AlgoType::MAKER };
+	cfg.m_num_workers = Trading::sweepDefaultWorkers();
+	std::vector<std::string> md_files;
+	for (const auto& arg : args) {
+		const auto equals = arg.find('=');
+		ASSERT(equals != std::string::npos, "Unknown argument " + arg);
+		const auto key = arg.substr(0, equals);
+		const auto value = arg.substr(equals + 1);
+		if (key == "md")
+			md_files.push_back(value);
+		else if (key == "algo") {
+			cfg.m_algo_types = parseList<Common::AlgoType>(value, Common::stringToAlgoType);
+			for (const auto algo_type : cfg.m_algo_types) {
+				ASSERT(algo_type == Common::AlgoType::MAKER || algo_type == Common::AlgoType::TAKER,
+					"Invalid algo type in " + arg);
+			}
+		}
+		else if (key == "clip")
+			cfg.m_clips = parseList<Qty>(value, parseQty);
+		else if (key == "threshold")
+			cfg.m_thresholds = parseList<double>(value, parseDouble);
+		else if (key == "max_order_size")
+			cfg.m_max_order_sizes = parseList<Qty>(value, parseQty);
+		else if (key == "max_position")
+			cfg.m_max_positions = parseList<Qty>(value, parseQty);
+		else if (key == "max_loss")
+			cfg.m_max_losses = parseList<double>(value, parseDouble);
+		else if (key == "tickers")
+			cfg.m_num_tickers = std::stoul(value);
+		else if (key == "client_id")
+			cfg.m_backtest.m_client_id = static_cast<Common::ClientId>(std::stoul(value));
+		else if (key == "order_latency_us")
+			cfg.m_backtest.m_order_latency = static_cast<Nanos>(std::stod(value) * NANOS_TO_MICROS);
+		else if (key == "response_latency_us")
+			cfg.m_backtest.m_response_latency = static_cast<Nanos>(std::stod(value) * NANOS_TO_MICROS);
+		else if (key == "md_latency_us")
+			cfg.m_backtest.m_md_latency = static_cast<Nanos>(std::stod(value) * NANOS_TO_MICROS);
+		else if (key == "workers")
+			cfg.m_num_workers = std::stoul(value);
+		else if (key == "core")
+			cfg.m_first_core = std::stoi(value);
+		else
+			FATAL("Unknown argument " + arg);
+	}
+
+	ASSERT(!md_files.empty() && !cfg.m_clips.empty() && !cfg.m_thresholds.empty() &&
+		!cfg.m_max_order_sizes.empty() && !cfg.m_max_positions.empty() &&
+		!cfg.m_max_losses.empty(),
+		"Usage: backtest_sweep_main md=<capture>... clip=Q,... threshold=T,..."
+		" max_order_size=Q,... max_position=Q,... max_loss=L,... [key=value]...");
+
+	Common::Logger::setEnabled(false);
+	Trading::BacktestSweep sweep(cfg, md_files);
+	for (const auto day : sweep.daysWithoutOwnOrders()) {
+		std::cerr << "No resp_" << day << "_*.cap next to the md captures of day " << day <<
+			", the recording client's orders are replayed as the market's." << std::endl;
+	}
+	sweep.run();
+	std::cout << sweep.report() << std::endl;
+
+	return 0;
+}
@@ -0,0 +1,155 @@
+#include "trading/capture/capture_file.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Trading {
+
+	namespace {
+		auto pageAligned(uint64_t size) noexcept {
+			return (size + CapturePageSize - 1) / CapturePageSize * CapturePageSize;
+		}
+	}
+
+	CaptureFile::CaptureFile(const std::string& path, CaptureStream stream, uint32_t day,
+		uint64_t first_seq, uint64_t capacity, const std::vector<CaptureColumnSpec>& columns) :
+		m_path(path) {
+		ASSERT(!columns.empty() && columns.size() <= CaptureMaxColumns,
+			"Bad number of capture columns for " + path);
+		ASSERT(capacity, "Empty capture file " + path);
+
+		// Columns, then one index entry per CaptureIndexStride rows.
+		CaptureFileHeader header;
+		uint64_t offset = CapturePageSize;
+		for (size_t i = 0; i < columns.size(); ++i) {
+			auto& column = header.m_columns[i];
+			strncpy(column.m_name, columns[i].m_name, CaptureColumnNameSize - 1);
+			column.m_width = columns[i].m_width;
+			column.m_is_signed = columns[i].m_is_signed;
+			column.m_offset = offset;
+			offset = pageAligned(offset + capacity * column.m_width);
+		}
+		header.m_index_offset = offset;
+		m_size = pageAligned(offset +
+			(capacity + CaptureIndexStride - 1) / CaptureIndexStride * sizeof(Nanos));
+
+		m_fd = open(path.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+		ASSERT(m_fd != -1, "open() failed for " + path + " error:" +
+			std::string(strerror(errno)));
+		const auto error = posix_fallocate(m_fd, 0, m_size);
+		ASSERT(error == 0, "posix_fallocate() failed for " + path + " error:" +
+			std::string(strerror(error)));
+
+		auto data = mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+		ASSERT(data != MAP_FAILED, "mmap() failed for " + path + " error:" +
+			std::string(strerror(errno)));
+		m_data = static_cast<char*>(data);
+
+		m_header = new(m_data) CaptureFileHeader();
+		m_header->m_stream = stream;
+		m_header->m_day = day;
+		m_header->m_num_columns = static_cast<uint32_t>(columns.size());
+		m_header->m_capacity = capacity;
+		m_header->m_first_seq = first_seq;
+		m_header->m_index_offset = header.m_index_offset;
+		std::copy(std::begin(header.m_columns), std::end(header.m_columns),
+			m_header->m_columns);
+		m_index = reinterpret_cast<Nanos*>(m_data + m_header->m_index_offset);
+		// Magic last, a reader opening the file early rejects it instead of using a
+		// half written header.
+		std::atomic_thread_fence(std::memory_order_release);
+		memcpy(m_header->m_magic, CaptureMagic, sizeof(CaptureMagic));
+	}
+
+	CaptureFile::~CaptureFile() {
+		// Unused rows stay allocated, capacity tells readers the layout.
+		msync(m_data, m_size, MS_ASYNC);
+		munmap(m_data, m_size);
+		m_data = nullptr;
+		m_header = nullptr;
+		close(m_fd);
+		m_fd = -1;
+	}
+
+	CaptureReader::CaptureReader(const std::string& path) {
+		m_fd = open(path.c_str(), O_RDONLY);
+		ASSERT(m_fd != -1, "open() failed for " + path + " error:" +
+			std::string(strerror(errno)));
+		struct stat st;
+		ASSERT(fstat(m_fd, &st) == 0 && static_cast<size_t>(st.st_size) >= CapturePageSize,
+			"Not a capture file " + path);
+		m_size = st.st_size;
+
+		auto data = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, m_fd, 0);
+		ASSERT(data != MAP_FAILED, "mmap() failed for " + path + " error:" +
+			std::string(strerror(errno)));
+		m_data = static_cast<const char*>(data);
+		m_header = reinterpret_cast<const CaptureFileHeader*>(m_data);
+		ASSERT(memcmp(m_header->m_magic, CaptureMagic, sizeof(CaptureMagic)) == 0,
+			"Bad magic in capture file " + path);
+		ASSERT(m_header->m_num_columns <= CaptureMaxColumns && m_header->m_index_offset +
+			(m_header->m_capacity + CaptureIndexStride - 1) / CaptureIndexStride *
+			sizeof(Nanos) <= m_size, "Truncated capture file " + path);
+		m_index = reinterpret_cast<const Nanos*>(m_data + m_header->m_index_offset);
+	}
+
+	CaptureReader::~CaptureReader() {
+		munmap(const_cast<char*>(m_data), m_size);
+		m_data = nullptr;
+		m_header = nullptr;
+		close(m_fd);
+		m_fd = -1;
+	}
+
+	size_t CaptureReader::columnIndex(const std::string& name) const noexcept {
+		for (size_t i = 0; i < m_header->m_num_columns; ++i) {
+			if (name == m_header->m_columns[i].m_name)
+				return i;
+		}
+		return CaptureMaxColumns;
+	}
+
+	int64_t CaptureReader::value(size_t column_index, uint64_t row) const noexcept {
+		const auto& column = m_header->m_columns[column_index];
+		const auto data = m_data + column.m_offset + row * column.m_width;
+		switch (column.m_width) {
+		case 1:
+			return column.m_is_signed ? *reinterpret_cast<const int8_t*>(data) :
+				*reinterpret_cast<const uint8_t*>(data);
+		case 2:
+			return column.m_is_signed ? *reinterpret_cast<const int16_t*>(data) :
+				*reinterpret_cast<const uint16_t*>(data);
+		case 4:
+			return column.m_is_signed ? *reinterpret_cast<const int32_t*>(data) :
+				*reinterpret_cast<const uint32_t*>(data);
+		case 8:
+			return *reinterpret_cast<const int64_t*>(data);
+		}
+		return 0;
+	}
+
+	uint64_t CaptureReader::rowNear(Nanos recv_time) const noexcept {
+		const auto num_rows = count();
+		if (!num_rows)
+			return 0;
+		const auto num_blocks = (num_rows + CaptureIndexStride - 1) / CaptureIndexStride;
+		// Last block starting at or before recv_time, one back for the skew.
+		const auto it = std::upper_bound(m_index, m_index + num_blocks, recv_time);
+		const auto block = static_cast<uint64_t>(std::max<ptrdiff_t>(it - m_index - 2, 0));
+		return block * CaptureIndexStride;
+	}
+
+	uint32_t captureDay(Nanos time) noexcept {
+		const auto seconds = static_cast<time_t>(time / NANOS_TO_SECS);
+		tm utc;
+		gmtime_r(&seconds, &utc);
+		return static_cast<uint32_t>((utc.tm_year + 1900) * 10000 + (utc.tm_mon + 1) * 100 +
+			utc.tm_mday);
+	}
+}
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "common/macros.hpp"
+#include "common/time_utils.hpp"
+
+using namespace Common;
+
+namespace Trading {
+
+	/// File layout of a capture: a CaptureFileHeader page, then one page aligned
+	/// column of m_capacity fixed width values per field, then the time index.
+	/// Row n of a column is at column offset + n * width, and rows hold capture
+	/// sequence numbers m_first_seq onwards without gaps, so a SeqNum maps to its
+	/// offset without a search.
+	constexpr char CaptureMagic[8] = { 'L', 'L', 'C', 'A', 'P', 'T', '0', '1' };
+	constexpr size_t CaptureMaxColumns = 16;
+	constexpr size_t CaptureColumnNameSize = 24;
+	constexpr size_t CapturePageSize = 4096;
+	/// Rows between two entries of the time index.
+	constexpr size_t CaptureIndexStride = 4096;
+
+	enum class CaptureStream : uint32_t {
+		INVALID = 0,
+		MARKET_UPDATES = 1,
+		CLIENT_RESPONSES = 2
+	};
+
+	inline std::string captureStreamToString(CaptureStream stream) {
+		switch (stream) {
+		case CaptureStream::MARKET_UPDATES:
+			return "MARKET_UPDATES";
+		case CaptureStream::CLIENT_RESPONSES:
+			return "CLIENT_RESPONSES";
+		case CaptureStream::INVALID:
+			return "INVALID";
+		}
+		return "UNKNOWN";
+	}
+
+	struct CaptureColumnSpec {
+		const char* m_name = nullptr;
+		uint32_t m_width = 0;
+		bool m_is_signed = false;
+	};
+
+	struct CaptureColumn {
+		char m_name[CaptureColumnNameSize] = {};
+		uint32_t m_width = 0;
+		uint32_t m_is_signed = 0;
+		uint64_t m_offset = 0;
+	};
+
+	struct CaptureFileHeader {
+		char m_magic[8] = {};
+		uint32_t m_version = 1;
+		CaptureStream m_stream = CaptureStream::INVALID;
+		/// UTC day of the receive times in the file, YYYYMMDD.
+		uint32_t m_day = 0;
+		uint32_t m_num_columns = 0;
+		uint64_t m_capacity = 0;
+		uint64_t m_first_seq = 0;
+		/// Rows written, stored after the row so a reader of a live file only sees
+		/// complete ones.
+		std::atomic<uint64_t> m_count = 0;
+		/// Receive time of every CaptureIndexStride-th row.
+		uint64_t m_index_offset = 0;
+		CaptureColumn m_columns[CaptureMaxColumns];
+	};
+	static_assert(sizeof(CaptureFileHeader) <= CapturePageSize);
+
+	/// Preallocated, memory-mapped capture file being written. Rows are filled
+	/// column by column through column<T>() and published with commit().
+	class CaptureFile final {
+		std::string m_path;
+		int m_fd = -1;
+		char* m_data = nullptr;
+		size_t m_size = 0;
+		CaptureFileHeader* m_header = nullptr;
+		Nanos* m_index = nullptr;
+
+	public:
+		/// Creates path with room for capacity rows of columns, its blocks allocated
+		/// up front so a full disk fails here instead of faulting a write later.
+		CaptureFile(const std::string& path, CaptureStream stream, uint32_t day,
+			uint64_t first_seq, uint64_t capacity, const std::vector<CaptureColumnSpec>& columns);
+		~CaptureFile();
+
+		CaptureFile() = delete;
+		CaptureFile(const CaptureFile&) = delete;
+		CaptureFile(const CaptureFile&&) = delete;
+		CaptureFile& operator=(const CaptureFile&) = delete;
+		CaptureFile& operator=(const CaptureFile&&) = delete;
+
+		template<typename T>
+		auto column(size_t column_index) noexcept {
+			return reinterpret_cast<T*>(m_data + m_header->m_columns[column_index].m_offset);
+		}
+
+		/// Publishes the row written at count(), recv_time goes to the time index.
+		auto commit(Nanos recv_time) noexcept {
+			const auto row = m_header->m_count.load(std::memory_order_relaxed);
+			if (row % CaptureIndexStride == 0)
+				m_index[row / CaptureIndexStride] = recv_time;
+			m_header->m_count.store(row + 1, std::memory_order_release);
+		}
+
+		auto count() const noexcept { return m_header->m_count.load(std::memory_order_relaxed); }
+		auto full() const noexcept { return count() == m_header->m_capacity; }
+		auto day() const noexcept { return m_header->m_day; }
+		auto nextSeq() const noexcept { return m_header->m_first_seq + count(); }
+		const auto& path() const noexcept { return m_path; }
+	};
+
+	/// Read-only view of a capture file, which may still be written to.
+	class CaptureReader final {
+		int m_fd = -1;
+		const char* m_data = nullptr;
+		size_t m_size = 0;
+		const CaptureFileHeader* m_header = nullptr;
+		const Nanos* m_index = nullptr;
+
+	public:
+		explicit CaptureReader(const std::string& path);
+		~CaptureReader();
+
+		CaptureReader() = delete;
+		CaptureReader(const CaptureReader&) = delete;
+		CaptureReader(const CaptureReader&&) = delete;
+		CaptureReader& operator=(const CaptureReader&) = delete;
+		CaptureReader& operator=(const CaptureReader&&) = delete;
+
+		const auto& header() const noexcept { return *m_header; }
+		auto count() const noexcept { return m_header->m_count.load(std::memory_order_acquire); }
+		auto firstSeq() const noexcept { return m_header->m_first_seq; }
+
+		/// Index of column name, CaptureMaxColumns if there is none.
+		size_t columnIndex(const std::string& name) const noexcept;
+
+		template<typename T>
+		auto column(size_t column_index) const noexcept {
+			return reinterpret_cast<const T*>(m_data + m_header->m_columns[column_index].m_offset);
+		}
+
+		/// Value of row in column_index widened to 64 bits, for columns of any type.
+		int64_t value(size_t column_index, uint64_t row) const noexcept;
+
+		auto hasSeq(uint64_t seq) const noexcept {
+			return seq >= firstSeq() && seq < firstSeq() + count();
+		}
+		auto rowOfSeq(uint64_t seq) const noexcept { return seq - firstSeq(); }
+		/// Byte offset in the file of capture SeqNum seq in column_index.
+		auto offsetOfSeq(uint64_t seq, size_t column_index) const noexcept {
+			const auto& column = m_header->m_columns[column_index];
+			return column.m_offset + rowOfSeq(seq) * column.m_width;
+		}
+
+		/// A row at or before the first one received at recv_time, to scan forward
+		/// from. Rows are in arrival order, which the index is one block generous to.
+		uint64_t rowNear(Nanos recv_time) const noexcept;
+	};
+
+	/// UTC day of time as YYYYMMDD.
+	uint32_t captureDay(Nanos time) noexcept;
+}
@@ -0,0 +1,229 @@
+#include "trading/capture/market_data_capture.hpp"
+
+#include <cstdio>
+
+#include <unistd.h>
+
+namespace Trading {
+
+	namespace {
+		template<typename T>
+		constexpr CaptureColumnSpec columnOf(const char* name) {
+			return { name, sizeof(T), std::is_signed_v<T> };
+		}
+
+		template<typename T, typename Column>
+		auto& at(CaptureFile* file, Column column, uint64_t row) noexcept {
+			return file->column<T>(static_cast<size_t>(column))[row];
+		}
+	}
+
+	const std::vector<CaptureColumnSpec>& marketUpdateColumns() {
+		static const std::vector<CaptureColumnSpec> columns = {
+			columnOf<Nanos>("RECV_TIME"),
+			columnOf<int8_t>("TYPE"),
+			columnOf<TickerId>("TICKER_ID"),
+			columnOf<int8_t>("SIDE"),
+			columnOf<OrderId>("ORDER_ID"),
+			columnOf<Price>("PRICE"),
+			columnOf<Qty>("QTY"),
+			columnOf<Priority>("PRIORITY")
+		};
+		return columns;
+	}
+
+	const std::vector<CaptureColumnSpec>& clientResponseColumns() {
+		static const std::vector<CaptureColumnSpec> columns = {
+			columnOf<Nanos>("RECV_TIME"),
+			columnOf<int8_t>("TYPE"),
+			columnOf<ClientId>("CLIENT_ID"),
+			columnOf<TickerId>("TICKER_ID"),
+			columnOf<OrderId>("CLIENT_ORDER_ID"),
+			columnOf<OrderId>("MARKET_ORDER_ID"),
+			columnOf<int8_t>("SIDE"),
+			columnOf<Price>("PRICE"),
+			columnOf<Qty>("EXEC_QTY"),
+			columnOf<Qty>("LEAVES_QTY")
+		};
+		return columns;
+	}
+
+	std::string capturePath(const std::string& dir, CaptureStream stream, uint32_t day,
+		uint32_t part) {
+		const auto prefix = (stream == CaptureStream::MARKET_UPDATES) ? "md_" : "resp_";
+		return dir + "/" + prefix + std::to_string(day) + "_" + std::to_string(part) + ".cap";
+	}
+
+	std::vector<std::string> capturePaths(const std::string& dir, CaptureStream stream,
+		uint32_t day) {
+		std::vector<std::string> paths;
+		for (uint32_t part = 0;; ++part) {
+			auto path = capturePath(dir, stream, day, part);
+			if (access(path.c_str(), F_OK) != 0)
+				break;
+			paths.push_back(std::move(path));
+		}
+		return paths;
+	}
+
+	std::string captureDir(const std::string& path) {
+		const auto slash = path.rfind('/');
+		return (slash == std::string::npos) ? "." : path.substr(0, slash);
+	}
+
+	Nanos captureFirstRecvTime(const CaptureReader& capture) noexcept {
+		static_assert(size_t(MarketUpdateColumn::RECV_TIME) ==
+			size_t(ClientResponseColumn::RECV_TIME));
+		return capture.count() ?
+			capture.column<Nanos>(size_t(MarketUpdateColumn::RECV_TIME))[0] :
+			std::numeric_limits<Nanos>::max();
+	}
+
+	MarketDataCapture::MarketDataCapture(const std::string& dir, uint64_t rows_per_file,
+		RecvTimeMarketUpdateLFQueue* market_updates,
+		RecvTimeClientResponseLFQueue* client_responses) :
+		m_dir(dir), m_rows_per_file(rows_per_file), m_incoming_md_updates(market_updates),
+		m_incoming_client_responses(client_responses),
+		m_logger("trading_capture.log") {
+	}
+
+	MarketDataCapture::~MarketDataCapture() {
+		stop();
+		drain();
+
+		m_logger.log("%:% %() % md_rows:% response_rows:% files:%\n", __FILE__, __LINE__,
+			__FUNCTION__, Common::getCurrentTimeStr(&m_time_str), m_num_md_rows.value(),
+			m_num_response_rows.value(), m_num_files.value());
+
+		delete m_md_file; m_md_file = nullptr;
+		delete m_response_file; m_response_file = nullptr;
+
+		m_incoming_md_updates = nullptr;
+		m_incoming_client_responses = nullptr;
+	}
+
+	void MarketDataCapture::start(int core_id) {
+		m_run = true;
+		m_thread = Common::createAndStartThread(core_id, "Trading/MarketDataCapture",
+			[this] { run(); });
+		ASSERT(m_thread != nullptr, "Failed to start MarketDataCapture thread.");
+	}
+
+	void MarketDataCapture::stop() {
+		if (!m_thread)
+			return;
+		m_run = false;
+		m_thread->join();
+		delete m_thread;
+		m_thread = nullptr;
+	}
+
+	void MarketDataCapture::registerMetrics(Common::MetricsRegistry& metrics) {
+		metrics.addCounter("capture.md_rows", &m_num_md_rows);
+		metrics.addCounter("capture.response_rows", &m_num_response_rows);
+		metrics.addCounter("capture.files", &m_num_files);
+		metrics.addGauge("capture.incoming_md_updates",
+			[this]() { return m_incoming_md_updates->size(); });
+		metrics.addGauge("capture.incoming_client_responses",
+			[this]() { return m_incoming_client_responses->size(); });
+	}
+
+	CaptureFile* MarketDataCapture::fileFor(CaptureFile* file, CaptureStream stream,
+		Nanos recv_time, uint32_t* part) {
+		const auto day = captureDay(recv_time);
+		if (file && file->day() == day && !file->full()) [[likely]]
+			return file;
+
+		// Sequence numbers go on across parts and days, a restarted process starts
+		// again from 1 in the next free part.
+		const auto next_seq = file ? file->nextSeq() : 1;
+		*part = (file && file->day() == day) ? *part + 1 : 0;
+		delete file;
+
+		std::string path;
+		for (;; ++*part) {
+			path = capturePath(m_dir, stream, day, *part);
+			if (access(path.c_str(), F_OK) != 0)
+				break;
+		}
+
+		file = new CaptureFile(path, stream, day, next_seq, m_rows_per_file,
+			(stream == CaptureStream::MARKET_UPDATES) ? marketUpdateColumns() :
+			clientResponseColumns());
+		m_num_files.inc();
+		m_logger.log("%:% %() % Opened % stream:% first_seq:% rows:%\n", __FILE__, __LINE__,
+			__FUNCTION__, Common::getCurrentTimeStr(&m_time_str), path,
+			captureStreamToString(stream), next_seq, m_rows_per_file);
+		return file;
+	}
+
+	void MarketDataCapture::write(const RecvTimeMarketUpdate& market_update) {
+		m_md_file = fileFor(m_md_file, CaptureStream::MARKET_UPDATES,
+			market_update.m_recv_time, &m_md_part);
+
+		using Column = MarketUpdateColumn;
+		const auto& update = market_update.m_market_update;
+		const auto row = m_md_file->count();
+		at<Nanos>(m_md_file, Column::RECV_TIME, row) = market_update.m_recv_time;
+		at<int8_t>(m_md_file, Column::TYPE, row) = static_cast<int8_t>(update.m_type);
+		at<TickerId>(m_md_file, Column::TICKER_ID, row) = update.m_ticker_id;
+		at<int8_t>(m_md_file, Column::SIDE, row) = static_cast<int8_t>(update.m_side);
+		at<OrderId>(m_md_file, Column::ORDER_ID, row) = update.m_order_id;
+		at<Price>(m_md_file, Column::PRICE, row) = update.m_price;
+		at<Qty>(m_md_file, Column::QTY, row) = update.m_qty;
+		at<Priority>(m_md_file, Column::PRIORITY, row) = update.m_priority;
+		m_md_file->commit(market_update.m_recv_time);
+		m_num_md_rows.inc();
+	}
+
+	void MarketDataCapture::write(const RecvTimeClientResponse& client_response) {
+		m_response_file = fileFor(m_response_file, CaptureStream::CLIENT_RESPONSES,
+			client_response.m_recv_time, &m_response_part);
+
+		using Column = ClientResponseColumn;
+		const auto& response = client_response.m_client_response;
+		const auto row = m_response_file->count();
+		at<Nanos>(m_response_file, Column::RECV_TIME, row) = client_response.m_recv_time;
+		at<int8_t>(m_response_file, Column::TYPE, row) = static_cast<int8_t>(response.m_type);
+		at<ClientId>(m_response_file, Column::CLIENT_ID, row) = response.m_client_id;
+		at<TickerId>(m_response_file, Column::TICKER_ID, row) = response.m_ticker_id;
+		at<OrderId>(m_response_file, Column::CLIENT_ORDER_ID, row) = response.m_client_order_id;
+		at<OrderId>(m_response_file, Column::MARKET_ORDER_ID, row) = response.m_market_order_id;
+		at<int8_t>(m_response_file, Column::SIDE, row) = static_cast<int8_t>(response.m_side);
+		at<Price>(m_response_file, Column::PRICE, row) = response.m_price;
+		at<Qty>(m_response_file, Column::EXEC_QTY, row) = response.m_exec_qty;
+		at<Qty>(m_response_file, Column::LEAVES_QTY, row) = response.m_leaves_qty;
+		m_response_file->commit(client_response.m_recv_time);
+		m_num_response_rows.inc();
+	}
+
+	size_t MarketDataCapture::drain() noexcept {
+		size_t num_rows = 0;
+		for (auto market_update = m_incoming_md_updates->getNextToRead(); market_update;
+			market_update = m_incoming_md_updates->getNextToRead()) {
+			write(*market_update);
+			m_incoming_md_updates->updateReadIndex();
+			++num_rows;
+		}
+		for (auto client_response = m_incoming_client_responses->getNextToRead();
+			client_response; client_response = m_incoming_client_responses->getNextToRead()) {
+			write(*client_response);
+			m_incoming_client_responses->updateReadIndex();
+			++num_rows;
+		}
+		return num_rows;
+	}
+
+	void MarketDataCapture::run() noexcept {
+		m_logger.log("%:% %() % dir:%\n", __FILE__, __LINE__, __FUNCTION__,
+			Common::getCurrentTimeStr(&m_time_str), m_dir);
+
+		// Off the critical path, yield when idle rather than spin.
+		while (m_run) {
+			if (!drain()) {
+				using namespace std::literals::chrono_literals;
+				std::this_thread::sleep_for(1ms);
+			}
+		}
+	}
+}
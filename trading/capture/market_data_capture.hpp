@@ -0,0 +1,117 @@
+#pragma once
+
+#include "common/thread_utils.hpp"
+#include "common/macros.hpp"
+#include "common/logging.hpp"
+#include "common/metrics.hpp"
+
+#include "trading/market_data/recv_time_market_update.hpp"
+#include "trading/order_gw/recv_time_client_response.hpp"
+
+#include "trading/capture/capture_file.hpp"
+
+namespace Trading {
+
+	/// Rows in one capture file before it rolls over to the next part.
+	constexpr uint64_t CaptureDefaultRows = 16 * 1024 * 1024;
+
+	/// Columns of CaptureStream::MARKET_UPDATES files.
+	enum class MarketUpdateColumn : size_t {
+		RECV_TIME = 0,
+		TYPE = 1,
+		TICKER_ID = 2,
+		SIDE = 3,
+		ORDER_ID = 4,
+		PRICE = 5,
+		QTY = 6,
+		PRIORITY = 7
+	};
+
+	/// Columns of CaptureStream::CLIENT_RESPONSES files.
+	enum class ClientResponseColumn : size_t {
+		RECV_TIME = 0,
+		TYPE = 1,
+		CLIENT_ID = 2,
+		TICKER_ID = 3,
+		CLIENT_ORDER_ID = 4,
+		MARKET_ORDER_ID = 5,
+		SIDE = 6,
+		PRICE = 7,
+		EXEC_QTY = 8,
+		LEAVES_QTY = 9
+	};
+
+	const std::vector<CaptureColumnSpec>& marketUpdateColumns();
+	const std::vector<CaptureColumnSpec>& clientResponseColumns();
+
+	/// Path of part of day's capture of stream under dir, as MarketDataCapture
+	/// names it.
+	std::string capturePath(const std::string& dir, CaptureStream stream, uint32_t day,
+		uint32_t part);
+	/// Paths of the parts of day's capture of stream under dir, in the order they
+	/// were written.
+	std::vector<std::string> capturePaths(const std::string& dir, CaptureStream stream,
+		uint32_t day);
+	/// Directory of the capture at path.
+	std::string captureDir(const std::string& path);
+	/// Receive time of the first row of a capture of either stream, the latest
+	/// time there is if it has none. Orders the parts of a day across restarts,
+	/// which begin SeqNum's from 1 again.
+	Nanos captureFirstRecvTime(const CaptureReader& capture) noexcept;
+
+	/// Records what the TradeEngine consumed, market updates and the client's own
+	/// responses with their receive times, into CaptureFile's under m_dir named
+	/// md_<YYYYMMDD>_<part>.cap and resp_<YYYYMMDD>_<part>.cap. A new part starts
+	/// when the UTC day of the receive time changes or a file is full. Capture
+	/// SeqNum's count every row of a stream from 1 and carry over across parts,
+	/// the exchange's own sequence numbers end at the MarketDataConsumer.
+	class MarketDataCapture final {
+		const std::string m_dir;
+		const uint64_t m_rows_per_file;
+
+		RecvTimeMarketUpdateLFQueue* m_incoming_md_updates = nullptr;
+		RecvTimeClientResponseLFQueue* m_incoming_client_responses = nullptr;
+
+		volatile bool m_run = false;
+		std::thread* m_thread = nullptr;
+
+		std::string m_time_str;
+		Logger m_logger;
+
+		CaptureFile* m_md_file = nullptr;
+		CaptureFile* m_response_file = nullptr;
+		uint32_t m_md_part = 0;
+		uint32_t m_response_part = 0;
+
+		Common::MetricCounter m_num_md_rows;
+		Common::MetricCounter m_num_response_rows;
+		Common::MetricCounter m_num_files;
+
+		/// Returns file, or its successor when row recv_time does not belong in it.
+		CaptureFile* fileFor(CaptureFile* file, CaptureStream stream, Nanos recv_time,
+			uint32_t* part);
+		void write(const RecvTimeMarketUpdate& market_update);
+		void write(const RecvTimeClientResponse& client_response);
+		size_t drain() noexcept;
+		void run() noexcept;
+
+	public:
+		MarketDataCapture(const std::string& dir, uint64_t rows_per_file,
+			RecvTimeMarketUpdateLFQueue* market_updates,
+			RecvTimeClientResponseLFQueue* client_responses);
+		~MarketDataCapture();
+
+		MarketDataCapture() = delete;
+		MarketDataCapture(const MarketDataCapture&) = delete;
+		MarketDataCapture(const MarketDataCapture&&) = delete;
+		MarketDataCapture& operator=(const MarketDataCapture&) = delete;
+		MarketDataCapture& operator=(const MarketDataCapture&&) = delete;
+
+		/// core_id -1 leaves the thread unpinned.
+		void start(int core_id = -1);
+		/// Writes out what is queued and stops the thread.
+		void stop();
+
+		void registerMetrics(Common::MetricsRegistry& metrics);
+	};
+}
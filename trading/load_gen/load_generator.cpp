@@ -0,0 +1,331 @@
+#include "load_generator.hpp"
+
+namespace Trading {
+
+	std::string LoadGeneratorCfg::toString() const {
+		std::stringstream ss;
+		ss << "algo=" << Common::algoTypeToString(Common::AlgoType::RANDOM) <<
+			" sessions=" << m_sessions <<
+			" first_client_id=" << static_cast<size_t>(m_first_client_id) <<
+			" rate=" << m_orders_per_sec <<
+			" seconds=" << m_duration / NANOS_TO_SECS <<
+			" cancel_pct=" << m_cancel_pct <<
+			" max_live=" << m_max_live_orders <<
+			" tickers=" << m_num_tickers <<
+			" price=" << m_base_price << "+/-" << m_price_range;
+		return ss.str();
+	}
+
+	LoadGenerator::Session::Session(ClientId client_id, Logger& logger) :
+		m_client_id(client_id), m_socket(logger), m_orders(LoadGenMaxOrderIds) {
+		m_free_ids.reserve(LoadGenMaxOrderIds);
+		for (auto order_id = LoadGenMaxOrderIds; order_id > 0; --order_id)
+			m_free_ids.push_back(order_id - 1);
+		m_live.reserve(LoadGenMaxOrderIds);
+	}
+
+	LoadGenerator::LoadGenerator(const LoadGeneratorCfg& cfg,
+		RecvTimeMarketUpdateLFQueue* market_updates) :
+		m_cfg(cfg), m_incoming_md_updates(market_updates), m_logger("trading_load_generator.log"),
+		m_rng(cfg.m_seed) {
+		ASSERT(m_cfg.m_sessions && m_cfg.m_first_client_id + m_cfg.m_sessions <= ME_MAX_NUM_CLIENTS,
+			"Sessions must have ClientIds below " + std::to_string(ME_MAX_NUM_CLIENTS));
+		ASSERT(m_cfg.m_num_tickers && m_cfg.m_num_tickers <= ME_MAX_TICKERS,
+			"Invalid number of tickers: " + std::to_string(m_cfg.m_num_tickers));
+		// MEOrderBook indexes its levels by price % ME_MAX_PRICE_LEVELS.
+		ASSERT(2 * m_cfg.m_price_range < static_cast<Price>(ME_MAX_PRICE_LEVELS) &&
+			m_cfg.m_price_range < m_cfg.m_base_price, "Invalid price range: " +
+			std::to_string(m_cfg.m_price_range));
+		ASSERT(m_cfg.m_orders_per_sec > 0, "Rate must be positive.");
+
+		for (size_t i = 0; i < m_cfg.m_sessions; ++i) {
+			auto session = new Session(static_cast<ClientId>(m_cfg.m_first_client_id + i), m_logger);
+			session->m_socket.m_recv_callback = [this, session](auto socket, auto) {
+				recvCallback(session, socket); };
+			m_sessions.push_back(session);
+		}
+	}
+
+	LoadGenerator::~LoadGenerator() {
+		stop();
+		for (auto session : m_sessions)
+			delete session;
+		m_sessions.clear();
+	}
+
+	void LoadGenerator::stop() {
+		m_run = false;
+	}
+
+	void LoadGenerator::run() noexcept {
+		for (auto session : m_sessions) {
+			ASSERT(session->m_socket.connect(m_cfg.m_ip, m_cfg.m_iface, m_cfg.m_port, false) >= 0,
+				"Unable to connect to ip: " + m_cfg.m_ip + " port: " + std::to_string(m_cfg.m_port) +
+				" on iface: " + m_cfg.m_iface + " error: " + std::string(std::strerror(errno)));
+		}
+		m_logger.log("%:% %() % Starting %\n", __FILE__, __LINE__, __FUNCTION__,
+			Common::getCurrentTimeStr(&m_time_str), m_cfg.toString());
+
+		const auto tsc_per_nano = Common::tscPerNano();
+		const auto interval_tsc = tsc_per_nano * NANOS_TO_SECS / m_cfg.m_orders_per_sec;
+		const auto num_requests = static_cast<size_t>(
+			m_cfg.m_orders_per_sec * m_cfg.m_duration / NANOS_TO_SECS);
+		const auto drain_tsc = static_cast<uint64_t>(tsc_per_nano * m_cfg.m_drain_time);
+
+		m_run = true;
+		const auto start_tsc = Common::rdtsc();
+		auto now_tsc = start_tsc;
+		uint64_t done_tsc = 0;
+		while (m_run) {
+			now_tsc = Common::rdtsc();
+			// Everything scheduled by now goes out, however late: the lag is part of
+			// the latency of those requests.
+			for (auto intended_tsc = start_tsc + static_cast<uint64_t>(m_num_scheduled * interval_tsc);
+				m_num_scheduled < num_requests && intended_tsc <= now_tsc;
+				intended_tsc = start_tsc + static_cast<uint64_t>(m_num_scheduled * interval_tsc)) {
+				++m_num_scheduled;
+				sendNext(intended_tsc);
+			}
+
+			for (auto session : m_sessions)
+				session->m_socket.sendAndRecv();
+			drainMarketUpdates();
+
+			if (m_num_scheduled == num_requests) {
+				if (!done_tsc)
+					done_tsc = now_tsc;
+				if (now_tsc - done_tsc > drain_tsc || (!numUnanswered() && m_md_pending.empty()))
+					break;
+			}
+		}
+		m_elapsed_tsc = (done_tsc ? done_tsc : now_tsc) - start_tsc;
+
+		m_logger.log("%:% %() % Done %\n", __FILE__, __LINE__, __FUNCTION__,
+			Common::getCurrentTimeStr(&m_time_str), report());
+	}
+
+	void LoadGenerator::sendNext(uint64_t intended_tsc) noexcept {
+		auto session = m_sessions[m_rng() % m_sessions.size()];
+		auto& live = session->m_live;
+
+		const auto cancel = !live.empty() &&
+			(live.size() >= m_cfg.m_max_live_orders || m_rng() % 100 < m_cfg.m_cancel_pct);
+		if (cancel) {
+			const auto order_id = live[m_rng() % live.size()];
+			auto& order = session->m_orders[order_id];
+			removeLive(session, order_id);
+			order.m_state = OrderState::PENDING_CANCEL;
+			order.m_intended_tsc = intended_tsc;
+			m_md_pending[marketUpdateKey(order.m_ticker_id, order.m_market_order_id)] =
+				{ intended_tsc, true };
+
+			sendRequest(session, { Exchange::ClientRequestType::CANCEL, session->m_client_id,
+				order.m_ticker_id, order_id, order.m_side, order.m_price, 0 });
+			++m_num_cancel;
+		}
+		else {
+			if (session->m_free_ids.empty()) [[unlikely]] {
+				++m_num_skipped;
+				return;
+			}
+			const auto order_id = session->m_free_ids.back();
+			session->m_free_ids.pop_back();
+
+			auto& order = session->m_orders[order_id];
+			order.m_state = OrderState::PENDING_NEW;
+			order.m_ticker_id = static_cast<TickerId>(m_rng() % m_cfg.m_num_tickers);
+			order.m_side = (m_rng() & 1) ? Side::BUY : Side::SELL;
+			order.m_price = m_cfg.m_base_price - m_cfg.m_price_range +
+				static_cast<Price>(m_rng() % (2 * m_cfg.m_price_range + 1));
+			order.m_market_order_id = OrderId_INVALID;
+			order.m_intended_tsc = intended_tsc;
+
+			sendRequest(session, { Exchange::ClientRequestType::NEW, session->m_client_id,
+				order.m_ticker_id, order_id, order.m_side, order.m_price,
+				static_cast<Qty>(1 + m_rng() % 100) });
+			++m_num_new;
+		}
+		m_send_lag.record(Common::rdtsc() - intended_tsc);
+	}
+
+	void LoadGenerator::sendRequest(Session* session,
+		const Exchange::MEClientRequest& request) noexcept {
+		const Exchange::OMClientRequest om_client_request{ session->m_next_outgoing_seq_num++,
+			request };
+		session->m_socket.send(&om_client_request, sizeof(Exchange::OMClientRequest));
+	}
+
+	void LoadGenerator::recvCallback(Session* session, Common::TCPSocket* socket) noexcept {
+		const auto now_tsc = Common::rdtsc();
+		const auto recv_data = socket->m_recv_ring.data();
+		const auto recv_len = socket->m_recv_ring.size();
+		size_t i = 0;
+		for (; i + sizeof(Exchange::OMClientResponse) <= recv_len;
+			i += sizeof(Exchange::OMClientResponse)) {
+			const auto response = reinterpret_cast<const Exchange::OMClientResponse*>(
+				recv_data + i);
+			if (response->m_seq_num != session->m_next_exp_seq_num ||
+				response->m_me_client_response.m_client_id != session->m_client_id) {
+				m_logger.log("%: % %() % ERROR Unexpected response on ClientId: % SeqNum"
+					" expected: % %\n", __FILE__, __LINE__, __FUNCTION__,
+					Common::getCurrentTimeStr(&m_time_str), session->m_client_id,
+					session->m_next_exp_seq_num, response->toString());
+				++m_num_unexpected;
+				continue;
+			}
+			++session->m_next_exp_seq_num;
+			onResponse(session, response->m_me_client_response, now_tsc);
+		}
+		socket->m_recv_ring.consume(i);
+	}
+
+	void LoadGenerator::onResponse(Session* session,
+		const Exchange::MEClientResponse& response, uint64_t now_tsc) noexcept {
+		if (response.m_client_order_id >= LoadGenMaxOrderIds) [[unlikely]] {
+			++m_num_unexpected;
+			return;
+		}
+		const auto order_id = response.m_client_order_id;
+		auto& order = session->m_orders[order_id];
+
+		switch (response.m_type) {
+		case Exchange::ClientResponseType::ACCEPTED: {
+			if (order.m_state != OrderState::PENDING_NEW) {
+				++m_num_unexpected;
+				break;
+			}
+			m_new_to_ack.record(now_tsc - order.m_intended_tsc);
+			order.m_state = OrderState::LIVE;
+			order.m_market_order_id = response.m_market_order_id;
+			order.m_live_index = session->m_live.size();
+			session->m_live.push_back(order_id);
+
+			const auto key = marketUpdateKey(order.m_ticker_id, order.m_market_order_id);
+			const auto early = m_md_early.find(key);
+			if (early != m_md_early.end()) {
+				m_new_to_md.record(early->second - order.m_intended_tsc);
+				m_md_early.erase(early);
+			}
+			else {
+				m_md_pending[key] = { order.m_intended_tsc, false };
+			}
+		}
+			break;
+		case Exchange::ClientResponseType::FILLED:
+			++m_num_fills;
+			if (response.m_leaves_qty)
+				break;
+			// A fully filled order is gone from the book, its ADD may never come and
+			// its CANCEL update is not the answer to a cancel.
+			m_md_pending.erase(marketUpdateKey(order.m_ticker_id, order.m_market_order_id));
+			if (order.m_state == OrderState::LIVE) {
+				removeLive(session, order_id);
+				freeOrder(session, order_id);
+			}
+			else if (order.m_state == OrderState::PENDING_CANCEL) {
+				order.m_state = OrderState::FILLED_PENDING_CANCEL;
+			}
+			else {
+				++m_num_unexpected;
+			}
+			break;
+		case Exchange::ClientResponseType::CANCELED:
+			if (order.m_state != OrderState::PENDING_CANCEL) {
+				++m_num_unexpected;
+				break;
+			}
+			m_cancel_to_ack.record(now_tsc - order.m_intended_tsc);
+			freeOrder(session, order_id);
+			break;
+		case Exchange::ClientResponseType::CANCEL_REJECTED:
+			++m_num_cancel_rejects;
+			if (order.m_state == OrderState::PENDING_CANCEL ||
+				order.m_state == OrderState::FILLED_PENDING_CANCEL) {
+				m_md_pending.erase(marketUpdateKey(order.m_ticker_id, order.m_market_order_id));
+				freeOrder(session, order_id);
+			}
+			break;
+		default:
+			++m_num_unexpected;
+			break;
+		}
+	}
+
+	void LoadGenerator::removeLive(Session* session, OrderId order_id) noexcept {
+		auto& live = session->m_live;
+		const auto index = session->m_orders[order_id].m_live_index;
+		const auto last = live.back();
+		live[index] = last;
+		session->m_orders[last].m_live_index = index;
+		live.pop_back();
+	}
+
+	void LoadGenerator::freeOrder(Session* session, OrderId order_id) noexcept {
+		session->m_orders[order_id].m_state = OrderState::FREE;
+		session->m_free_ids.push_back(order_id);
+	}
+
+	void LoadGenerator::drainMarketUpdates() noexcept {
+		// Bounds m_md_early, which also collects the ADDs of other participants.
+		constexpr size_t MaxEarlyUpdates = 64 * 1024;
+
+		for (auto update = m_incoming_md_updates->getNextToRead(); update;
+			update = m_incoming_md_updates->getNextToRead()) {
+			const auto now_tsc = Common::rdtsc();
+			const auto& market_update = update->m_market_update;
+			const auto is_add = market_update.m_type == Exchange::MarketUpdateType::ADD;
+			if (is_add || market_update.m_type == Exchange::MarketUpdateType::CANCEL) {
+				const auto key = marketUpdateKey(market_update.m_ticker_id,
+					market_update.m_order_id);
+				const auto pending = m_md_pending.find(key);
+				if (pending != m_md_pending.end() && pending->second.m_cancel != is_add) {
+					(is_add ? m_new_to_md : m_cancel_to_md).record(
+						now_tsc - pending->second.m_intended_tsc);
+					m_md_pending.erase(pending);
+				}
+				else if (is_add) {
+					if (m_md_early.size() >= MaxEarlyUpdates) {
+						m_num_md_early_dropped += m_md_early.size();
+						m_md_early.clear();
+					}
+					m_md_early[key] = now_tsc;
+				}
+			}
+			m_incoming_md_updates->updateReadIndex();
+		}
+	}
+
+	size_t LoadGenerator::numUnanswered() const noexcept {
+		size_t num_unanswered = 0;
+		for (const auto session : m_sessions)
+			num_unanswered += LoadGenMaxOrderIds - session->m_free_ids.size() -
+				session->m_live.size();
+		return num_unanswered;
+	}
+
+	std::string LoadGenerator::report() const {
+		const auto tsc_per_nano = Common::tscPerNano();
+		const auto seconds = static_cast<double>(m_elapsed_tsc) / tsc_per_nano / NANOS_TO_SECS;
+
+		std::stringstream ss;
+		ss << "load " << m_cfg.toString() << std::endl <<
+			"requests scheduled=" << m_num_scheduled <<
+			" new=" << m_num_new <<
+			" cancel=" << m_num_cancel <<
+			" skipped=" << m_num_skipped <<
+			" per_sec=" << (seconds > 0 ? static_cast<uint64_t>(m_num_scheduled / seconds) : 0) <<
+			std::endl <<
+			"responses fills=" << m_num_fills <<
+			" cancel_rejects=" << m_num_cancel_rejects <<
+			" unexpected=" << m_num_unexpected <<
+			" unanswered=" << numUnanswered() <<
+			" md_unmatched=" << m_md_pending.size() <<
+			" md_early_dropped=" << m_num_md_early_dropped << std::endl <<
+			"send_lag_ns " << m_send_lag.toString(tsc_per_nano) << std::endl <<
+			"new_to_ack_ns " << m_new_to_ack.toString(tsc_per_nano) << std::endl <<
+			"cancel_to_ack_ns " << m_cancel_to_ack.toString(tsc_per_nano) << std::endl <<
+			"new_to_md_ns " << m_new_to_md.toString(tsc_per_nano) << std::endl <<
+			"cancel_to_md_ns " << m_cancel_to_md.toString(tsc_per_nano) << std::endl;
+		return ss.str();
+	}
+}
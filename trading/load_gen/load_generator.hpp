@@ -0,0 +1,165 @@
+#pragma once
+
+#include <cstring>
+#include <random>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+
+#include "common/macros.hpp"
+#include "common/logging.hpp"
+#include "common/tcp_socket.hpp"
+#include "common/latency_histogram.hpp"
+#include "common/tsc.hpp"
+
+#include "exchange/order_server/client_request.hpp"
+#include "exchange/order_server/client_response.hpp"
+
+#include "trading/market_data/recv_time_market_update.hpp"
+
+namespace Trading {
+
+	/// Client order ids each session cycles through, orders in flight or live.
+	constexpr size_t LoadGenMaxOrderIds = 64 * 1024;
+
+	struct LoadGeneratorCfg {
+		size_t m_sessions = 4;
+		ClientId m_first_client_id = 100;
+		/// Requests a second over all sessions, sent on a fixed schedule.
+		double m_orders_per_sec = 10 * 1000;
+		Nanos m_duration = 10 * NANOS_TO_SECS;
+		/// Share of requests in percent that cancel one of the session's live orders.
+		size_t m_cancel_pct = 40;
+		/// Live orders a session may have, more are cancelled first.
+		size_t m_max_live_orders = 1000;
+		size_t m_num_tickers = ME_MAX_TICKERS;
+		/// Prices are drawn from m_base_price +/- m_price_range for either side, so
+		/// some orders cross.
+		Price m_base_price = 1000;
+		Price m_price_range = 10;
+		uint64_t m_seed = 42;
+
+		std::string m_ip = "127.0.0.1";
+		std::string m_iface = "lo";
+		int m_port = 12345;
+		/// Time to wait for responses and market data after the last request.
+		Nanos m_drain_time = 2 * NANOS_TO_SECS;
+
+		std::string toString() const;
+	};
+
+	/// Implements AlgoType::RANDOM: puts open-loop NEW/CANCEL flow on the exchange
+	/// over m_sessions OrderGateway-style TCP sessions, one ClientId each, and
+	/// times every request against the time it was scheduled to go out, so a
+	/// stalled exchange or a late generator shows up in the percentiles instead of
+	/// slowing the flow down. Market updates come from a MarketDataConsumer the
+	/// caller runs on market_updates.
+	class LoadGenerator final {
+
+		enum class OrderState : uint8_t {
+			FREE = 0,
+			PENDING_NEW = 1,
+			LIVE = 2,
+			PENDING_CANCEL = 3,
+			/// Filled while its cancel was in flight, waits for CANCEL_REJECTED.
+			FILLED_PENDING_CANCEL = 4
+		};
+
+		struct SessionOrder {
+			OrderState m_state = OrderState::FREE;
+			TickerId m_ticker_id = TickerId_INVALID;
+			Side m_side = Side::INVALID;
+			Price m_price = Price_INVALID;
+			OrderId m_market_order_id = OrderId_INVALID;
+			/// Scheduled send time of the last request for this order.
+			uint64_t m_intended_tsc = 0;
+			size_t m_live_index = 0;
+		};
+
+		struct Session {
+			ClientId m_client_id = ClientId_INVALID;
+			Common::TCPSocket m_socket;
+			size_t m_next_outgoing_seq_num = 1;
+			size_t m_next_exp_seq_num = 1;
+
+			std::vector<SessionOrder> m_orders;
+			std::vector<OrderId> m_free_ids;
+			std::vector<OrderId> m_live;
+
+			Session(ClientId client_id, Logger& logger);
+		};
+
+		/// A request waiting for its ADD or CANCEL market update.
+		struct PendingMarketUpdate {
+			uint64_t m_intended_tsc = 0;
+			bool m_cancel = false;
+		};
+
+		const LoadGeneratorCfg m_cfg;
+
+		RecvTimeMarketUpdateLFQueue* m_incoming_md_updates = nullptr;
+
+		volatile bool m_run = false;
+
+		std::string m_time_str;
+		Logger m_logger;
+
+		std::vector<Session*> m_sessions;
+		std::mt19937_64 m_rng;
+
+		/// Keyed by marketUpdateKey().
+		std::unordered_map<uint64_t, PendingMarketUpdate> m_md_pending;
+		/// ADD updates that beat the ACCEPTED of their order, with their arrival.
+		std::unordered_map<uint64_t, uint64_t> m_md_early;
+
+		/// All in TSC ticks from the scheduled send time.
+		Common::LatencyHistogram m_send_lag;
+		Common::LatencyHistogram m_new_to_ack;
+		Common::LatencyHistogram m_cancel_to_ack;
+		Common::LatencyHistogram m_new_to_md;
+		Common::LatencyHistogram m_cancel_to_md;
+
+		size_t m_num_scheduled = 0;
+		size_t m_num_new = 0;
+		size_t m_num_cancel = 0;
+		/// Scheduled requests dropped for lack of a free client order id.
+		size_t m_num_skipped = 0;
+		size_t m_num_fills = 0;
+		size_t m_num_cancel_rejects = 0;
+		size_t m_num_unexpected = 0;
+		size_t m_num_md_early_dropped = 0;
+		uint64_t m_elapsed_tsc = 0;
+
+		static auto marketUpdateKey(TickerId ticker_id, OrderId market_order_id) noexcept {
+			return (static_cast<uint64_t>(ticker_id) << 56) | market_order_id;
+		}
+
+		void sendNext(uint64_t intended_tsc) noexcept;
+		void sendRequest(Session* session, const Exchange::MEClientRequest& request) noexcept;
+		void recvCallback(Session* session, Common::TCPSocket* socket) noexcept;
+		void onResponse(Session* session, const Exchange::MEClientResponse& response,
+			uint64_t now_tsc) noexcept;
+		void removeLive(Session* session, OrderId order_id) noexcept;
+		void freeOrder(Session* session, OrderId order_id) noexcept;
+		void drainMarketUpdates() noexcept;
+		size_t numUnanswered() const noexcept;
+
+	public:
+		LoadGenerator(const LoadGeneratorCfg& cfg, RecvTimeMarketUpdateLFQueue* market_updates);
+		~LoadGenerator();
+
+		LoadGenerator() = delete;
+		LoadGenerator(const LoadGenerator&) = delete;
+		LoadGenerator(const LoadGenerator&&) = delete;
+		LoadGenerator& operator=(const LoadGenerator&) = delete;
+		LoadGenerator& operator=(const LoadGenerator&&) = delete;
+
+		/// Connects every session, then sends m_duration worth of flow and waits
+		/// m_drain_time for the rest of the answers, on the calling thread.
+		void run() noexcept;
+		void stop();
+
+		/// Counters and latency percentiles in ns, a line of key=value pairs per group.
+		std::string report() const;
+	};
+}
@@ -0,0 +1,74 @@
+#include <csignal>
+
+#include "trading/market_data/market_data_consumer.hpp"
+#include "trading/load_gen/load_generator.hpp"
+
+// Capacity test of exchange_main: random NEW/CANCEL flow from many sessions at a
+// fixed rate, see Trading::LoadGenerator. Prints its report when done.
+//
+// Usage: load_generator [sessions=N] [rate=N] [seconds=N] [cancel_pct=N]
+//   [max_live=N] [tickers=N] [first_client_id=N] [seed=N] [channels=N] [core=N]
+// channels= must match the market data channels of exchange_main.
+
+Trading::LoadGenerator* load_generator = nullptr;
+
+void signal_handler(int) {
+	if (load_generator)
+		load_generator->stop();
+}
+
+int main(int argc, char** argv) {
+	Trading::LoadGeneratorCfg cfg;
+	size_t num_channels = 1;
+	int core_id = -1;
+	for (int i = 1; i < argc; ++i) {
+		const std::string arg = argv[i];
+		const auto equals = arg.find('=');
+		ASSERT(equals != std::string::npos, "Expected key=value, got " + arg);
+		const auto key = arg.substr(0, equals);
+		const auto value = arg.substr(equals + 1);
+		if (key == "sessions")
+			cfg.m_sessions = std::stoul(value);
+		else if (key == "rate")
+			cfg.m_orders_per_sec = std::stod(value);
+		else if (key == "seconds")
+			cfg.m_duration = static_cast<Nanos>(std::stod(value) * NANOS_TO_SECS);
+		else if (key == "cancel_pct")
+			cfg.m_cancel_pct = std::stoul(value);
+		else if (key == "max_live")
+			cfg.m_max_live_orders = std::stoul(value);
+		else if (key == "tickers")
+			cfg.m_num_tickers = std::stoul(value);
+		else if (key == "first_client_id")
+			cfg.m_first_client_id = static_cast<ClientId>(std::stoul(value));
+		else if (key == "seed")
+			cfg.m_seed = std::stoull(value);
+		else if (key == "channels")
+			num_channels = std::stoul(value);
+		else if (key == "core")
+			core_id = std::stoi(value);
+		else
+			FATAL("Unknown argument " + arg);
+	}
+
+	std::signal(SIGINT, signal_handler);
+
+	std::vector<Common::TickerId> tickers;
+	for (size_t ticker_id = 0; ticker_id < cfg.m_num_tickers; ++ticker_id)
+		tickers.push_back(static_cast<Common::TickerId>(ticker_id));
+
+	Trading::RecvTimeMarketUpdateLFQueue market_updates(ME_MAX_MARKET_UPDATES);
+	auto market_data_consumer = new Trading::MarketDataConsumer(cfg.m_first_client_id,
+		&market_updates, cfg.m_iface, Exchange::makeMarketDataChannelCfgs(num_channels), tickers);
+	market_data_consumer->start();
+
+	if (core_id >= 0)
+		ASSERT(Common::setThreadCore(core_id), "Failed to pin to core " + std::to_string(core_id));
+	load_generator = new Trading::LoadGenerator(cfg, &market_updates);
+	load_generator->run();
+	std::cout << load_generator->report();
+
+	delete load_generator; load_generator = nullptr;
+	delete market_data_consumer; market_data_consumer = nullptr;
+	return 0;
+}
@@ -1,30 +1,62 @@
 #include "market_data_consumer.hpp"
 
+#include <algorithm>
+
 
 namespace Trading {
 
 	MarketDataConsumer::MarketDataConsumer(Common::ClientId client_id,
-		Exchange::MEMarketUpdateLFQueue* market_updates, const std::string& iface,
-		const std::string& snapshot_ip, int snapshot_port,
-		const std::string& incremental_ip, int incremental_port) :
+		RecvTimeMarketUpdateLFQueue* market_updates, const std::string& iface,
+		const Exchange::MarketDataChannelCfgs& channels,
+		const std::vector<Common::TickerId>& tickers, const std::string& retransmit_ip,
+		int retransmit_port) :
 		m_incoming_md_updates(market_updates), m_run(false), m_logger(
 			"trading_market_data_consumer_" + std::to_string(client_id) + ".log"),
-		m_incremental_mcast_socket(m_logger), m_snapshot_mcast_socket(m_logger),
-		m_iface(iface), m_snapshot_ip(snapshot_ip), m_snapshot_port(snapshot_port) {
-
-		auto recv_callback = [this](auto socket) { recvCallback(socket); };
-
-		m_incremental_mcast_socket.m_recv_callback = recv_callback;
-		ASSERT(m_incremental_mcast_socket.init(
-			incremental_ip, iface, incremental_port, /*is_listening*/ true) >= 0,
-			"Unable to create incremental mcast socket. error:" +
-			std::string(std::strerror(errno)));
+		m_iface(iface), m_retransmit_socket(m_logger) {
+		m_ticker_subscribed.fill(tickers.empty());
+		for (const auto ticker_id : tickers)
+			m_ticker_subscribed.at(ticker_id) = true;
+
+		for (const auto& cfg : channels) {
+			if (std::none_of(cfg.m_tickers.begin(), cfg.m_tickers.end(),
+				[this](auto ticker_id) { return m_ticker_subscribed.at(ticker_id); }))
+				continue;
 
-		ASSERT(m_incremental_mcast_socket.join(incremental_ip), "Join failed on: " +
-			std::to_string(m_incremental_mcast_socket.m_socket_fd) + " error: " +
-			std::string(std::strerror(errno)));
+			auto channel = new Channel(cfg, m_logger, m_incoming_md_updates,
+				&m_ticker_subscribed);
+			auto recv_callback = [this, channel](auto socket) {
+				recvCallback(channel, socket); };
+
+			auto join_line = [&](Line& line, const std::string& ip, int port) {
+				line.m_socket.m_recv_callback = recv_callback;
+				ASSERT(line.m_socket.init(ip, iface, port, /*is_listening*/ true) >= 0,
+					"Unable to create incremental mcast socket. error:" +
+					std::string(std::strerror(errno)));
+
+				ASSERT(line.m_socket.join(ip), "Join failed on: " +
+					std::to_string(line.m_socket.m_socket_fd) + " error: " +
+					std::string(std::strerror(errno)));
+			};
+			join_line(channel->m_line_a, cfg.m_incremental_ip, cfg.m_incremental_port);
+			if (cfg.hasLineB())
+				join_line(channel->m_line_b, cfg.m_incremental_b_ip, cfg.m_incremental_b_port);
+
+			channel->m_snapshot_mcast_socket.m_recv_callback = recv_callback;
+
+			m_logger.log("%: % %() % Subscribed to %\n", __FILE__, __LINE__, __FUNCTION__,
+				Common::getCurrentTimeStr(&m_time_str), cfg.toString());
+			m_channels.push_back(channel);
+		}
 
-		m_snapshot_mcast_socket.m_recv_callback = recv_callback;
+		if (retransmit_port >= 0) {
+			m_retransmit_socket.m_recv_callback = [this](auto socket, auto rx_time) {
+				retransmitCallback(socket, rx_time); };
+			if (m_retransmit_socket.connect(retransmit_ip, iface, retransmit_port, false) < 0)
+				m_logger.log("%: % %() % Unable to connect to retransmission server %:%"
+					" error: %, recovering from snapshots only.\n", __FILE__, __LINE__,
+					__FUNCTION__, Common::getCurrentTimeStr(&m_time_str), retransmit_ip,
+					retransmit_port, std::strerror(errno));
+		}
 	}
 
 	MarketDataConsumer::~MarketDataConsumer() {
@@ -32,12 +64,18 @@ namespace Trading {
 
 		using namespace std::literals::chrono_literals;
 		std::this_thread::sleep_for(5s);
+
+		for (auto channel : m_channels) {
+			logLineStats(channel);
+			delete channel;
+		}
+		m_channels.clear();
 	}
 
-	void MarketDataConsumer::start() {
+	void MarketDataConsumer::start(int core_id) {
 		m_run = true;
 
-		ASSERT(Common::createAndStartThread(-1, "Trading/MarketDataConsumer",
+		ASSERT(Common::createAndStartThread(core_id, "Trading/MarketDataConsumer",
 			[this]() { run(); }) != nullptr, "Failed to start MarketData thread.");
 	}
 	void MarketDataConsumer::stop() {
@@ -49,210 +87,372 @@ namespace Trading {
 			Common::getCurrentTimeStr(&m_time_str));
 
 		while (m_run) {
-			m_incremental_mcast_socket.sendAndRecv();
-			m_snapshot_mcast_socket.sendAndRecv();
+			for (auto channel : m_channels) {
+				channel->m_line_a.m_socket.sendAndRecv();
+				if (channel->m_cfg.hasLineB())
+					channel->m_line_b.m_socket.sendAndRecv();
+				if (channel->m_snapshot_mcast_socket.m_socket_fd != -1)
+					channel->m_snapshot_mcast_socket.sendAndRecv();
+
+				if (!channel->m_in_recovery && !channel->m_recovery.incrementals().empty() &&
+					Common::getCurrentNanos() - channel->m_gap_time >
+					MDLineArbitrationTimeout) [[unlikely]] {
+					m_logger.log("%: % %() % Gap at SeqNum % on channel % not filled by"
+						" the other line in time.\n", __FILE__, __LINE__, __FUNCTION__,
+						Common::getCurrentTimeStr(&m_time_str),
+						channel->m_next_exp_inc_seq_num, channel->m_cfg.m_channel_id);
+					startRecovery(channel);
+				}
+			}
+
+			if (m_retransmit_socket.m_fd != -1) {
+				m_retransmit_socket.sendAndRecv();
+				if (m_retransmit_socket.m_send_disconnected ||
+					m_retransmit_socket.m_recv_disconnected) [[unlikely]]
+					stopRetransmit();
+			}
 		}
 	}
 
-	void MarketDataConsumer::recvCallback(Common::McastSocket* socket) noexcept {
-		const auto is_snapshot = (socket->m_socket_fd == m_snapshot_mcast_socket.m_socket_fd);
+	size_t MarketDataConsumer::forwardQueued(Channel* channel) noexcept {
+		auto& next_exp_inc_seq_num = channel->m_next_exp_inc_seq_num;
+		const auto begin_seq_num = next_exp_inc_seq_num;
+
+		next_exp_inc_seq_num = channel->m_recovery.forwardIncrementals(next_exp_inc_seq_num);
+		return next_exp_inc_seq_num - begin_seq_num;
+	}
+
+	bool MarketDataConsumer::queueIncremental(Channel* channel, size_t seq_num,
+		const RecvTimeMarketUpdate& market_update) {
+		auto& incrementals = channel->m_recovery.incrementals();
+		if (incrementals.insert(seq_num, market_update))
+			return true;
+
+		// Too far past the gap for the window, the oldest updates make room and
+		// only a snapshot can bridge what they leave out.
+		m_logger.log("%: % %() % Recovery window of channel % full at SeqNum %,"
+			" recovering from snapshot.\n", __FILE__, __LINE__, __FUNCTION__,
+			Common::getCurrentTimeStr(&m_time_str), channel->m_cfg.m_channel_id, seq_num);
+		incrementals.advance(seq_num + 1 - incrementals.capacity());
+		incrementals.insert(seq_num, market_update);
+
+		if (!channel->m_in_recovery || channel->m_retransmit_pending) {
+			channel->m_in_recovery = true;
+			channel->m_retransmit_pending = false;
+			startSnapshotSync(channel);
+		}
+		return false;
+	}
+
+	void MarketDataConsumer::logLineStats(const Channel* channel) {
+		m_logger.log("%: % %() % channel:% A:% B:%\n", __FILE__, __LINE__, __FUNCTION__,
+			Common::getCurrentTimeStr(&m_time_str), channel->m_cfg.m_channel_id,
+			channel->m_line_a.m_stats.toString(), channel->m_line_b.m_stats.toString());
+	}
+
+	void MarketDataConsumer::recvCallback(Channel* channel,
+		Common::McastSocket* socket) noexcept {
+		const auto is_snapshot = (socket == &channel->m_snapshot_mcast_socket);
+		auto line = (socket == &channel->m_line_b.m_socket) ?
+			&channel->m_line_b : &channel->m_line_a;
+		auto& next_exp_inc_seq_num = channel->m_next_exp_inc_seq_num;
+		auto& in_recovery = channel->m_in_recovery;
+		auto& incrementals = channel->m_recovery.incrementals();
 
-		if (is_snapshot && !m_in_recovery) [[unlikely]] {
-			socket->m_next_recv_valid_index = 0;
+		if (is_snapshot && !in_recovery) [[unlikely]] {
 			m_logger.log("%: % %() % WARN Not expecting snapshot messages.\n", __FILE__,
 				__LINE__, __FUNCTION__, Common::getCurrentTimeStr(&m_time_str));
 
 			return;
 		}
 
-		if (socket->m_next_recv_valid_index >= sizeof(Exchange::MDPMarketUpdate)) {
-			size_t i = 0;
-			for (; i + sizeof(Exchange::MDPMarketUpdate) <= socket->m_next_recv_valid_index;
-				i += sizeof(Exchange::MDPMarketUpdate)) {
-				auto request = reinterpret_cast<const Exchange::MDPMarketUpdate*>(
-					socket->m_inbound_data.data() + i);
+		for (size_t packet = 0; packet < socket->numInboundPackets(); ++packet) {
+			const auto packet_data = socket->inboundPacket(packet);
+			const auto packet_len = socket->inboundPacketSize(packet);
+			const auto header = reinterpret_cast<const Exchange::MDPPacketHeader*>(packet_data);
+
+			if (packet_len < sizeof(Exchange::MDPPacketHeader) ||
+				packet_len != sizeof(Exchange::MDPPacketHeader) +
+				header->m_msg_count * sizeof(Exchange::MDPMarketUpdate)) [[unlikely]] {
+				m_logger.log("%: % %() % Dropping malformed % packet of len: %\n", __FILE__,
+					__LINE__, __FUNCTION__, Common::getCurrentTimeStr(&m_time_str),
+					(is_snapshot ? "snapshot" : "incremental"), packet_len);
+				continue;
+			}
+
+			m_logger.log("%: % %() % Received channel:% % % rx: %\n", __FILE__, __LINE__,
+				__FUNCTION__, Common::getCurrentTimeStr(&m_time_str), channel->m_cfg.m_channel_id,
+				(is_snapshot ? "snapshot" : (line == &channel->m_line_a ? "incremental A" :
+				"incremental B")), header->toString(), socket->inboundPacketTime(packet));
+
+			if (!is_snapshot) {
+				auto& stats = line->m_stats;
+				const auto latency = socket->inboundPacketTime(packet) - header->m_send_time;
+				stats.m_packets++;
+				stats.m_latency_sum += latency;
+				stats.m_latency_max = std::max(stats.m_latency_max, latency);
+
+				if (header->m_packet_seq_num != line->m_next_exp_packet_seq_num) [[unlikely]] {
+					m_logger.log("%: % %() % Packet drops on incremental socket of channel %."
+						" PacketSeqNum expected: % received: %\n", __FILE__, __LINE__,
+						__FUNCTION__, Common::getCurrentTimeStr(&m_time_str),
+						channel->m_cfg.m_channel_id, line->m_next_exp_packet_seq_num,
+						header->m_packet_seq_num);
+					if (header->m_packet_seq_num > line->m_next_exp_packet_seq_num)
+						stats.m_packet_gaps += header->m_packet_seq_num -
+							line->m_next_exp_packet_seq_num;
+					// Every packet carries updates, the SeqNum checks below see the
+					// same gap and know which range is missing.
+				}
+				line->m_next_exp_packet_seq_num = header->m_packet_seq_num + 1;
+			}
+
+			const auto rx_time = socket->inboundPacketTime(packet);
+			const auto updates = reinterpret_cast<const Exchange::MDPMarketUpdate*>(
+				packet_data + sizeof(Exchange::MDPPacketHeader));
+			for (size_t i = 0; i < header->m_msg_count; ++i) {
+				auto request = &updates[i];
+				const RecvTimeMarketUpdate market_update{ rx_time, request->m_me_market_update };
+				if (!is_snapshot) {
+					Common::trace(Common::TraceHop::MD_DECODE, rx_time);
+					m_num_updates.inc();
+				}
 				m_logger.log("%: % %() % Received % socket len: % %\n", __FILE__, __LINE__,
 					__FUNCTION__, Common::getCurrentTimeStr(&m_time_str),
 					(is_snapshot ? "snapshot" : "incremental"),
 					sizeof(Exchange::MDPMarketUpdate), request->toString());
 
-				const bool already_in_recovery = m_in_recovery;
-				m_in_recovery = already_in_recovery ||
-					(request->m_seq_num != m_next_exp_inc_seq_num);
+				if (!is_snapshot)
+					line->m_last_seq_num = std::max(line->m_last_seq_num, request->m_seq_num);
 
-				if (m_in_recovery) [[unlikely]] {
-					if (!already_in_recovery) [[unlikely]] {
-						m_logger.log("%: % %() % Packet drops on % socket."
-							" SeqNum expected: % received: %\n", __FILE__, __LINE__,
-							__FUNCTION__, Common::getCurrentTimeStr(&m_time_str),
-							(is_snapshot ? "snapshot" : "incremental"),
-							m_next_exp_inc_seq_num, request->m_seq_num);
-						startSnapshotSync();
-					}
-					queueMessage(is_snapshot, request);
+				// A snapshot completed earlier in the batch ends recovery, the rest
+				// of its messages are not incrementals.
+				if (is_snapshot || in_recovery) [[unlikely]] {
+					if (in_recovery)
+						queueMessage(channel, is_snapshot, request->m_seq_num, market_update);
+					continue;
+				}
+
+				if (request->m_seq_num < next_exp_inc_seq_num) {
+					line->m_stats.m_duplicates++;
 				}
-				else if (!is_snapshot) {
+				else if (request->m_seq_num == next_exp_inc_seq_num) {
 					m_logger.log("%: % %() % %\n", __FILE__, __LINE__, __FUNCTION__,
 						Common::getCurrentTimeStr(&m_time_str), request->toString());
-					m_next_exp_inc_seq_num++;
+					line->m_stats.m_first++;
+					next_exp_inc_seq_num++;
+
+					channel->m_recovery.forward(market_update);
+					if (!incrementals.empty()) [[unlikely]] {
+						// The other line filled the gap this one is waiting behind.
+						forwardQueued(channel);
+						channel->m_gap_time = Common::getCurrentNanos();
+					}
+				}
+				else [[unlikely]] {
+					if (incrementals.empty()) {
+						channel->m_gap_time = Common::getCurrentNanos();
+						incrementals.advance(next_exp_inc_seq_num);
+					}
+					if (incrementals.contains(request->m_seq_num)) {
+						line->m_stats.m_duplicates++;
+						continue;
+					}
+					line->m_stats.m_first++;
 
-					auto next_write = m_incoming_md_updates->getNextToWriteTo();
-					*next_write = std::move(request->m_me_market_update);
-					m_incoming_md_updates->updateWriteIndex();
+					if (queueIncremental(channel, request->m_seq_num, market_update) &&
+						channel->linesMissed()) {
+						m_logger.log("%: % %() % Packet drops on all lines of channel %."
+							" SeqNum expected: % received: %\n", __FILE__, __LINE__,
+							__FUNCTION__, Common::getCurrentTimeStr(&m_time_str),
+							channel->m_cfg.m_channel_id, next_exp_inc_seq_num,
+							request->m_seq_num);
+						startRecovery(channel);
+					}
 				}
 			}
-			memcpy(socket->m_inbound_data.data(), socket->m_inbound_data.data() + i,
-				socket->m_next_recv_valid_index - i);
-			socket->m_next_recv_valid_index -= i;
 		}
+	}
 
+	void MarketDataConsumer::registerMetrics(Common::MetricsRegistry& metrics) {
+		metrics.addCounter("mdc.updates", &m_num_updates);
+		metrics.addCounter("mdc.gaps", &m_num_gaps);
+		metrics.addCounter("mdc.retransmit_recoveries", &m_num_retransmit_recoveries);
+		metrics.addCounter("mdc.snapshot_recoveries", &m_num_snapshot_recoveries);
+		metrics.addGauge("mdc.incoming_md_updates",
+			[this]() { return m_incoming_md_updates->size(); });
 	}
 
-	void MarketDataConsumer::startSnapshotSync() {
-		m_snapshot_queued_msgs.clear();
-		m_incremental_queued_msgs.clear();
+	void MarketDataConsumer::startRecovery(Channel* channel) {
+		m_num_gaps.inc();
+		logLineStats(channel);
+		channel->m_in_recovery = true;
+		channel->m_recovery.clearSnapshot();
+
+		const auto& incrementals = channel->m_recovery.incrementals();
+		if (m_retransmit_socket.m_fd != -1 && !incrementals.empty())
+			requestRetransmit(channel, channel->m_next_exp_inc_seq_num,
+				incrementals.nextPresent(channel->m_next_exp_inc_seq_num));
+		else
+			startSnapshotSync(channel);
+	}
 
-		ASSERT(m_incremental_mcast_socket.init(
-			m_snapshot_ip, m_iface, m_snapshot_port, /*is_listening*/ true) >= 0,
-			"Unable to create snapshot mcast socket. error:" +
-			std::string(std::strerror(errno)));
+	void MarketDataConsumer::requestRetransmit(Channel* channel, size_t begin_seq_num,
+		size_t end_seq_num) {
+		const Exchange::MDPRetransmitRequest request{ channel->m_cfg.m_channel_id,
+			begin_seq_num, end_seq_num };
+		m_logger.log("%: % %() % %\n", __FILE__, __LINE__, __FUNCTION__,
+			Common::getCurrentTimeStr(&m_time_str), request.toString());
 
-		ASSERT(m_incremental_mcast_socket.join(m_snapshot_ip), "Join failed on: " +
-			std::to_string(m_incremental_mcast_socket.m_socket_fd) + " error: " +
-			std::string(std::strerror(errno)));
+		m_retransmit_socket.send(&request, sizeof(request));
+		channel->m_retransmit_pending = true;
 	}
 
-	void MarketDataConsumer::queueMessage(bool is_snapshot,
-		const Exchange::MDPMarketUpdate* request) {
-		if (is_snapshot) {
-			if (m_snapshot_queued_msgs.find(request->m_seq_num) !=
-				m_snapshot_queued_msgs.end()) {
-				m_logger.log("%: % %() % Packet drops on snapshot socket."
-					"Received for a 2nd time : % \n", __FILE__, __LINE__, __FUNCTION__,
-					Common::getCurrentTimeStr(&m_time_str), request->toString());
-				m_snapshot_queued_msgs.clear();
-			}
-			m_snapshot_queued_msgs[request->m_seq_num] = request->m_me_market_update;
-		}
-		else {
-			m_incremental_queued_msgs[request->m_seq_num] = request->m_me_market_update;
-		}
-		m_logger.log("%: % %() % size snapshot: % incremental: % % => % \n", __FILE__,
-			__LINE__, __FUNCTION__, Common::getCurrentTimeStr(&m_time_str),
-			m_snapshot_queued_msgs.size(), m_incremental_queued_msgs.size(),
-			request->m_seq_num, request->toString());
-		checkSnapshotSync();
-	}
+	void MarketDataConsumer::retransmitCallback(Common::TCPSocket* socket,
+		Nanos rx_time) noexcept {
+		const auto recv_data = socket->m_recv_ring.data();
+		const auto recv_len = socket->m_recv_ring.size();
+		size_t i = 0;
+		while (i + sizeof(Exchange::MDPRetransmitResponse) <= recv_len) {
+			const auto response = reinterpret_cast<const Exchange::MDPRetransmitResponse*>(
+				recv_data + i);
+			const auto len = sizeof(Exchange::MDPRetransmitResponse) +
+				response->m_msg_count * sizeof(Exchange::MDPMarketUpdate);
+			if (i + len > recv_len)
+				break;
+			i += len;
 
-	void MarketDataConsumer::checkSnapshotSync() {
-		if (m_snapshot_queued_msgs.empty()) {
-			return;
-		}
+			m_logger.log("%: % %() % Received rx: % %\n", __FILE__, __LINE__, __FUNCTION__,
+				Common::getCurrentTimeStr(&m_time_str), rx_time, response->toString());
 
-		const auto& first_snapshot_msg = m_snapshot_queued_msgs.begin()->second;
-		if (first_snapshot_msg.m_type != Exchange::MarketUpdateType::SNAPSHOT_START) {
-			m_logger.log("%: % %() % Returning because have not seen a"
-				" SNAPSHOT_START yet.\n", __FILE__, __LINE__, __FUNCTION__,
-				Common::getCurrentTimeStr(&m_time_str));
-			m_snapshot_queued_msgs.clear();
-			return;
-		}
+			auto channel_itr = std::find_if(m_channels.begin(), m_channels.end(),
+				[response](auto channel) {
+					return channel->m_cfg.m_channel_id == response->m_channel_id; });
+			if (channel_itr == m_channels.end() || !(*channel_itr)->m_retransmit_pending)
+				continue;
+			auto channel = *channel_itr;
+			channel->m_retransmit_pending = false;
 
-		std::vector<Exchange::MEMarketUpdate> final_events;
-		auto have_complete_snapshot = true;
-		size_t next_snapshot_seq = 0;
-		for (auto& snapshot_itr : m_snapshot_queued_msgs) {
-			m_logger.log("%: % %() % % => %\n", __FILE__, __LINE__, __FUNCTION__,
-				Common::getCurrentTimeStr(&m_time_str), snapshot_itr.first,
-				snapshot_itr.second.toString());
-
-			if (snapshot_itr.first != next_snapshot_seq) {
-				have_complete_snapshot = false;
-				m_logger.log("%: % %() % Detected gap in snapshot stream expected:"
-					" % found: % %.\n", __FILE__, __LINE__, __FUNCTION__,
-					Common::getCurrentTimeStr(&m_time_str), next_snapshot_seq,
-					snapshot_itr.first, snapshot_itr.second.toString());
-				break;
+			if (response->m_status != Exchange::MDPRetransmitStatus::ACCEPTED) {
+				startSnapshotSync(channel);
+				continue;
 			}
 
-			if (snapshot_itr.second.m_type != Exchange::MarketUpdateType::SNAPSHOT_START &&
-				snapshot_itr.second.m_type != Exchange::MarketUpdateType::SNAPSHOT_END) {
-				final_events.push_back(snapshot_itr.second);
+			const auto updates = reinterpret_cast<const Exchange::MDPMarketUpdate*>(
+				response + 1);
+			auto fits = true;
+			for (size_t j = 0; j < response->m_msg_count; ++j) {
+				fits &= queueIncremental(channel, updates[j].m_seq_num,
+					{ rx_time, updates[j].m_me_market_update });
 			}
-			next_snapshot_seq++;
+			if (fits)
+				checkGapFill(channel);
 		}
+		socket->m_recv_ring.consume(i);
+	}
 
-		if (!have_complete_snapshot) {
-			m_logger.log("%: % %() % Returning because found gaps in snapshot stream.\n",
-				__FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&m_time_str));
-			m_snapshot_queued_msgs.clear();
-			return;
-		}
+	void MarketDataConsumer::checkGapFill(Channel* channel) {
+		const auto& incrementals = channel->m_recovery.incrementals();
+		const auto num_incrementals = forwardQueued(channel);
 
-		const auto& last_snapshot_msg = m_snapshot_queued_msgs.rbegin()->second;
-		if (last_snapshot_msg.m_type != Exchange::MarketUpdateType::SNAPSHOT_END) {
-			m_logger.log("%: % %() % Returning because have not seen a SNAPSHOT_END yet.\n",
-				__FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&m_time_str));
+		if (!incrementals.empty()) {
+			// A partial answer, or more drops while waiting for this one.
+			requestRetransmit(channel, channel->m_next_exp_inc_seq_num,
+				incrementals.nextPresent(channel->m_next_exp_inc_seq_num));
 			return;
 		}
 
-		auto have_complete_incremental = true;
-		size_t num_incrementals = 0;
-		m_next_exp_inc_seq_num = last_snapshot_msg.m_order_id + 1;
+		m_logger.log("%: % %() % Filled gap on channel % with % incremental updates.\n",
+			__FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&m_time_str),
+			channel->m_cfg.m_channel_id, num_incrementals);
+		channel->m_in_recovery = false;
+		m_num_retransmit_recoveries.inc();
+	}
 
-		for (auto inc_itr = m_incremental_queued_msgs.begin();
-			inc_itr != m_incremental_queued_msgs.end(); ++inc_itr) {
-			m_logger.log("%: % %() % Checking next_exp: % vs. seq: % % .\n", __FILE__,
-				__LINE__, __FUNCTION__, Common::getCurrentTimeStr(&m_time_str),
-				m_next_exp_inc_seq_num, inc_itr->first, inc_itr->second.toString());
+	void MarketDataConsumer::stopRetransmit() {
+		m_logger.log("%: % %() % Lost retransmission server, recovering from snapshots"
+			" only.\n", __FILE__, __LINE__, __FUNCTION__,
+			Common::getCurrentTimeStr(&m_time_str));
+		m_retransmit_socket.destroy();
 
-			if (inc_itr->first < m_next_exp_inc_seq_num)
-				continue;
+		for (auto channel : m_channels) {
+			if (channel->m_retransmit_pending) {
+				channel->m_retransmit_pending = false;
+				startSnapshotSync(channel);
+			}
+		}
+	}
 
-			if (inc_itr->first != m_next_exp_inc_seq_num) {
-				m_logger.log("%: % %() % Detected gap in incremental stream expected:"
-					" % found: % %.\n", __FILE__, __LINE__, __FUNCTION__,
-					Common::getCurrentTimeStr(&m_time_str), m_next_exp_inc_seq_num,
-					inc_itr->first, inc_itr->second.toString());
+	void MarketDataConsumer::startSnapshotSync(Channel* channel) {
+		// Queued incrementals stay, those past the snapshot complete it.
+		channel->m_recovery.clearSnapshot();
 
-				have_complete_incremental = false;
-				break;
-			}
-			m_logger.log("%: % %() % % => %\n", __FILE__, __LINE__, __FUNCTION__,
-				Common::getCurrentTimeStr(&m_time_str), inc_itr->first,
-				inc_itr->second.toString());
+		const auto& cfg = channel->m_cfg;
+		auto& snapshot_mcast_socket = channel->m_snapshot_mcast_socket;
+		if (snapshot_mcast_socket.m_socket_fd != -1)
+			return;
 
-			if (inc_itr->second.m_type != Exchange::MarketUpdateType::SNAPSHOT_START &&
-				inc_itr->second.m_type != Exchange::MarketUpdateType::SNAPSHOT_END) {
-				final_events.push_back(inc_itr->second);
+		ASSERT(snapshot_mcast_socket.init(
+			cfg.m_snapshot_ip, m_iface, cfg.m_snapshot_port, /*is_listening*/ true) >= 0,
+			"Unable to create snapshot mcast socket. error:" +
+			std::string(std::strerror(errno)));
 
-				m_next_exp_inc_seq_num++;
-				num_incrementals++;
-			}
+		ASSERT(snapshot_mcast_socket.join(cfg.m_snapshot_ip), "Join failed on: " +
+			std::to_string(snapshot_mcast_socket.m_socket_fd) + " error: " +
+			std::string(std::strerror(errno)));
+	}
+
+	void MarketDataConsumer::queueMessage(Channel* channel, bool is_snapshot,
+		size_t seq_num, const RecvTimeMarketUpdate& market_update) {
+		auto& recovery = channel->m_recovery;
+		if (is_snapshot) {
+			if (!recovery.addSnapshot(seq_num, market_update))
+				m_logger.log("%: % %() % Packet drops on snapshot socket of channel %,"
+					" dropping snapshot at: %\n", __FILE__, __LINE__, __FUNCTION__,
+					Common::getCurrentTimeStr(&m_time_str), channel->m_cfg.m_channel_id,
+					seq_num);
+		}
+		else {
+			queueIncremental(channel, seq_num, market_update);
 		}
+		m_logger.log("%: % %() % size snapshot: % incremental: [%, %) % => % \n", __FILE__,
+			__LINE__, __FUNCTION__, Common::getCurrentTimeStr(&m_time_str),
+			recovery.snapshotSize(), recovery.incrementals().begin(),
+			recovery.incrementals().end(), seq_num, market_update.toString());
+		checkSnapshotSync(channel);
+	}
 
-		if (!have_complete_incremental) {
-			m_logger.log("%: % %() % Returning because have gaps in queued incrementals.\n",
-				__FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&m_time_str));
-			m_snapshot_queued_msgs.clear();
+	void MarketDataConsumer::checkSnapshotSync(Channel* channel) {
+		auto& recovery = channel->m_recovery;
+		if (!recovery.snapshotComplete())
 			return;
-		}
 
-		for (const auto& itr : final_events) {
-			auto next_write = m_incoming_md_updates->getNextToWriteTo();
-			*next_write = itr;
-			m_incoming_md_updates->updateWriteIndex();
+		const auto snapshot_seq_num = recovery.snapshotSeqNum();
+		auto& incrementals = recovery.incrementals();
+		incrementals.advance(snapshot_seq_num + 1);
+		if (!incrementals.complete()) {
+			m_logger.log("%: % %() % Returning because have gaps in queued incrementals,"
+				" expected: % found: %.\n", __FILE__, __LINE__, __FUNCTION__,
+				Common::getCurrentTimeStr(&m_time_str), incrementals.contiguousEnd(),
+				incrementals.nextPresent(incrementals.contiguousEnd()));
+			recovery.clearSnapshot();
+			return;
 		}
 
-		m_logger.log("%: % %() % Recovered % snapshot and % incremental orders.\n", 
-			__FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&m_time_str), 
-			m_snapshot_queued_msgs.size() - 2, num_incrementals);
+		recovery.forwardSnapshot();
+		channel->m_next_exp_inc_seq_num = recovery.forwardIncrementals(snapshot_seq_num + 1);
+
+		m_logger.log("%: % %() % Recovered % snapshot and % incremental orders.\n",
+			__FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&m_time_str),
+			recovery.snapshotSize() - 2,
+			channel->m_next_exp_inc_seq_num - (snapshot_seq_num + 1));
 
-		m_snapshot_queued_msgs.clear();
-		m_incremental_queued_msgs.clear();
-		m_in_recovery = false;
+		recovery.clearSnapshot();
+		channel->m_in_recovery = false;
+		m_num_snapshot_recoveries.inc();
 
-		m_snapshot_mcast_socket.leave(m_snapshot_ip, m_snapshot_port);
+		channel->m_snapshot_mcast_socket.leave(channel->m_cfg.m_snapshot_ip,
+			channel->m_cfg.m_snapshot_port);
 	}
 
 }
\ No newline at end of file
@@ -1,52 +1,150 @@
 #pragma once
 
 #include <functional>
-#include <map>
 #include <cstring>
 
 #include "common/thread_utils.hpp"
 #include "common/lf_queue.hpp"
 #include "common/macros.hpp"
 #include "common/mcast_socket.hpp"
+#include "common/tcp_socket.hpp"
+#include "common/trace.hpp"
+#include "common/metrics.hpp"
 
 #include "exchange/market_data/market_update.hpp"
+#include "exchange/market_data/market_data_channel.hpp"
+
+#include "trading/market_data/market_data_recovery.hpp"
 
 namespace Trading {
 
+	/// Time a gap seen on one incremental line may wait for the other line to
+	/// fill it, before recovery starts anyway.
+	constexpr Nanos MDLineArbitrationTimeout = 10 * NANOS_TO_MILLIS;
+
+	struct MDLineStats {
+		size_t m_packets = 0;
+		size_t m_packet_gaps = 0;
+		/// Updates this line delivered before the other one.
+		size_t m_first = 0;
+		size_t m_duplicates = 0;
+		/// Kernel receive time minus the publisher's send time of each packet.
+		Nanos m_latency_sum = 0;
+		Nanos m_latency_max = 0;
+
+		auto toString() const {
+			std::stringstream ss;
+			ss << "MDLineStats[" <<
+				"packets:" << m_packets <<
+				" packet_gaps:" << m_packet_gaps <<
+				" first:" << m_first <<
+				" duplicates:" << m_duplicates <<
+				" latency_avg:" << (m_packets ? m_latency_sum / Nanos(m_packets) : 0) <<
+				" latency_max:" << m_latency_max <<
+				"]";
+			return ss.str();
+		}
+	};
+
 	class MarketDataConsumer {
 
-		size_t m_next_exp_inc_seq_num = 1;
-		Exchange::MEMarketUpdateLFQueue* m_incoming_md_updates = nullptr;
+		/// One copy of a channel's incremental stream.
+		struct Line {
+			Common::McastSocket m_socket;
+			size_t m_next_exp_packet_seq_num = 1;
+			size_t m_last_seq_num = 0;
+			MDLineStats m_stats;
+
+			explicit Line(Logger& logger) : m_socket(logger) {
+			}
+		};
+
+		/// Sequencing and recovery state of one subscribed market data channel.
+		/// Updates are taken from whichever line delivers them first, a gap only
+		/// counts once every line has moved past it.
+		struct Channel {
+			Exchange::MarketDataChannelCfg m_cfg;
+
+			size_t m_next_exp_inc_seq_num = 1;
+			Line m_line_a;
+			Line m_line_b;
+			Common::McastSocket m_snapshot_mcast_socket;
+
+			bool m_in_recovery = false;
+			/// A gap fill is outstanding with the RetransmissionServer.
+			bool m_retransmit_pending = false;
+			/// Updates past a gap, waiting for the other line or for recovery, and
+			/// the snapshot being collected.
+			MarketDataRecovery m_recovery;
+			Nanos m_gap_time = 0;
+
+			Channel(const Exchange::MarketDataChannelCfg& cfg, Logger& logger,
+				RecvTimeMarketUpdateLFQueue* market_updates,
+				const TickerSubscriptions* ticker_subscribed) :
+				m_cfg(cfg), m_line_a(logger), m_line_b(logger),
+				m_snapshot_mcast_socket(logger),
+				m_recovery(market_updates, ticker_subscribed) {
+			}
+
+			auto linesMissed() const noexcept {
+				return m_line_a.m_last_seq_num > m_next_exp_inc_seq_num &&
+					(!m_cfg.hasLineB() || m_line_b.m_last_seq_num > m_next_exp_inc_seq_num);
+			}
+		};
+
+		RecvTimeMarketUpdateLFQueue* m_incoming_md_updates = nullptr;
 
 		volatile bool m_run = false;
 
+		Common::MetricCounter m_num_updates;
+		Common::MetricCounter m_num_gaps;
+		Common::MetricCounter m_num_retransmit_recoveries;
+		Common::MetricCounter m_num_snapshot_recoveries;
+
 		std::string m_time_str;
 		Logger m_logger;
-		Common::McastSocket m_incremental_mcast_socket;
-		Common::McastSocket m_snapshot_mcast_socket;
-
-		bool m_in_recovery = true;
-		const std::string m_iface, m_snapshot_ip;
-		const int m_snapshot_port;
 
-		typedef std::map<size_t, Exchange::MEMarketUpdate> QueuedMarketUpdates;
-		QueuedMarketUpdates m_snapshot_queued_msgs;
-		QueuedMarketUpdates m_incremental_queued_msgs;
+		const std::string m_iface;
+		std::vector<Channel*> m_channels;
+		/// Gaps are filled over this connection first, fd is -1 without a
+		/// RetransmissionServer and recovery always goes through the snapshots.
+		Common::TCPSocket m_retransmit_socket;
+		/// Updates for other tickers sharing a subscribed channel are dropped.
+		TickerSubscriptions m_ticker_subscribed;
 
 		void run() noexcept;
-		void recvCallback(Common::McastSocket* socket) noexcept;
-		void startSnapshotSync();
-		void queueMessage(bool is_snapshot, const Exchange::MDPMarketUpdate* request);
-		void checkSnapshotSync();
+		void recvCallback(Channel* channel, Common::McastSocket* socket) noexcept;
+		size_t forwardQueued(Channel* channel) noexcept;
+		/// Returns false when seq_num did not fit the recovery window and the
+		/// channel fell back to snapshot recovery.
+		bool queueIncremental(Channel* channel, size_t seq_num,
+			const RecvTimeMarketUpdate& market_update);
+		void logLineStats(const Channel* channel);
+		void startRecovery(Channel* channel);
+		void requestRetransmit(Channel* channel, size_t begin_seq_num, size_t end_seq_num);
+		void retransmitCallback(Common::TCPSocket* socket, Nanos rx_time) noexcept;
+		void checkGapFill(Channel* channel);
+		void stopRetransmit();
+		void startSnapshotSync(Channel* channel);
+		void queueMessage(Channel* channel, bool is_snapshot, size_t seq_num,
+			const RecvTimeMarketUpdate& market_update);
+		void checkSnapshotSync(Channel* channel);
 
 	public:
-		MarketDataConsumer(Common::ClientId client_id, Exchange::MEMarketUpdateLFQueue
-			*market_updates, const std::string& iface, const std::string& snapshot_ip,
-			int snapshot_port, const std::string& incremental_ip, int incremental_port);
+		/// Subscribes to the channels carrying tickers, all channels if it is empty.
+		/// Without a retransmit_port gaps are only recovered from snapshots.
+		MarketDataConsumer(Common::ClientId client_id,
+			RecvTimeMarketUpdateLFQueue* market_updates, const std::string& iface,
+			const Exchange::MarketDataChannelCfgs& channels,
+			const std::vector<Common::TickerId>& tickers = {},
+			const std::string& retransmit_ip = "", int retransmit_port = -1);
 		~MarketDataConsumer();
 
 
-		void start();
+		/// core_id -1 leaves the thread unpinned.
+		void start(int core_id = -1);
 		void stop();
+
+		void registerMetrics(Common::MetricsRegistry& metrics);
 	};
 }
\ No newline at end of file
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include "common/lf_queue.hpp"
+#include "common/seq_window.hpp"
+#include "common/types.hpp"
+
+#include "trading/market_data/recv_time_market_update.hpp"
+
+namespace Trading {
+
+	/// Incrementals one channel can hold past a gap, the same depth the
+	/// RetransmissionServer keeps.
+	constexpr size_t MDRecoveryWindowSize = ME_MAX_RETRANSMIT_UPDATES;
+
+	typedef std::array<bool, ME_MAX_TICKERS> TickerSubscriptions;
+
+	/// Recovery buffers of one market data channel. Incrementals past a gap go
+	/// into a SeqWindow in whatever order they arrive, snapshot messages have to
+	/// come in order from SNAPSHOT_START and are appended to a vector that keeps
+	/// its capacity across snapshots. Completeness of both is tracked message by
+	/// message, and recovered updates reach the queue in a few batched pushes.
+	class MarketDataRecovery final {
+		RecvTimeMarketUpdateLFQueue* m_queue = nullptr;
+		const TickerSubscriptions* m_ticker_subscribed = nullptr;
+
+		std::vector<RecvTimeMarketUpdate> m_snapshot;
+		Common::SeqWindow<RecvTimeMarketUpdate> m_incrementals;
+
+		/// Pushes the subscribed ones of count updates, as many per batch as the
+		/// queue has room for, waiting for the reader while it is full.
+		template<typename UpdateAt>
+		auto push(size_t count, UpdateAt&& update_at) noexcept {
+			for (size_t i = 0; i < count;) {
+				const auto free_slots = m_queue->capacity() - 1 - m_queue->size();
+				size_t num_written = 0;
+				for (; i < count && num_written < free_slots; ++i) {
+					const auto& market_update = update_at(i);
+					if ((*m_ticker_subscribed)[market_update.m_market_update.m_ticker_id])
+						*m_queue->getNextToWriteTo(num_written++) = market_update;
+				}
+				m_queue->updateWriteIndex(num_written);
+			}
+		}
+
+		MarketDataRecovery() = delete;
+		MarketDataRecovery(const MarketDataRecovery&) = delete;
+		MarketDataRecovery(const MarketDataRecovery&&) = delete;
+		MarketDataRecovery& operator=(const MarketDataRecovery&) = delete;
+		MarketDataRecovery& operator=(const MarketDataRecovery&&) = delete;
+
+	public:
+		MarketDataRecovery(RecvTimeMarketUpdateLFQueue* queue,
+			const TickerSubscriptions* ticker_subscribed,
+			size_t window_size = MDRecoveryWindowSize) :
+			m_queue(queue), m_ticker_subscribed(ticker_subscribed),
+			m_incrementals(window_size) {
+		}
+
+		auto& incrementals() noexcept { return m_incrementals; }
+		auto& incrementals() const noexcept { return m_incrementals; }
+
+		auto snapshotSize() const noexcept { return m_snapshot.size(); }
+		auto snapshotComplete() const noexcept {
+			return !m_snapshot.empty() &&
+				m_snapshot.back().m_market_update.m_type == Exchange::MarketUpdateType::SNAPSHOT_END;
+		}
+		/// Last incremental SeqNum contained in a complete snapshot.
+		auto snapshotSeqNum() const noexcept {
+			return static_cast<size_t>(m_snapshot.back().m_market_update.m_order_id);
+		}
+		auto clearSnapshot() noexcept { m_snapshot.clear(); }
+
+		/// Returns false when seq_num breaks the snapshot being collected, which is
+		/// dropped. Anything before a SNAPSHOT_START is ignored.
+		auto addSnapshot(size_t seq_num, const RecvTimeMarketUpdate& market_update) {
+			if (market_update.m_market_update.m_type == Exchange::MarketUpdateType::SNAPSHOT_START &&
+				!seq_num) {
+				m_snapshot.clear();
+				m_snapshot.push_back(market_update);
+				return true;
+			}
+			if (m_snapshot.empty())
+				return true;
+			if (seq_num != m_snapshot.size() || snapshotComplete()) {
+				m_snapshot.clear();
+				return false;
+			}
+			m_snapshot.push_back(market_update);
+			return true;
+		}
+
+		auto forward(const RecvTimeMarketUpdate& market_update) noexcept {
+			if (!m_ticker_subscribed->at(market_update.m_market_update.m_ticker_id))
+				return;
+
+			*m_queue->getNextToWriteTo() = market_update;
+			m_queue->updateWriteIndex();
+		}
+
+		/// Forwards the complete snapshot without its START and END markers.
+		auto forwardSnapshot() noexcept {
+			push(m_snapshot.size() - 2, [this](size_t i) -> auto& {
+				return m_snapshot[i + 1]; });
+		}
+
+		/// Forwards the incrementals held without a gap from next_seq_num and
+		/// returns the SeqNum following them.
+		auto forwardIncrementals(size_t next_seq_num) noexcept {
+			m_incrementals.advance(next_seq_num);
+			const auto end_seq_num = m_incrementals.contiguousEnd();
+			push(end_seq_num - next_seq_num, [this, next_seq_num](size_t i) -> auto& {
+				return m_incrementals.at(next_seq_num + i); });
+			m_incrementals.advance(end_seq_num);
+			return end_seq_num;
+		}
+	};
+}
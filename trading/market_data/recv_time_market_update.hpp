@@ -0,0 +1,22 @@
+#pragma once
+
+#include "common/lf_queue.hpp"
+#include "common/time_utils.hpp"
+
+#include "exchange/market_data/market_update.hpp"
+
+namespace Trading {
+
+	/// MEMarketUpdate with the receive time of the packet that carried it, see
+	/// Common::rxTimestamp().
+	struct RecvTimeMarketUpdate {
+		Nanos m_recv_time = 0;
+		Exchange::MEMarketUpdate m_market_update;
+
+		auto toString() const {
+			return m_market_update.toString() + " rx:" + std::to_string(m_recv_time);
+		}
+	};
+
+	typedef Common::LFQueue<RecvTimeMarketUpdate> RecvTimeMarketUpdateLFQueue;
+}
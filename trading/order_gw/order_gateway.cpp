@@ -4,7 +4,7 @@ namespace Trading {
 
 	OrderGateway::OrderGateway(const ClientId& client_id,
 		Exchange::ClientRequestLFQueue* client_requests,
-		Exchange::ClientResponseLFQueue* client_responses, std::string ip,
+		RecvTimeClientResponseLFQueue* client_responses, std::string ip,
 		const std::string& iface, int port) :
 		m_client_id(client_id), m_ip(ip), m_iface(iface), m_port(port),
 		m_outgoing_requests(client_requests), m_incoming_responses(client_responses),
@@ -20,14 +20,18 @@ namespace Trading {
 
 		using namespace std::literals::chrono_literals;
 		std::this_thread::sleep_for(5s);
+
+		m_logger.log("%:% %() % send ns %\n", __FILE__, __LINE__, __FUNCTION__,
+			Common::getCurrentTimeStr(&m_time_str),
+			m_send_latency.snapshot().toString(Common::tscPerNano()));
 	}
 
-	void OrderGateway::start() {
+	void OrderGateway::start(int core_id) {
 		m_run = true;
 		ASSERT(m_tcp_socket.connect(m_ip, m_iface, m_port, false) >= 0,
 			"Unable to connect to ip: " + m_ip + " port: " + std::to_string(m_port) +
 			" on iface: " + m_iface + " error: " + std::string(std::strerror(errno)));
-		ASSERT(Common::createAndStartThread(-1, "Trading/OrderGateway", [this]() {run(); })
+		ASSERT(Common::createAndStartThread(core_id, "Trading/OrderGateway", [this]() {run(); })
 			!= nullptr, "Failed to start OrderGateway thread.");
 	}
 
@@ -35,6 +39,14 @@ namespace Trading {
 		m_run = false;
 	}
 
+	void OrderGateway::registerMetrics(Common::MetricsRegistry& metrics) {
+		metrics.addCounter("ogw.requests", &m_num_requests);
+		metrics.addCounter("ogw.responses", &m_num_responses);
+		metrics.addHistogram("ogw.send_ns", &m_send_latency, Common::tscPerNano());
+		metrics.addGauge("ogw.incoming_responses",
+			[this]() { return m_incoming_responses->size(); });
+	}
+
 	void OrderGateway::run() noexcept {
 		m_logger.log("%: % %() %\n", __FILE__, __LINE__,
 			__FUNCTION__, Common::getCurrentTimeStr(&m_time_str));
@@ -47,8 +59,14 @@ namespace Trading {
 				m_logger.log("%: % %() % Sending cid:% seq:% %\n", __FILE__, __LINE__, __FUNCTION__,
 					Common::getCurrentTimeStr(&m_time_str), m_client_id, m_next_outgoing_seq_num,
 					client_request->toString());
-				m_tcp_socket.send(&m_next_outgoing_seq_num, sizeof(m_next_exp_seq_num));
-				m_tcp_socket.send(client_request, sizeof(Exchange::MEClientRequest));
+				const auto start_tsc = Common::rdtsc();
+				const Exchange::OMClientRequest om_client_request{ m_next_outgoing_seq_num,
+					*client_request };
+				Common::trace(Common::TraceHop::OGW_SEND, Common::traceOrderKey(
+					client_request->m_client_id, client_request->m_order_id));
+				m_tcp_socket.send(&om_client_request, sizeof(Exchange::OMClientRequest));
+				m_send_latency.record(Common::rdtsc() - start_tsc);
+				m_num_requests.inc();
 				m_outgoing_requests->updateReadIndex();
 
 				m_next_outgoing_seq_num++;
@@ -59,14 +77,16 @@ namespace Trading {
 	void OrderGateway::recvCallback(Common::TCPSocket* socket, Nanos rx_time) noexcept {
 		m_logger.log("%:% %() % Received socket:% len:% %\n", __FILE__, __LINE__, __FUNCTION__,
 			Common::getCurrentTimeStr(&m_time_str), socket->m_fd,
-			socket->m_next_recv_valid_index, rx_time);
+			socket->m_recv_ring.size(), rx_time);
 
-		if (socket->m_next_recv_valid_index >= sizeof(Exchange::OMClientResponse)) {
+		if (socket->m_recv_ring.size() >= sizeof(Exchange::OMClientResponse)) {
+			const auto recv_data = socket->m_recv_ring.data();
+			const auto recv_len = socket->m_recv_ring.size();
 			size_t i = 0;
-			for (; i + sizeof(Exchange::OMClientResponse) <= socket->m_next_recv_valid_index;
+			for (; i + sizeof(Exchange::OMClientResponse) <= recv_len;
 				i += sizeof(Exchange::OMClientResponse)) {
 				auto response = reinterpret_cast<Exchange::OMClientResponse*>(
-					socket->m_recv_buffer + i);
+					recv_data + i);
 				m_logger.log("%:% %() % Received %\n", __FILE__, __LINE__, __FUNCTION__,
 					Common::getCurrentTimeStr(&m_time_str), response->toString());
 
@@ -88,11 +108,11 @@ namespace Trading {
 				m_next_exp_seq_num++;
 
 				auto next_write = m_incoming_responses->getNextToWriteTo();
-				*next_write = std::move(response->m_me_client_response);
+				*next_write = { rx_time, response->m_me_client_response };
 				m_incoming_responses->updateWriteIndex();
+				m_num_responses.inc();
 			}
-			memcpy(socket->m_recv_buffer, socket->m_recv_buffer + i, socket->m_next_recv_valid_index - i);
-			socket->m_next_recv_valid_index -= i;
+			socket->m_recv_ring.consume(i);
 		}
 	}
 }
@@ -6,10 +6,15 @@
 #include "common/thread_utils.hpp"
 #include "common/macros.hpp"
 #include "common/tcp_server.hpp"
+#include "common/latency_histogram.hpp"
+#include "common/metrics.hpp"
+#include "common/trace.hpp"
 
 #include "exchange/order_server/client_request.hpp"
 #include "exchange/order_server/client_response.hpp"
 
+#include "trading/order_gw/recv_time_client_response.hpp"
+
 namespace Trading {
 
 	class OrderGateway {
@@ -21,10 +26,15 @@ namespace Trading {
 		const int m_port = 0;
 
 		Exchange::ClientRequestLFQueue* m_outgoing_requests = nullptr;
-		Exchange::ClientResponseLFQueue* m_incoming_responses = nullptr;
+		RecvTimeClientResponseLFQueue* m_incoming_responses = nullptr;
 
 		volatile bool m_run = false;
 
+		/// TSC ticks from dequeuing a request to queuing it on the socket.
+		Common::LatencyRecorder m_send_latency;
+		Common::MetricCounter m_num_requests;
+		Common::MetricCounter m_num_responses;
+
 		std::string m_time_str;
 		Logger m_logger;
 
@@ -39,11 +49,15 @@ namespace Trading {
 
 
 		OrderGateway(const ClientId& client_id, Exchange::ClientRequestLFQueue* client_requests, 
-			Exchange::ClientResponseLFQueue* client_responses, std::string ip, 
+			RecvTimeClientResponseLFQueue* client_responses, std::string ip, 
 			const std::string& iface, int port);
 		~OrderGateway();
 
-		void start();
+		/// core_id -1 leaves the thread unpinned.
+		void start(int core_id = -1);
 		void stop();
+
+		const auto& sendLatency() const noexcept { return m_send_latency; }
+		void registerMetrics(Common::MetricsRegistry& metrics);
 	};
 }
\ No newline at end of file
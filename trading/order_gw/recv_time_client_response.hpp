@@ -0,0 +1,22 @@
+#pragma once
+
+#include "common/lf_queue.hpp"
+#include "common/time_utils.hpp"
+
+#include "exchange/order_server/client_response.hpp"
+
+namespace Trading {
+
+	/// MEClientResponse with the receive time of the read that completed it, see
+	/// Common::rxTimestamp().
+	struct RecvTimeClientResponse {
+		Nanos m_recv_time = 0;
+		Exchange::MEClientResponse m_client_response;
+
+		auto toString() const {
+			return m_client_response.toString() + " rx:" + std::to_string(m_recv_time);
+		}
+	};
+
+	typedef Common::LFQueue<RecvTimeClientResponse> RecvTimeClientResponseLFQueue;
+}
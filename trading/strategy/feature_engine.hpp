@@ -24,6 +24,11 @@ namespace Trading {
 
 		FeatureEngine(Common::Logger* logger) : m_logger(logger) {}
 
+		auto reset() noexcept {
+			m_mkt_price = Feature_INVALID;
+			m_agg_trade_qty_ratio = Feature_INVALID;
+		}
+
 		auto getMktPrice() const noexcept { return m_mkt_price; }
 		auto getAggTradeQtyRatio() const noexcept { return m_agg_trade_qty_ratio; }
 
@@ -2,6 +2,7 @@
 
 #include "common/macros.hpp"
 #include "common/logging.hpp"
+#include "common/trace.hpp"
 
 #include "trading/strategy/order_manager.hpp"
 #include "trading/strategy/feature_engine.hpp"
@@ -10,6 +11,8 @@ using namespace Common;
 
 namespace Trading {
 
+	/// Follows a trade with an aggressive order on its side when the aggressive
+	/// quantity ratio reaches m_threshold.
 	class LiquidityTaker {
 		const FeatureEngine* m_feature_engine = nullptr;
 		OrderManager* m_order_manager = nullptr;
@@ -17,19 +20,70 @@ namespace Trading {
 		std::string m_time_str;
 		Common::Logger* m_logger = nullptr;
 
-		const TradeEngineCfgHashMap m_ticker_cfg;
+		TradeEngineCfgHashMap m_ticker_cfg;
+		/// OrderManager slot of this strategy's orders.
+		const size_t m_om_slot;
 
 
+	public:
+		LiquidityTaker(Common::Logger* logger, const FeatureEngine* feature_engine,
+			OrderManager* order_manager, const TradeEngineCfgHashMap& ticker_cfg,
+			size_t om_slot = 0);
+
+		/// Trades with ticker_cfg from now on.
+		void reset(const TradeEngineCfgHashMap& ticker_cfg) noexcept { m_ticker_cfg = ticker_cfg; }
+
+		// Handlers are in the header to inline into StrategyTradeEngine.
 		void onTradeUpdate(const Exchange::MEMarketUpdate* market_update,
-			MarketOrderBook* book) noexcept;
+			MarketOrderBook* book) noexcept {
+			m_logger->log("%: % %() % %\n", __FILE__, __LINE__, __FUNCTION__,
+				Common::getCurrentTimeStr(&m_time_str), market_update->toString().c_str());
+
+			const auto bbo = book->getBBO();
+			const auto agg_qty_ratio = m_feature_engine->getAggTradeQtyRatio();
+
+			if (bbo->m_bid_price != Price_INVALID && bbo->m_ask_price != Price_INVALID &&
+				agg_qty_ratio != Feature_INVALID) [[likely]] {
+				m_logger->log("%: % %() % % agg-qty-ratio: %\n", __FILE__, __LINE__,
+					__FUNCTION__, Common::getCurrentTimeStr(&m_time_str),
+					bbo->toString().c_str(), agg_qty_ratio);
+
+				const auto clip = m_ticker_cfg.at(market_update->m_ticker_id).m_clip;
+				const auto threshold = m_ticker_cfg.at(market_update->m_ticker_id).m_threshold;
+
+				if (agg_qty_ratio >= threshold) {
+					Common::trace(Common::TraceHop::STRATEGY_DECISION);
+					if (market_update->m_side == Side::BUY) {
+						m_order_manager->moveOrders(market_update->m_ticker_id,
+							bbo->m_ask_price, Price_INVALID, clip, m_om_slot);
+					}
+					else {
+						m_order_manager->moveOrders(market_update->m_ticker_id,
+							Price_INVALID, bbo->m_bid_price, clip, m_om_slot);
+					}
+				}
+			}
+		}
+
 		void onOrderBookUpdate(TickerId ticker_id, Price price, Side side,
-			const MarketOrderBook* book) noexcept;
-		void onOrderUpdate(const Exchange::MEClientResponse* client_response) noexcept;
+			const MarketOrderBook* /*book*/) noexcept {
+			m_logger->log("%:% %() % ticker:% price:% side:%\n", __FILE__, __LINE__, 
+				__FUNCTION__, Common::getCurrentTimeStr(&m_time_str), ticker_id, 
+			
+				Common::priceToString(price).c_str(), Common::sideToString(side).c_str());
+		}
 
+		void onOrderUpdate(const Exchange::MEClientResponse* client_response) noexcept {
+			onOrderUpdate(client_response, m_order_manager->slotOf(client_response));
+		}
 
-	public:
-		LiquidityTaker(Common::Logger* logger, TradeEngine* trade_engine,
-			FeatureEngine* feature_engine, OrderManager* order_manager,
-			const TradeEngineCfgHashMap& ticker_cfg);
+		/// client_response is for the order in OrderManager slot, as MultiAlgo
+		/// found.
+		void onOrderUpdate(const Exchange::MEClientResponse* client_response,
+			size_t slot) noexcept {
+			m_logger->log("%: % %() % %\n", __FILE__, __LINE__, __FUNCTION__,
+				Common::getCurrentTimeStr(&m_time_str), client_response->toString().c_str());
+			m_order_manager->onOrderUpdate(client_response, slot);
+		}
 	};
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include "common/macros.hpp"
 #include "common/logging.hpp"
+#include "common/trace.hpp"
 
 #include "trading/strategy/feature_engine.hpp"
 #include "trading/strategy/order_manager.hpp"
@@ -10,6 +11,8 @@ using namespace Common;
 
 namespace Trading {
 
+	/// Quotes both sides around the BBO, a tick further out on the side the fair
+	/// price is within m_threshold of.
 	class MarketMaker {
 
 		const FeatureEngine* m_feature_engine = nullptr;
@@ -18,18 +21,62 @@ namespace Trading {
 		std::string m_time_str;
 		Common::Logger* m_logger = nullptr;
 
-		const TradeEngineCfgHashMap m_ticker_cfg;
+		TradeEngineCfgHashMap m_ticker_cfg;
+		/// OrderManager slot of this strategy's orders.
+		const size_t m_om_slot;
 
-		void onOrderBookUpdate(TickerId ticker_id, Price price, Side side, 
-			const MarketOrderBook* book) noexcept;
-		void onTradeUpdate(const Exchange::MEMarketUpdate* market_update, 
-			MarketOrderBook* book) noexcept;
-		void onOrderUpdate(const Exchange::MEClientResponse* client_response) noexcept;
+	public:
+		MarketMaker(Common::Logger* logger, const FeatureEngine* feature_engine,
+			OrderManager* order_manager, const TradeEngineCfgHashMap& ticker_cfg,
+			size_t om_slot = 0);
 
+		/// Trades with ticker_cfg from now on.
+		void reset(const TradeEngineCfgHashMap& ticker_cfg) noexcept { m_ticker_cfg = ticker_cfg; }
 
-	public:
-		MarketMaker(Common::Logger* logger, TradeEngine* trade_engine, 
-			const FeatureEngine* feature_engine, OrderManager* order_manager, 
-			const TradeEngineCfgHashMap& ticker_cfg);
+		// Handlers are in the header to inline into StrategyTradeEngine.
+		void onOrderBookUpdate(TickerId ticker_id, Price price, Side side,
+			const MarketOrderBook* book) noexcept {
+			m_logger->log("%: % %() % ticker: % price: % side: %\n", __FILE__, __LINE__,
+				__FUNCTION__, Common::getCurrentTimeStr(&m_time_str), ticker_id,
+				Common::priceToString(price).c_str(), Common::sideToString(side).c_str());
+
+			const auto bbo = book->getBBO();
+			const auto fair_price = m_feature_engine->getMktPrice();
+
+			if (bbo->m_bid_price != Price_INVALID && bbo->m_ask_price != Price_INVALID &&
+				fair_price != Feature_INVALID) [[likely]] {
+				m_logger->log("%: % %() % % fair-price: %\n", __FILE__, __LINE__,
+					__FUNCTION__, Common::getCurrentTimeStr(&m_time_str),
+					bbo->toString().c_str(), fair_price);
+				const auto clip = m_ticker_cfg.at(ticker_id).m_clip;
+				const auto threshold = m_ticker_cfg.at(ticker_id).m_threshold;
+
+				const auto bid_price = bbo->m_bid_price -
+					(fair_price - bbo->m_bid_price >= threshold ? 0 : 1);
+				const auto ask_price = bbo->m_ask_price +
+					(bbo->m_ask_price - fair_price >= threshold ? 0 : 1);
+				Common::trace(Common::TraceHop::STRATEGY_DECISION);
+				m_order_manager->moveOrders(ticker_id, bid_price, ask_price, clip, m_om_slot);
+			}
+		}
+
+		void onTradeUpdate(const Exchange::MEMarketUpdate* market_update,
+			MarketOrderBook* /*book*/) noexcept {
+			m_logger->log("%: % %() % %\n", __FILE__, __LINE__, __FUNCTION__, 
+				Common::getCurrentTimeStr(&m_time_str), market_update->toString().c_str());
+		}
+
+		void onOrderUpdate(const Exchange::MEClientResponse* client_response) noexcept {
+			onOrderUpdate(client_response, m_order_manager->slotOf(client_response));
+		}
+
+		/// client_response is for the order in OrderManager slot, as MultiAlgo
+		/// found.
+		void onOrderUpdate(const Exchange::MEClientResponse* client_response,
+			size_t slot) noexcept {
+			m_logger->log("%: % %() % %\n", __FILE__, __LINE__, __FUNCTION__,
+				Common::getCurrentTimeStr(&m_time_str), client_response->toString().c_str());
+			m_order_manager->onOrderUpdate(client_response, slot);
+		}
 	};
 }
\ No newline at end of file
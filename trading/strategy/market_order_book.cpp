@@ -1,6 +1,6 @@
 #include "market_order_book.hpp"
 
-#include "trading/strategy/trade_engine.hpp"
+#include "common/trace.hpp"
 
 namespace Trading {
 
@@ -12,16 +12,15 @@ namespace Trading {
 		m_logger->log("%: % %() % OrderBook\n%\n", __FILE__, __LINE__,
 			__FUNCTION__, Common::getCurrentTimeStr(&m_time_str),
 			/*toString(false, true)*/ "TODO: implement MarketOrderBook toString()");
-		m_trade_engine = nullptr;
 		m_bids_by_price = m_asks_by_price = nullptr;
 		m_oid_to_order.fill(nullptr);
 	}
 
 	void MarketOrderBook::onMarketUpdate(const Exchange::MEMarketUpdate* market_update) noexcept {
-		const auto bid_updated = (m_bids_by_price && market_update->m_side == Side::BUY
-			&& market_update->m_price >= m_bids_by_price->m_price);
-		const auto ask_updated = (m_asks_by_price && market_update->m_side == Side::SELL
-			&& market_update->m_price <= m_asks_by_price->m_price);
+		const auto bid_updated = (market_update->m_side == Side::BUY &&
+			(!m_bids_by_price || market_update->m_price >= m_bids_by_price->m_price));
+		const auto ask_updated = (market_update->m_side == Side::SELL &&
+			(!m_asks_by_price || market_update->m_price <= m_asks_by_price->m_price));
 
 		switch (market_update->m_type)
 		{
@@ -47,34 +46,12 @@ namespace Trading {
 		break;
 		case Exchange::MarketUpdateType::TRADE:
 		{
-			m_trade_engine->onTradeUpdate(market_update, this);
+			Common::trace(Common::TraceHop::BOOK_UPDATE);
 			return;
 		}
 		case Exchange::MarketUpdateType::CLEAR:
-		{
-			for (auto& order : m_oid_to_order) {
-				if (order)
-					m_order_pool.deallocate(order);
-			}
-			m_oid_to_order.fill(nullptr);
-
-			if (m_bids_by_price) {
-				for (auto bid = m_bids_by_price->m_next_entry; bid != m_bids_by_price;
-					bid = bid->m_next_entry) {
-					m_orders_at_price_pool.deallocate(bid);
-				}
-				m_orders_at_price_pool.deallocate(m_bids_by_price);
-			}
-			if (m_asks_by_price) {
-				for (auto ask = m_asks_by_price->m_next_entry; ask != m_asks_by_price;
-					ask = ask->m_next_entry) {
-					m_orders_at_price_pool.deallocate(ask);
-				}
-				m_orders_at_price_pool.deallocate(m_asks_by_price);
-			}
-			m_bids_by_price = m_asks_by_price = nullptr;
-		}
-		break;
+			clear();
+			break;
 		case Exchange::MarketUpdateType::INVALID:
 		case Exchange::MarketUpdateType::SNAPSHOT_START:
 		case Exchange::MarketUpdateType::SNAPSHOT_END:
@@ -84,14 +61,45 @@ namespace Trading {
 
 		updateBBO(bid_updated, ask_updated);
 
-		m_trade_engine->onOrderBookUpdate(market_update->m_ticker_id,
-			market_update->m_price, market_update->m_side, this);
+		Common::trace(Common::TraceHop::BOOK_UPDATE);
 
 		m_logger->log("%:% %() % OrderBook\n%\n", __FILE__, __LINE__, __FUNCTION__,
 			Common::getCurrentTimeStr(&m_time_str),
 			/*toString(false, true)*/ "TODO: implement MarketOrderBook toString()");
 	}
 
+	void MarketOrderBook::clear() noexcept {
+		for (auto& order : m_oid_to_order) {
+			if (order)
+				m_order_pool.deallocate(order);
+		}
+		m_oid_to_order.fill(nullptr);
+
+		if (m_bids_by_price) {
+			for (auto bid = m_bids_by_price->m_next_entry; bid != m_bids_by_price;
+				bid = bid->m_next_entry) {
+				m_orders_at_price_pool.deallocate(bid);
+			}
+			m_orders_at_price_pool.deallocate(m_bids_by_price);
+		}
+		if (m_asks_by_price) {
+			for (auto ask = m_asks_by_price->m_next_entry; ask != m_asks_by_price;
+				ask = ask->m_next_entry) {
+				m_orders_at_price_pool.deallocate(ask);
+			}
+			m_orders_at_price_pool.deallocate(m_asks_by_price);
+		}
+		m_bids_by_price = m_asks_by_price = nullptr;
+		m_price_orders_at_price.fill(nullptr);
+	}
+
+	void MarketOrderBook::reset() noexcept {
+		clear();
+		m_order_pool.reset();
+		m_orders_at_price_pool.reset();
+		m_bbo = {};
+	}
+
 	unsigned long MarketOrderBook::priceToIndex(Price price) const noexcept {
 		return price % ME_MAX_PRICE_LEVELS;
 	}
@@ -137,20 +145,20 @@ namespace Trading {
 			auto target = best_orders_by_price;
 			bool add_after = ((new_orders_at_price->m_side == Side::SELL &&
 				new_orders_at_price->m_price > target->m_price) ||
-				(new_orders_at_price->m_side == Side::BUY && new_orders_at_price->m_price));
+				(new_orders_at_price->m_side == Side::BUY && new_orders_at_price->m_price < target->m_price));
 
 			if (add_after) {
 				target = target->m_next_entry;
 				add_after = ((new_orders_at_price->m_side == Side::SELL &&
 					new_orders_at_price->m_price > target->m_price) ||
 					(new_orders_at_price->m_side == Side::BUY &&
-						new_orders_at_price->m_price));
+						new_orders_at_price->m_price < target->m_price));
 			}
 			while (add_after && target != best_orders_by_price) {
 				add_after = ((new_orders_at_price->m_side == Side::SELL &&
 					new_orders_at_price->m_price > target->m_price) ||
 					(new_orders_at_price->m_side == Side::BUY &&
-						new_orders_at_price->m_price));
+						new_orders_at_price->m_price < target->m_price));
 				if (add_after)
 					target = target->m_next_entry;
 			}
@@ -165,15 +173,14 @@ namespace Trading {
 				target->m_next_entry = new_orders_at_price;
 			}
 			else {
-				new_orders_at_price->m_prev_entry = target->m_next_entry;
+				new_orders_at_price->m_prev_entry = target->m_prev_entry;
 				new_orders_at_price->m_next_entry = target;
 				target->m_prev_entry->m_next_entry = new_orders_at_price;
+				target->m_prev_entry = new_orders_at_price;
 				if ((new_orders_at_price->m_side == Side::BUY &&
 					new_orders_at_price->m_price > best_orders_by_price->m_price) ||
 					(new_orders_at_price->m_side == Side::SELL &&
 						new_orders_at_price->m_price < best_orders_by_price->m_price)) {
-					target->m_next_entry = (target->m_next_entry == best_orders_by_price ?
-						new_orders_at_price : target->m_next_entry);
 					(new_orders_at_price->m_side == Side::BUY ?
 						m_bids_by_price : m_asks_by_price) = new_orders_at_price;
 				}
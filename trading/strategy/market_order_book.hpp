@@ -10,21 +10,17 @@
 
 namespace Trading {
 
-	class TradeEngine;
-
 	class MarketOrderBook final {
 
 		const TickerId m_ticker_id;
 
-		TradeEngine* m_trade_engine = nullptr;
-
-		OrderHashMap m_oid_to_order;
+		OrderHashMap m_oid_to_order = {};
 
 		MemPool<MarketOrdersAtPrice> m_orders_at_price_pool;
 		MarketOrdersAtPrice* m_bids_by_price = nullptr;
 		MarketOrdersAtPrice* m_asks_by_price = nullptr;
 
-		ORdersAtPriceHashMap m_price_orders_at_price;
+		ORdersAtPriceHashMap m_price_orders_at_price = {};
 
 		MemPool<MarketOrder> m_order_pool;
 
@@ -33,8 +29,6 @@ namespace Trading {
 		std::string m_time_str;
 		Logger* m_logger = nullptr;
 
-		void setTradeEngine(TradeEngine* trade_engine) { m_trade_engine = trade_engine; }
-
 		unsigned long priceToIndex(Price price) const noexcept;
 		MarketOrdersAtPrice* getOrdersAtPrice(Price price) const noexcept;
 
@@ -45,14 +39,23 @@ namespace Trading {
 		void removeOrdersAtPrice(Side side, Price price) noexcept;
 
 		void updateBBO(bool update_bid, bool update_ask) noexcept;
+		/// Drops every order and price level, as a CLEAR does.
+		void clear() noexcept;
 
 	public:
 
 		MarketOrderBook(TickerId ticker_id, Logger * logger);
 		~MarketOrderBook();
 
+		/// Applies market_update, the TradeEngine then passes it on as a trade or
+		/// a book update.
 		void onMarketUpdate(const Exchange::MEMarketUpdate* market_update) noexcept;
 		const BBO* getBBO() const noexcept { return &m_bbo; }
+		/// Back to an empty book without a BBO.
+		void reset() noexcept;
+
+		const auto& orderPool() const noexcept { return m_order_pool; }
+		const auto& ordersAtPricePool() const noexcept { return m_orders_at_price_pool; }
 	};
 
 	typedef std::array<MarketOrderBook*, ME_MAX_TICKERS> MarketOrderBookHashMap;
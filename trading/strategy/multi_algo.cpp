@@ -0,0 +1,81 @@
+#include "trading/strategy/multi_algo.hpp"
+
+
+namespace Trading {
+
+	std::string StrategyCfg::toString() const {
+		std::stringstream ss;
+		ss << "StrategyCfg{" <<
+			"algo:" << algoTypeToString(m_algo_type) << " " <<
+			"tickers:[";
+		for (size_t i = 0; i < m_tickers.size(); ++i)
+			ss << (i ? " " : "") << tickerIdToString(m_tickers[i]);
+		ss << "]}";
+		return ss.str();
+	}
+
+	StrategyCfg stringToStrategyCfg(const std::string& str) {
+		const auto colon = str.find(':');
+		ASSERT(colon != std::string::npos, "Invalid strategy " + str);
+		StrategyCfg strategy_cfg;
+		strategy_cfg.m_algo_type = stringToAlgoType(str.substr(0, colon));
+		std::stringstream ss(str.substr(colon + 1));
+		std::string ticker;
+		while (std::getline(ss, ticker, ','))
+			strategy_cfg.m_tickers.push_back(static_cast<TickerId>(std::stoul(ticker)));
+		return strategy_cfg;
+	}
+
+	MultiAlgo::MultiAlgo(Common::Logger* logger, const FeatureEngine* feature_engine,
+		OrderManager* order_manager, const TradeEngineCfgHashMap& ticker_cfg,
+		const std::vector<StrategyCfg>& strategies) :
+		m_logger(logger), m_order_manager(order_manager) {
+		ASSERT(!strategies.empty() && strategies.size() <= OM_MAX_STRATEGIES,
+			"MultiAlgo takes 1 to " + std::to_string(OM_MAX_STRATEGIES) + " strategies, not " +
+			std::to_string(strategies.size()));
+
+		for (size_t slot = 0; slot < strategies.size(); ++slot) {
+			const auto& strategy = strategies[slot];
+			for (const auto ticker_id : strategy.m_tickers) {
+				ASSERT(ticker_id < ME_MAX_TICKERS, "Invalid ticker in " + strategy.toString());
+			}
+
+			switch (strategy.m_algo_type) {
+			case AlgoType::MAKER: {
+				const auto maker = new MarketMaker(logger, feature_engine, order_manager,
+					ticker_cfg, slot);
+				m_makers.push_back(maker);
+				m_slot_makers[slot] = maker;
+				for (const auto ticker_id : strategy.m_tickers)
+					m_ticker_makers[ticker_id].push_back(maker);
+			}
+				break;
+			case AlgoType::TAKER: {
+				const auto taker = new LiquidityTaker(logger, feature_engine, order_manager,
+					ticker_cfg, slot);
+				m_takers.push_back(taker);
+				m_slot_takers[slot] = taker;
+				for (const auto ticker_id : strategy.m_tickers)
+					m_ticker_takers[ticker_id].push_back(taker);
+			}
+				break;
+			default:
+				FATAL("MultiAlgo cannot run " + strategy.toString());
+			}
+
+			m_logger->log("%:% %() % Slot:% %\n", __FILE__, __LINE__, __FUNCTION__,
+				Common::getCurrentTimeStr(&m_time_str), slot, strategy.toString());
+		}
+	}
+
+	MultiAlgo::~MultiAlgo() {
+		for (auto& maker : m_makers) {
+			delete maker;
+			maker = nullptr;
+		}
+		for (auto& taker : m_takers) {
+			delete taker;
+			taker = nullptr;
+		}
+	}
+}
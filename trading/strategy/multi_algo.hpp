@@ -0,0 +1,103 @@
+#pragma once
+
+#include <vector>
+
+#include "common/macros.hpp"
+#include "common/logging.hpp"
+
+#include "trading/strategy/feature_engine.hpp"
+#include "trading/strategy/order_manager.hpp"
+#include "trading/strategy/market_maker.hpp"
+#include "trading/strategy/liquidity_taker.hpp"
+
+using namespace Common;
+
+namespace Trading {
+
+	/// A strategy of a MultiAlgo and the tickers it trades.
+	struct StrategyCfg {
+		AlgoType m_algo_type = AlgoType::INVALID;
+		std::vector<TickerId> m_tickers;
+
+		bool operator==(const StrategyCfg&) const = default;
+
+		std::string toString() const;
+	};
+
+	/// StrategyCfg of "ALGO_TYPE:TICKER,TICKER...", as in strategy=TAKER:0,2.
+	StrategyCfg stringToStrategyCfg(const std::string& str);
+
+	/// Runs several strategies in one TradeEngine, so they share its books,
+	/// FeatureEngine and PositionKeeper, which are built once from the feed.
+	/// Strategy i keeps its orders in OrderManager slot i, responses go back to
+	/// the strategy owning the order. Book and trade updates of a ticker go to
+	/// the strategies trading it, market makers first, each through a direct
+	/// call. All strategies share the TradeEngineCfg, and the RiskManager, of a
+	/// ticker: a new order is checked against the position plus every slot's
+	/// working orders on its side, and is not sent if it would trade with an
+	/// order of another slot.
+	class MultiAlgo {
+		std::string m_time_str;
+		Common::Logger* m_logger = nullptr;
+		const OrderManager* m_order_manager = nullptr;
+
+		std::vector<MarketMaker*> m_makers;
+		std::vector<LiquidityTaker*> m_takers;
+
+		std::array<std::vector<MarketMaker*>, ME_MAX_TICKERS> m_ticker_makers;
+		std::array<std::vector<LiquidityTaker*>, ME_MAX_TICKERS> m_ticker_takers;
+
+		/// Strategy owning each OrderManager slot, one of the two per used slot.
+		std::array<MarketMaker*, OM_MAX_STRATEGIES> m_slot_makers = {};
+		std::array<LiquidityTaker*, OM_MAX_STRATEGIES> m_slot_takers = {};
+
+	public:
+		MultiAlgo(Common::Logger* logger, const FeatureEngine* feature_engine,
+			OrderManager* order_manager, const TradeEngineCfgHashMap& ticker_cfg,
+			const std::vector<StrategyCfg>& strategies);
+		~MultiAlgo();
+
+		MultiAlgo() = delete;
+		MultiAlgo(const MultiAlgo&) = delete;
+		MultiAlgo(const MultiAlgo&&) = delete;
+		MultiAlgo& operator=(const MultiAlgo&) = delete;
+		MultiAlgo& operator=(const MultiAlgo&&) = delete;
+
+		void reset(const TradeEngineCfgHashMap& ticker_cfg) noexcept {
+			for (auto maker : m_makers)
+				maker->reset(ticker_cfg);
+			for (auto taker : m_takers)
+				taker->reset(ticker_cfg);
+		}
+
+		void onOrderBookUpdate(TickerId ticker_id, Price price, Side side,
+			const MarketOrderBook* book) noexcept {
+			for (auto maker : m_ticker_makers[ticker_id])
+				maker->onOrderBookUpdate(ticker_id, price, side, book);
+			for (auto taker : m_ticker_takers[ticker_id])
+				taker->onOrderBookUpdate(ticker_id, price, side, book);
+		}
+
+		void onTradeUpdate(const Exchange::MEMarketUpdate* market_update,
+			MarketOrderBook* book) noexcept {
+			for (auto maker : m_ticker_makers[market_update->m_ticker_id])
+				maker->onTradeUpdate(market_update, book);
+			for (auto taker : m_ticker_takers[market_update->m_ticker_id])
+				taker->onTradeUpdate(market_update, book);
+		}
+
+		void onOrderUpdate(const Exchange::MEClientResponse* client_response) noexcept {
+			const auto slot = m_order_manager->slotOf(client_response);
+			if (slot == OM_MAX_STRATEGIES) [[unlikely]] {
+				m_logger->log("%:% %() % No strategy for %\n", __FILE__, __LINE__,
+					__FUNCTION__, Common::getCurrentTimeStr(&m_time_str),
+					client_response->toString().c_str());
+				return;
+			}
+			if (m_slot_makers[slot])
+				m_slot_makers[slot]->onOrderUpdate(client_response, slot);
+			else if (m_slot_takers[slot])
+				m_slot_takers[slot]->onOrderUpdate(client_response, slot);
+		}
+	};
+}
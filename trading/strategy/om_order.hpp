@@ -57,4 +57,8 @@ namespace Trading {
 
 	typedef std::array<OMOrder, sideToIndex(Side::BUY) + 1> OMOrderSideHashMap;
 	typedef std::array<OMOrderSideHashMap, ME_MAX_TICKERS> OMOrderTickerSideHashMap;
+
+	/// Strategies one OrderManager keeps orders for, each in its own slot.
+	constexpr size_t OM_MAX_STRATEGIES = 4;
+	typedef std::array<OMOrderTickerSideHashMap, OM_MAX_STRATEGIES> OMOrderStrategyTickerSideHashMap;
 }
@@ -9,12 +9,27 @@ namespace Trading {
 		m_trade_engine(trade_engine), m_risk_manager(risk_manager), m_logger(logger) {
 	}
 
+	void OrderManager::reset() noexcept {
+		m_strategy_ticker_side_order = {};
+		m_next_order_id = 1;
+	}
+
 	void OrderManager::onOrderUpdate(const Exchange::MEClientResponse* client_response)
 		noexcept {
+		onOrderUpdate(client_response, slotOf(client_response));
+	}
+
+	void OrderManager::onOrderUpdate(const Exchange::MEClientResponse* client_response,
+		size_t slot) noexcept {
 		m_logger->log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__,
 			Common::getCurrentTimeStr(&m_time_str), client_response->toString().c_str());
 
-		auto order = &(m_ticker_side_order.at(client_response->m_ticker_id).
+		if (slot == OM_MAX_STRATEGIES) [[unlikely]] {
+			m_logger->log("%:% %() % No order for %\n", __FILE__, __LINE__, __FUNCTION__,
+				Common::getCurrentTimeStr(&m_time_str), client_response->toString().c_str());
+			return;
+		}
+		auto order = &(m_strategy_ticker_side_order[slot].at(client_response->m_ticker_id).
 			at(sideToIndex(client_response->m_side)));
 
 		m_logger->log("%: % %() % %\n", __FILE__, __LINE__, __FUNCTION__,
@@ -44,14 +59,23 @@ namespace Trading {
 		}
 	}
 
-	auto OrderManager::getOMOrderSideHashMap(TickerId ticker_id) const {
-		return &(m_ticker_side_order.at(ticker_id));
+	size_t OrderManager::slotOf(const Exchange::MEClientResponse* client_response) const
+		noexcept {
+		for (size_t slot = 0; slot < OM_MAX_STRATEGIES; ++slot) {
+			const auto& order = m_strategy_ticker_side_order[slot].at(
+				client_response->m_ticker_id).at(sideToIndex(client_response->m_side));
+			if (order.m_order_id == client_response->m_client_order_id)
+				return slot;
+		}
+		return OM_MAX_STRATEGIES;
 	}
 
 	void OrderManager::newOrder(OMOrder* order, TickerId ticker_id,
 		Price price, Side side, Qty qty) noexcept {
 		const Exchange::MEClientRequest new_request{ Exchange::ClientRequestType::NEW,
 			m_trade_engine->clientId(), ticker_id, m_next_order_id, side, price, qty };
+		Common::trace(Common::TraceHop::OM_NEW_ORDER, Common::traceOrderKey(
+			new_request.m_client_id, new_request.m_order_id), Common::t_trace_key);
 		m_trade_engine->sendClientRequest(&new_request);
 
 		*order = { ticker_id, m_next_order_id, side, price, qty,
@@ -74,8 +98,38 @@ namespace Trading {
 			__FUNCTION__, Common::getCurrentTimeStr(&m_time_str),
 			cancel_request.toString().c_str(), order->toString().c_str());
 	}
+	Qty OrderManager::workingQty(TickerId ticker_id, Side side) const noexcept {
+		Qty working_qty = 0;
+		for (const auto& ticker_side_order : m_strategy_ticker_side_order) {
+			const auto& order = ticker_side_order.at(ticker_id).at(sideToIndex(side));
+			if (order.m_order_state == OMOrderState::PENDING_NEW ||
+				order.m_order_state == OMOrderState::LIVE ||
+				order.m_order_state == OMOrderState::PENDING_CANCEL)
+				working_qty += order.m_qty;
+		}
+		return working_qty;
+	}
+
+	bool OrderManager::crossesOtherSlot(TickerId ticker_id, Price price, Side side,
+		size_t slot) const noexcept {
+		const auto other_side = (side == Side::BUY) ? Side::SELL : Side::BUY;
+		for (size_t other_slot = 0; other_slot < OM_MAX_STRATEGIES; ++other_slot) {
+			if (other_slot == slot)
+				continue;
+			const auto& order = m_strategy_ticker_side_order[other_slot].at(ticker_id).
+				at(sideToIndex(other_side));
+			if (order.m_order_state != OMOrderState::PENDING_NEW &&
+				order.m_order_state != OMOrderState::LIVE &&
+				order.m_order_state != OMOrderState::PENDING_CANCEL)
+				continue;
+			if ((side == Side::BUY) ? price >= order.m_price : price <= order.m_price)
+				return true;
+		}
+		return false;
+	}
+
 	void OrderManager::moveOrder(OMOrder* order, TickerId ticker_id,
-		Price price, Side side, Qty qty) noexcept {
+		Price price, Side side, Qty qty, size_t slot) noexcept {
 		switch (order->m_order_state) {
 		case OMOrderState::LIVE:
 		{
@@ -87,7 +141,16 @@ namespace Trading {
 		case OMOrderState::DEAD:
 		{
 			if (price != Price_INVALID) [[likely]] {
-				const auto risk_result = m_risk_manager.checkPreTradeRisk(ticker_id, side, qty);
+				// Strategies of a MultiAlgo trading the same ticker must not trade with
+				// each other.
+				if (crossesOtherSlot(ticker_id, price, side, slot)) [[unlikely]] {
+					m_logger->log("%: % %() % Ticker: % Side: % Price: % crosses another slot\n",
+						__FILE__, __LINE__, __FUNCTION__, Common::getCurrentTimeStr(&m_time_str),
+						tickerIdToString(ticker_id), sideToString(side), priceToString(price));
+					break;
+				}
+				const auto risk_result = m_risk_manager.checkPreTradeRisk(ticker_id, side, qty,
+					workingQty(ticker_id, side));
 				if (risk_result == RiskCheckResult::ALLOWED) [[likely]] {
 					newOrder(order, ticker_id, price, side, qty);
 				}
@@ -110,11 +173,12 @@ namespace Trading {
 	}
 
 	void OrderManager::moveOrders(TickerId ticker_id, Price bid_price,
-		Price ask_price, Qty clip) noexcept {
+		Price ask_price, Qty clip, size_t slot) noexcept {
+		auto& ticker_side_order = m_strategy_ticker_side_order.at(slot);
 
-		auto bid_order = &(m_ticker_side_order.at(ticker_id).at(sideToIndex(Side::BUY)));
-		moveOrder(bid_order, ticker_id, bid_price, Side::BUY, clip);
-		auto ask_order = &(m_ticker_side_order.at(ticker_id).at(sideToIndex(Side::SELL)));
-		moveOrder(ask_order, ticker_id, bid_price, Side::SELL, clip);
+		auto bid_order = &(ticker_side_order.at(ticker_id).at(sideToIndex(Side::BUY)));
+		moveOrder(bid_order, ticker_id, bid_price, Side::BUY, clip, slot);
+		auto ask_order = &(ticker_side_order.at(ticker_id).at(sideToIndex(Side::SELL)));
+		moveOrder(ask_order, ticker_id, ask_price, Side::SELL, clip, slot);
 	}
 }
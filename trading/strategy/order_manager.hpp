@@ -24,18 +24,31 @@ namespace Trading {
 		std::string m_time_str;
 		Common::Logger* m_logger;
 
-		OMOrderTickerSideHashMap m_ticker_side_order;
+		OMOrderStrategyTickerSideHashMap m_strategy_ticker_side_order;
 		OrderId m_next_order_id = 1;
 
-		auto getOMOrderSideHashMap(TickerId ticker_id) const;
 		void moveOrder(OMOrder* order, TickerId ticker_id, 
-			Price price, Side side, Qty qty) noexcept;
+			Price price, Side side, Qty qty, size_t slot) noexcept;
+		/// Quantity of the orders on side of every slot that may still fill.
+		Qty workingQty(TickerId ticker_id, Side side) const noexcept;
+		/// Whether an order at price on side would trade with one of another slot.
+		bool crossesOtherSlot(TickerId ticker_id, Price price, Side side,
+			size_t slot) const noexcept;
 
 	public: 
 		OrderManager(Common::Logger* logger, TradeEngine* trade_engine, RiskManager& risk_manager);
+		/// Forgets every order, ids start from 1 again.
+		void reset() noexcept;
 		void onOrderUpdate(const Exchange::MEClientResponse* client_response) noexcept;
-
-		void moveOrders(TickerId ticker_id, Price bid_price, Price ask_price, Qty clip) noexcept;
+		/// client_response is for the order in slot, as slotOf() found.
+		void onOrderUpdate(const Exchange::MEClientResponse* client_response,
+			size_t slot) noexcept;
+		/// Slot of the order client_response is for, OM_MAX_STRATEGIES if none.
+		size_t slotOf(const Exchange::MEClientResponse* client_response) const noexcept;
+
+		/// Moves the strategy's orders in slot, 0 when it trades alone.
+		void moveOrders(TickerId ticker_id, Price bid_price, Price ask_price, Qty clip,
+			size_t slot = 0) noexcept;
 		void newOrder(OMOrder* order, TickerId ticker_id, 
 			Price price, Side side, Qty qty) noexcept;
 		void cancelOrder(OMOrder* order) noexcept;
@@ -15,7 +15,7 @@ namespace Trading {
 
 		int32_t m_position = 0;
 		double m_real_pnl = 0, m_unreal_pnl = 0, m_total_pnl = 0;
-		std::array<double, sideToIndex(Side::BUY) + 1> m_open_vwap;
+		std::array<double, sideToIndex(Side::BUY) + 1> m_open_vwap = {};
 		Qty m_volume = 0;
 		const BBO* m_bbo = nullptr;
 
@@ -118,6 +118,8 @@ namespace Trading {
 	public:
 		PositionKeeper(Common::Logger* logger) : m_logger(logger) {};
 
+		auto reset() noexcept { m_ticker_position = {}; }
+
 		auto getPositionInfo(TickerId ticker_id) const noexcept {
 			return &(m_ticker_position.at(ticker_id));
 		}
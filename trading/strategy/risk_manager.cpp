@@ -11,13 +11,14 @@ namespace Trading {
 		return ss.str();
 	}
 
-	RiskCheckResult RiskInfo::checkPreTradeRisk(Side side, Qty qty) const noexcept {
+	RiskCheckResult RiskInfo::checkPreTradeRisk(Side side, Qty qty, Qty working_qty) const
+		noexcept {
 
 		if (qty > m_risk_cfg.m_max_order_size) [[unlikely]]
 			return RiskCheckResult::ORDER_TOO_LARGE;
 
 		if (std::abs(m_position_info->m_position + 
-			sideToValue(side) * static_cast<int32_t>(qty)) > 
+			sideToValue(side) * static_cast<int32_t>(working_qty + qty)) > 
 			static_cast<int32_t>(m_risk_cfg.m_max_position)) [[unlikely]]
 			return RiskCheckResult::POSITION_TOO_LARGE;
 
@@ -35,8 +36,25 @@ namespace Trading {
 			m_ticker_risk.at(i).m_risk_cfg = ticker_cfg[i].m_risk_cfg;
 		}
 	}
+
+	void RiskManager::reset(const TradeEngineCfgHashMap& ticker_cfg) noexcept {
+		for (TickerId i = 0; i < ME_MAX_TICKERS; i++)
+			m_ticker_risk.at(i).m_risk_cfg = ticker_cfg[i].m_risk_cfg;
+	}
+
 	RiskCheckResult RiskManager::checkPreTradeRisk(TickerId ticker_id, 
-		Side side, Qty qty) const noexcept {
-		return m_ticker_risk.at(ticker_id).checkPreTradeRisk(side, qty);
+		Side side, Qty qty, Qty working_qty) const noexcept {
+		const auto result = m_ticker_risk.at(ticker_id).checkPreTradeRisk(side, qty,
+			working_qty);
+		if (result != RiskCheckResult::ALLOWED) [[unlikely]]
+			m_num_rejects[size_t(result)].inc();
+		return result;
+	}
+
+	void RiskManager::registerMetrics(Common::MetricsRegistry& metrics) {
+		for (size_t i = 1; i < m_num_rejects.size(); ++i) {
+			metrics.addCounter("risk.rejects." + std::string(riskCheckResultToString(
+				static_cast<RiskCheckResult>(i))), &m_num_rejects[i]);
+		}
 	}
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "common/types.hpp"
 #include "common/macros.hpp"
 #include "common/logging.hpp"
+#include "common/metrics.hpp"
 
 #include "trading/strategy/position_keeper.hpp"
 #include "trading/strategy/om_order.hpp"
@@ -40,7 +41,8 @@ namespace Trading {
 
 		std::string toString() const;
 
-		RiskCheckResult checkPreTradeRisk(Side side, Qty qty) const noexcept;
+		/// working_qty is of the orders already out on side, which may fill first.
+		RiskCheckResult checkPreTradeRisk(Side side, Qty qty, Qty working_qty) const noexcept;
 	};
 
 	typedef std::array<RiskInfo, ME_MAX_TICKERS> TickerRiskInfoHashMap;
@@ -52,11 +54,20 @@ namespace Trading {
 
 		TickerRiskInfoHashMap m_ticker_risk;
 
+		/// Failed checks by RiskCheckResult.
+		mutable std::array<Common::MetricCounter, size_t(RiskCheckResult::ALLOWED)> m_num_rejects;
+
 	public:
 		RiskManager(Common::Logger* logger, const PositionKeeper* position_keeper,
 			const TradeEngineCfgHashMap& ticker_cfg);
 
-		RiskCheckResult checkPreTradeRisk(TickerId ticker_id, Side side, Qty qty) const noexcept;
+		/// Takes the limits of ticker_cfg instead.
+		void reset(const TradeEngineCfgHashMap& ticker_cfg) noexcept;
+
+		RiskCheckResult checkPreTradeRisk(TickerId ticker_id, Side side, Qty qty,
+			Qty working_qty = 0) const noexcept;
+
+		void registerMetrics(Common::MetricsRegistry& metrics);
 	};
 
 }
\ No newline at end of file
@@ -3,11 +3,11 @@
 
 namespace Trading {
 
-	TradeEngine::TradeEngine(Common::ClientId client_id, AlgoType algo_type,
+	TradeEngine::TradeEngine(Common::ClientId client_id,
 		const TradeEngineCfgHashMap& ticker_cfg,
 		Exchange::ClientRequestLFQueue* client_requests,
-		Exchange::ClientResponseLFQueue* client_responses,
-		Exchange::MEMarketUpdateLFQueue* market_updates) :
+		RecvTimeClientResponseLFQueue* client_responses,
+		RecvTimeMarketUpdateLFQueue* market_updates) :
 		m_client_id(client_id), m_outgoing_ogw_requests(client_requests),
 		m_incoming_ogw_responses(client_responses), m_incoming_md_updates(market_updates),
 		m_logger("trading_engine_" + std::to_string(client_id) + ".log"),
@@ -15,40 +15,23 @@ namespace Trading {
 		m_order_manager(&m_logger, this, m_risk_manager),
 		m_risk_manager(&m_logger, &m_position_keeper, ticker_cfg) {
 
-		f_algoOnOrderBookUpdate = [this]
-		(auto ticker_id, auto price, auto side, auto book) {
-			defaultAlgoOnOrderBookUpdate(ticker_id, price, side, book);	};
-
-		f_algoOnTradeUpdate = [this](auto market_update, auto book) {
-			defaultAlgoOnTradeUpdate(market_update, book); };
-
-		f_algoOnOrderUpdate = [this](auto client_response) {
-			defaultAlgoOnOrderUpdate(client_response);	};
-
-		if (algo_type == AlgoType::MAKER) {
-			m_mm_algo = new MarketMaker(&m_logger, this, &m_feature_engine,
-				&m_order_manager, ticker_cfg);
-		}
-		else if (algo_type == AlgoType::TAKER) {
-			m_taker_algo = new LiquidityTaker(&m_logger, this,
-				&m_feature_engine, &m_order_manager, ticker_cfg);
-		}
+		for (TickerId i = 0; i < m_ticker_order_book.size(); ++i)
+			m_ticker_order_book[i] = new MarketOrderBook(i, &m_logger);
 
 		for (TickerId i = 0; i < ticker_cfg.size(); i++) {
-			m_logger.log("%:% %() % Initialized % Ticker:% %.\n", __FILE__, __LINE__,
-				__FUNCTION__, Common::getCurrentTimeStr(&m_time_str),
-				algoTypeToString(algo_type), i, ticker_cfg.at(i).toString());
+			m_logger.log("%:% %() % Initialized Ticker:% %.\n", __FILE__, __LINE__,
+				__FUNCTION__, Common::getCurrentTimeStr(&m_time_str), i,
+				ticker_cfg.at(i).toString());
 		}
 	}
 
 	TradeEngine::~TradeEngine() {
-		m_run = false;
-
-		using namespace std::literals::chrono_literals;
-		std::this_thread::sleep_for(1s);
+		joinThread();
 
-		delete m_mm_algo; m_mm_algo = nullptr;
-		delete m_taker_algo; m_taker_algo = nullptr;
+		m_logger.log("%:% %() % onOrderUpdate ns % onMarketUpdate ns %\n", __FILE__, __LINE__,
+			__FUNCTION__, Common::getCurrentTimeStr(&m_time_str),
+			m_order_update_latency.snapshot().toString(Common::tscPerNano()),
+			m_market_update_latency.snapshot().toString(Common::tscPerNano()));
 
 		for (auto& order_book : m_ticker_order_book) {
 			delete order_book;
@@ -60,10 +43,30 @@ namespace Trading {
 		m_incoming_md_updates = nullptr;
 	}
 
-	void TradeEngine::start() {
+	void TradeEngine::reset(const TradeEngineCfgHashMap& ticker_cfg) noexcept {
+		ASSERT(!m_thread, "TradeEngine reset while running.");
+		for (auto order_book : m_ticker_order_book)
+			order_book->reset();
+		m_feature_engine.reset();
+		m_position_keeper.reset();
+		m_order_manager.reset();
+		m_risk_manager.reset(ticker_cfg);
+		m_last_event_time = m_last_event_recv_time = 0;
+	}
+
+	void TradeEngine::start(int core_id) {
 		m_run = true;
-		ASSERT(Common::createAndStartThread(-1, "Trading/TradeEngine",
-			[this] {run(); }) != nullptr, "Failed to start TradeEngine thread.");
+		m_thread = Common::createAndStartThread(core_id, "Trading/TradeEngine",
+			[this] {run(); });
+		ASSERT(m_thread != nullptr, "Failed to start TradeEngine thread.");
+	}
+
+	void TradeEngine::joinThread() {
+		m_run = false;
+		if (m_thread) {
+			m_thread->join();
+			delete m_thread; m_thread = nullptr;
+		}
 	}
 
 	void TradeEngine::stop() {
@@ -82,66 +85,37 @@ namespace Trading {
 		m_run = false;
 	}
 
-	void TradeEngine::run() noexcept {
-		m_logger.log("%: % %() %\n", __FILE__, __LINE__,
-			__FUNCTION__, Common::getCurrentTimeStr(&m_time_str));
-
-		while (m_run) {
-			for (auto client_response = m_incoming_ogw_responses->getNextToRead();
-				client_response; client_response = m_incoming_ogw_responses->getNextToRead()) {
-				m_logger.log("%:% %() % Processing %\n", __FILE__, __LINE__,
-					__FUNCTION__, Common::getCurrentTimeStr(&m_time_str),
-					client_response->toString().c_str());
-
-				onOrderUpdate(client_response);
-				m_incoming_ogw_responses->updateReadIndex();
-				m_last_event_time = Common::getCurrentNanos();
+	void TradeEngine::registerMetrics(Common::MetricsRegistry& metrics) {
+		metrics.addCounter("te.order_updates", &m_num_order_updates);
+		metrics.addCounter("te.market_updates", &m_num_market_updates);
+		metrics.addCounter("te.capture_drops", &m_num_capture_drops);
+		metrics.addHistogram("te.order_update_ns", &m_order_update_latency,
+			Common::tscPerNano());
+		metrics.addHistogram("te.market_update_ns", &m_market_update_latency,
+			Common::tscPerNano());
+		metrics.addGauge("te.incoming_ogw_responses",
+			[this]() { return m_incoming_ogw_responses->size(); });
+		metrics.addGauge("te.incoming_md_updates",
+			[this]() { return m_incoming_md_updates->size(); });
+		metrics.addGauge("te.outgoing_ogw_requests",
+			[this]() { return m_outgoing_ogw_requests->size(); });
+		metrics.addGauge("te.order_pool", [this]() {
+			size_t num_used = 0;
+			for (const auto order_book : m_ticker_order_book) {
+				if (order_book)
+					num_used += order_book->orderPool().numUsed();
 			}
-
-			for (auto market_update = m_incoming_md_updates->getNextToRead();
-				market_update; market_update = m_incoming_md_updates->getNextToRead()) {
-				m_logger.log("%:% %() % Processing %\n", __FILE__, __LINE__, __FUNCTION__,
-					Common::getCurrentTimeStr(&m_time_str), market_update->toString().c_str());
-				ASSERT(market_update->m_ticker_id < m_ticker_order_book.size(),
-					"Uknown ticker-id on update:" + market_update->toString());
-				m_ticker_order_book[market_update->m_ticker_id]->onMarketUpdate(market_update);
-				m_incoming_md_updates->updateReadIndex();
-				m_last_event_time = Common::getCurrentNanos();
+			return num_used;
+		});
+		metrics.addGauge("te.orders_at_price_pool", [this]() {
+			size_t num_used = 0;
+			for (const auto order_book : m_ticker_order_book) {
+				if (order_book)
+					num_used += order_book->ordersAtPricePool().numUsed();
 			}
-		}
-	}
-
-	void TradeEngine::onOrderBookUpdate(TickerId ticker_id, Price price,
-		Side side, MarketOrderBook* book) noexcept {
-		m_logger.log("%:% %() % ticker:% price:% side:%\n", __FILE__, __LINE__,
-			__FUNCTION__, Common::getCurrentTimeStr(&m_time_str), ticker_id,
-			Common::priceToString(price).c_str(), Common::sideToString(side).c_str());
-
-		const auto bbo = book->getBBO();
-		m_position_keeper.updateBBO(ticker_id, bbo);
-		m_feature_engine.onOrderBookUpdate(ticker_id, price, side, book);
-		f_algoOnOrderBookUpdate(ticker_id, price, side, book);
-	}
-
-	void TradeEngine::onTradeUpdate(const Exchange::MEMarketUpdate* market_update,
-		MarketOrderBook* book) noexcept {
-		m_logger.log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__, 
-			Common::getCurrentTimeStr(&m_time_str), market_update->toString().c_str());
-
-		m_feature_engine.onTradeUpdate(market_update, book);
-		f_algoOnTradeUpdate(market_update, book);
-	}
-
-	void TradeEngine::onOrderUpdate(const Exchange::MEClientResponse* client_response)
-		noexcept {
-		m_logger.log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__,
-			Common::getCurrentTimeStr(&m_time_str), client_response->toString().c_str());
-
-		if (client_response->m_type == Exchange::ClientResponseType::FILLED) [[unlikely]] {
-			m_position_keeper.addFill(client_response);
-		}
-
-		f_algoOnOrderUpdate(client_response);
+			return num_used;
+		});
+		m_risk_manager.registerMetrics(metrics);
 	}
 
 	auto TradeEngine::silentSeconds() {
@@ -158,26 +132,35 @@ namespace Trading {
 		m_outgoing_ogw_requests->updateWriteIndex();
 	}
 
-	void TradeEngine::defaultAlgoOnOrderBookUpdate(TickerId ticker_id,
-		Price price, Side side, const MarketOrderBook* book) {
-		m_logger.log("%: % %() % ticker: % price: % side: %\n", __FILE__,
-			__LINE__, __FUNCTION__, Common::getCurrentTimeStr(&m_time_str),
-			ticker_id, Common::priceToString(price).c_str(),
-			Common::sideToString(side).c_str());
-	}
+	template class StrategyTradeEngine<DefaultAlgo>;
+	template class StrategyTradeEngine<MarketMaker>;
+	template class StrategyTradeEngine<LiquidityTaker>;
+	template class StrategyTradeEngine<MultiAlgo>;
 
-	void TradeEngine::defaultAlgoOnTradeUpdate(
-		const Exchange::MEMarketUpdate* market_update, MarketOrderBook* book) {
-		m_logger.log("%: % %() % %\n", __FILE__, __LINE__, __FUNCTION__,
-			Common::getCurrentTimeStr(&m_time_str),
-			market_update->toString().c_str());
+	TradeEngine* createTradeEngine(Common::ClientId client_id, AlgoType algo_type,
+		const TradeEngineCfgHashMap& ticker_cfg,
+		Exchange::ClientRequestLFQueue* client_requests,
+		RecvTimeClientResponseLFQueue* client_responses,
+		RecvTimeMarketUpdateLFQueue* market_updates) {
+		switch (algo_type) {
+		case AlgoType::MAKER:
+			return new StrategyTradeEngine<MarketMaker>(client_id, ticker_cfg,
+				client_requests, client_responses, market_updates);
+		case AlgoType::TAKER:
+			return new StrategyTradeEngine<LiquidityTaker>(client_id, ticker_cfg,
+				client_requests, client_responses, market_updates);
+		default:
+			return new StrategyTradeEngine<DefaultAlgo>(client_id, ticker_cfg,
+				client_requests, client_responses, market_updates);
+		}
 	}
 
-	void TradeEngine::defaultAlgoOnOrderUpdate(
-		const Exchange::MEClientResponse* client_response) {
-		m_logger.log("%: % %() % %\n", __FILE__, __LINE__, __FUNCTION__,
-			Common::getCurrentTimeStr(&m_time_str),
-			client_response->toString().c_str());
+	TradeEngine* createTradeEngine(Common::ClientId client_id,
+		const std::vector<StrategyCfg>& strategies, const TradeEngineCfgHashMap& ticker_cfg,
+		Exchange::ClientRequestLFQueue* client_requests,
+		RecvTimeClientResponseLFQueue* client_responses,
+		RecvTimeMarketUpdateLFQueue* market_updates) {
+		return new StrategyTradeEngine<MultiAlgo>(client_id, ticker_cfg, client_requests,
+			client_responses, market_updates, strategies);
 	}
-
-}
+}
\ No newline at end of file
@@ -1,17 +1,21 @@
 #pragma once
 
-#include <functional>
-
 #include "common/thread_utils.hpp"
 #include "common/time_utils.hpp"
 #include "common/lf_queue.hpp"
 #include "common/macros.hpp"
 #include "common/logging.hpp"
+#include "common/latency_histogram.hpp"
+#include "common/metrics.hpp"
+#include "common/trace.hpp"
 
 #include "exchange/order_server/client_request.hpp"
 #include "exchange/order_server/client_response.hpp"
 #include "exchange/market_data/market_update.hpp"
 
+#include "trading/market_data/recv_time_market_update.hpp"
+#include "trading/order_gw/recv_time_client_response.hpp"
+
 #include "trading/strategy/market_order_book.hpp"
 #include "trading/strategy/feature_engine.hpp"
 #include "trading/strategy/position_keeper.hpp"
@@ -19,22 +23,76 @@
 #include "trading/strategy/risk_manager.hpp"
  
 #include "trading/strategy/market_maker.hpp"
-#include "trading/strategy/liquidity_taker.hpp""
+#include "trading/strategy/liquidity_taker.hpp"
+#include "trading/strategy/multi_algo.hpp"
 
 
 namespace Trading {
 
+	/// What a TradeEngine without a strategy does with events: logs them.
+	class DefaultAlgo {
+		std::string m_time_str;
+		Common::Logger* m_logger = nullptr;
+
+	public:
+		DefaultAlgo(Common::Logger* logger, const FeatureEngine* /*feature_engine*/,
+			OrderManager* /*order_manager*/, const TradeEngineCfgHashMap& /*ticker_cfg*/) :
+			m_logger(logger) {
+		}
+
+		auto reset(const TradeEngineCfgHashMap& /*ticker_cfg*/) noexcept {
+		}
+
+		auto onOrderBookUpdate(TickerId ticker_id, Price price, Side side,
+			const MarketOrderBook* /*book*/) noexcept {
+			m_logger->log("%: % %() % ticker: % price: % side: %\n", __FILE__,
+				__LINE__, __FUNCTION__, Common::getCurrentTimeStr(&m_time_str),
+				ticker_id, Common::priceToString(price).c_str(),
+				Common::sideToString(side).c_str());
+		}
+
+		auto onTradeUpdate(const Exchange::MEMarketUpdate* market_update,
+			MarketOrderBook* /*book*/) noexcept {
+			m_logger->log("%: % %() % %\n", __FILE__, __LINE__, __FUNCTION__,
+				Common::getCurrentTimeStr(&m_time_str),
+				market_update->toString().c_str());
+		}
+
+		auto onOrderUpdate(const Exchange::MEClientResponse* client_response) noexcept {
+			m_logger->log("%: % %() % %\n", __FILE__, __LINE__, __FUNCTION__,
+				Common::getCurrentTimeStr(&m_time_str),
+				client_response->toString().c_str());
+		}
+	};
+
+	/// Books, features, positions, orders and risk of one client, and the queues
+	/// to its gateway and market data. The event loop and the strategy it calls
+	/// are in StrategyTradeEngine, made by createTradeEngine().
 	class TradeEngine {
+	protected:
 		const ClientId m_client_id;
 
 		MarketOrderBookHashMap m_ticker_order_book;
 		
 		Exchange::ClientRequestLFQueue* m_outgoing_ogw_requests = nullptr;
-		Exchange::ClientResponseLFQueue* m_incoming_ogw_responses = nullptr;
-		Exchange::MEMarketUpdateLFQueue* m_incoming_md_updates = nullptr;
+		RecvTimeClientResponseLFQueue* m_incoming_ogw_responses = nullptr;
+		RecvTimeMarketUpdateLFQueue* m_incoming_md_updates = nullptr;
+		/// Copies of what was processed for a MarketDataCapture, if any.
+		RecvTimeMarketUpdateLFQueue* m_capture_md_updates = nullptr;
+		RecvTimeClientResponseLFQueue* m_capture_client_responses = nullptr;
 
 		Nanos m_last_event_time = 0;
+		Nanos m_last_event_recv_time = 0;
 		volatile bool m_run = false;
+		std::thread* m_thread = nullptr;
+
+		/// TSC ticks spent handling each event in run().
+		Common::LatencyRecorder m_order_update_latency;
+		Common::LatencyRecorder m_market_update_latency;
+		Common::MetricCounter m_num_order_updates;
+		Common::MetricCounter m_num_market_updates;
+		/// Events not captured because the capture queue was full.
+		Common::MetricCounter m_num_capture_drops;
 
 		std::string m_time_str;
 		Logger m_logger;
@@ -44,48 +102,226 @@ namespace Trading {
 		OrderManager m_order_manager;
 		RiskManager m_risk_manager;
 
-		MarketMaker *m_mm_algo = nullptr;
-		LiquidityTaker* m_taker_algo = nullptr;
 
+		template<typename T>
+		auto capture(Common::LFQueue<T>* queue, const T& event) noexcept {
+			if (!queue)
+				return;
+			// The engine never waits on the capture, a full queue loses the event.
+			if (queue->size() + 1 >= queue->capacity()) [[unlikely]] {
+				m_num_capture_drops.inc();
+				return;
+			}
+			*queue->getNextToWriteTo() = event;
+			queue->updateWriteIndex();
+		}
 
-		void defaultAlgoOnOrderBookUpdate(TickerId ticker_id, Price price, Side side,
-			const MarketOrderBook* book);
-		void defaultAlgoOnTradeUpdate(const Exchange::MEMarketUpdate* market_update,
-			MarketOrderBook* book);
-		void defaultAlgoOnOrderUpdate(const Exchange::MEClientResponse* client_response);
+		/// Stops and joins the thread, if start() made one.
+		void joinThread();
 
-		void run() noexcept;
+		virtual void run() noexcept = 0;
 
+		TradeEngine(Common::ClientId client_id, const TradeEngineCfgHashMap& ticker_cfg,
+			Exchange::ClientRequestLFQueue* client_requests,
+			RecvTimeClientResponseLFQueue* client_responses,
+			RecvTimeMarketUpdateLFQueue* market_updates);
 
 	public:
-		std::function<void(TickerId ticker_id, Price price, Side side,
-			const MarketOrderBook* book)> f_algoOnOrderBookUpdate;
-		std::function<void(const Exchange::MEMarketUpdate* market_update,
-			MarketOrderBook* book)> f_algoOnTradeUpdate;
-		std::function<void(const Exchange::MEClientResponse* client_response)>
-			f_algoOnOrderUpdate;
-
-		TradeEngine(Common::ClientId client_id, AlgoType algo_type, 
-			const TradeEngineCfgHashMap& ticker_cfg, 
-			Exchange::ClientRequestLFQueue* client_requests, 
-			Exchange::ClientResponseLFQueue* client_responses, 
-			Exchange::MEMarketUpdateLFQueue* market_updates);
-		~TradeEngine();
-
-		void start();
+		virtual ~TradeEngine();
+
+		TradeEngine() = delete;
+		TradeEngine(const TradeEngine&) = delete;
+		TradeEngine(const TradeEngine&&) = delete;
+		TradeEngine& operator=(const TradeEngine&) = delete;
+		TradeEngine& operator=(const TradeEngine&&) = delete;
+
+		/// core_id -1 leaves the thread unpinned.
+		void start(int core_id = -1);
 		void stop();
 
+		/// Tees every processed market update and client response into these
+		/// queues, set before start().
+		auto setCaptureQueues(RecvTimeMarketUpdateLFQueue* market_updates,
+			RecvTimeClientResponseLFQueue* client_responses) noexcept {
+			m_capture_md_updates = market_updates;
+			m_capture_client_responses = client_responses;
+		}
+
 		void sendClientRequest(const Exchange::MEClientRequest* client_request) noexcept;
 
 		auto initLastEventTime() { m_last_event_time = Common::getCurrentNanos(); }
 		auto silentSeconds();
 		auto clientId() const { return m_client_id; }
+		/// Socket receive time of the update or response being processed, for
+		/// wire to strategy latency.
+		auto lastEventRecvTime() const { return m_last_event_recv_time; }
+
+		const auto& positionKeeper() const noexcept { return m_position_keeper; }
+
+		/// Back to the state of a new engine trading ticker_cfg, but for its
+		/// metrics. Not while the thread runs.
+		virtual void reset(const TradeEngineCfgHashMap& ticker_cfg) noexcept;
+
+		const auto& orderUpdateLatency() const noexcept { return m_order_update_latency; }
+		const auto& marketUpdateLatency() const noexcept { return m_market_update_latency; }
+		void registerMetrics(Common::MetricsRegistry& metrics);
+
+		/// What run() does with each response and update, now being the time it is
+		/// handled at. Lets a Backtester drive the engine on simulated time, at one
+		/// virtual call per event, run() itself calls them directly.
+		virtual void processClientResponse(const RecvTimeClientResponse* client_response,
+			Nanos now) noexcept = 0;
+		virtual void processMarketUpdate(const RecvTimeMarketUpdate* market_update,
+			Nanos now) noexcept = 0;
+	};
 
-		void onOrderBookUpdate(TickerId ticker_id, Price price, 
-			Side side, MarketOrderBook* book) noexcept;
-		void onTradeUpdate(const Exchange::MEMarketUpdate* market_update, 
-			MarketOrderBook* book) noexcept;
-		void onOrderUpdate(const Exchange::MEClientResponse* client_response) noexcept;
+	/// TradeEngine calling Strategy without indirection, so the strategy's
+	/// handlers can be inlined into the event loop. Strategy is built from
+	/// (Common::Logger*, const FeatureEngine*, OrderManager*,
+	/// const TradeEngineCfgHashMap&) and any arguments after the engine's own, and
+	/// has onOrderBookUpdate(), onTradeUpdate() and onOrderUpdate(), see
+	/// DefaultAlgo, and reset() taking a new TradeEngineCfgHashMap.
+	template<typename Strategy>
+	class StrategyTradeEngine final : public TradeEngine {
+		Strategy m_strategy;
 
+		void run() noexcept override {
+			m_logger.log("%: % %() %\n", __FILE__, __LINE__,
+				__FUNCTION__, Common::getCurrentTimeStr(&m_time_str));
+
+			while (m_run) {
+				for (auto client_response = m_incoming_ogw_responses->getNextToRead();
+					client_response; client_response = m_incoming_ogw_responses->getNextToRead()) {
+					processClientResponse(client_response, Common::getCurrentNanos());
+					m_incoming_ogw_responses->updateReadIndex();
+				}
+
+				for (auto market_update = m_incoming_md_updates->getNextToRead();
+					market_update; market_update = m_incoming_md_updates->getNextToRead()) {
+					processMarketUpdate(market_update, Common::getCurrentNanos());
+					m_incoming_md_updates->updateReadIndex();
+				}
+			}
+		}
+
+		auto onOrderBookUpdate(TickerId ticker_id, Price price,
+			Side side, MarketOrderBook* book) noexcept {
+			m_logger.log("%:% %() % ticker:% price:% side:%\n", __FILE__, __LINE__,
+				__FUNCTION__, Common::getCurrentTimeStr(&m_time_str), ticker_id,
+				Common::priceToString(price).c_str(), Common::sideToString(side).c_str());
+
+			const auto bbo = book->getBBO();
+			m_position_keeper.updateBBO(ticker_id, bbo);
+			m_feature_engine.onOrderBookUpdate(ticker_id, price, side, book);
+			m_strategy.onOrderBookUpdate(ticker_id, price, side, book);
+		}
+
+		auto onTradeUpdate(const Exchange::MEMarketUpdate* market_update,
+			MarketOrderBook* book) noexcept {
+			m_logger.log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__,
+				Common::getCurrentTimeStr(&m_time_str), market_update->toString().c_str());
+
+			m_feature_engine.onTradeUpdate(market_update, book);
+			m_strategy.onTradeUpdate(market_update, book);
+		}
+
+		auto onOrderUpdate(const Exchange::MEClientResponse* client_response) noexcept {
+			m_logger.log("%:% %() % %\n", __FILE__, __LINE__, __FUNCTION__,
+				Common::getCurrentTimeStr(&m_time_str), client_response->toString().c_str());
+
+			if (client_response->m_type == Exchange::ClientResponseType::FILLED) [[unlikely]] {
+				m_position_keeper.addFill(client_response);
+			}
+
+			m_strategy.onOrderUpdate(client_response);
+		}
+
+	public:
+		template<typename... StrategyArgs>
+		StrategyTradeEngine(Common::ClientId client_id, const TradeEngineCfgHashMap& ticker_cfg,
+			Exchange::ClientRequestLFQueue* client_requests,
+			RecvTimeClientResponseLFQueue* client_responses,
+			RecvTimeMarketUpdateLFQueue* market_updates,
+			const StrategyArgs&... strategy_args) :
+			TradeEngine(client_id, ticker_cfg, client_requests, client_responses, market_updates),
+			m_strategy(&m_logger, &m_feature_engine, &m_order_manager, ticker_cfg,
+				strategy_args...) {
+		}
+
+		/// The thread runs this class' run(), it has to end before m_strategy does.
+		~StrategyTradeEngine() {
+			joinThread();
+		}
+
+		void reset(const TradeEngineCfgHashMap& ticker_cfg) noexcept override {
+			TradeEngine::reset(ticker_cfg);
+			m_strategy.reset(ticker_cfg);
+		}
+
+		void processClientResponse(const RecvTimeClientResponse* client_response,
+			Nanos now) noexcept override {
+			m_last_event_time = now;
+			m_last_event_recv_time = client_response->m_recv_time;
+			m_logger.log("%:% %() % Processing % wire_to_engine:%\n", __FILE__, __LINE__,
+				__FUNCTION__, Common::getCurrentTimeStr(&m_time_str),
+				client_response->toString().c_str(),
+				m_last_event_time - m_last_event_recv_time);
+
+			const auto start_tsc = Common::rdtsc();
+			onOrderUpdate(&client_response->m_client_response);
+			m_order_update_latency.record(Common::rdtsc() - start_tsc);
+			m_num_order_updates.inc();
+			capture(m_capture_client_responses, *client_response);
+		}
+
+		void processMarketUpdate(const RecvTimeMarketUpdate* market_update,
+			Nanos now) noexcept override {
+			m_last_event_time = now;
+			m_last_event_recv_time = market_update->m_recv_time;
+			Common::setTraceKey(m_last_event_recv_time);
+			Common::trace(Common::TraceHop::TE_DEQUEUE);
+			m_logger.log("%:% %() % Processing % wire_to_engine:%\n", __FILE__, __LINE__,
+				__FUNCTION__, Common::getCurrentTimeStr(&m_time_str),
+				market_update->toString().c_str(),
+				m_last_event_time - m_last_event_recv_time);
+
+			const auto start_tsc = Common::rdtsc();
+			const auto& me_market_update = market_update->m_market_update;
+			ASSERT(me_market_update.m_ticker_id < m_ticker_order_book.size(),
+				"Uknown ticker-id on update:" + me_market_update.toString());
+			auto book = m_ticker_order_book[me_market_update.m_ticker_id];
+			book->onMarketUpdate(&me_market_update);
+			if (me_market_update.m_type == Exchange::MarketUpdateType::TRADE) {
+				onTradeUpdate(&me_market_update, book);
+			}
+			else {
+				onOrderBookUpdate(me_market_update.m_ticker_id, me_market_update.m_price,
+					me_market_update.m_side, book);
+			}
+			m_market_update_latency.record(Common::rdtsc() - start_tsc);
+			m_num_market_updates.inc();
+			capture(m_capture_md_updates, *market_update);
+		}
 	};
+
+	/// Instantiated once each in trade_engine.cpp.
+	extern template class StrategyTradeEngine<DefaultAlgo>;
+	extern template class StrategyTradeEngine<MarketMaker>;
+	extern template class StrategyTradeEngine<LiquidityTaker>;
+	extern template class StrategyTradeEngine<MultiAlgo>;
+
+	/// TradeEngine running the strategy of algo_type, DefaultAlgo for types
+	/// without one.
+	TradeEngine* createTradeEngine(Common::ClientId client_id, AlgoType algo_type,
+		const TradeEngineCfgHashMap& ticker_cfg,
+		Exchange::ClientRequestLFQueue* client_requests,
+		RecvTimeClientResponseLFQueue* client_responses,
+		RecvTimeMarketUpdateLFQueue* market_updates);
+
+	/// TradeEngine running all of strategies in a MultiAlgo.
+	TradeEngine* createTradeEngine(Common::ClientId client_id,
+		const std::vector<StrategyCfg>& strategies, const TradeEngineCfgHashMap& ticker_cfg,
+		Exchange::ClientRequestLFQueue* client_requests,
+		RecvTimeClientResponseLFQueue* client_responses,
+		RecvTimeMarketUpdateLFQueue* market_updates);
 }
\ No newline at end of file
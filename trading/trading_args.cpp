@@ -0,0 +1,58 @@
+#include "trading/trading_args.hpp"
+
+#include <fstream>
+#include <sstream>
+
+namespace Trading {
+
+	namespace {
+		auto readConfigFile(const std::string& file_name, std::vector<std::string>* args) {
+			std::ifstream file(file_name);
+			ASSERT(file.good(), "Unable to open config file " + file_name);
+			std::string line;
+			while (std::getline(file, line)) {
+				std::stringstream ss(line.substr(0, line.find('#')));
+				std::string arg;
+				while (ss >> arg)
+					args->push_back(arg);
+			}
+		}
+	}
+
+	std::vector<std::string> readArgs(int argc, char** argv) {
+		std::vector<std::string> args;
+		for (int i = 1; i < argc; ++i) {
+			const std::string arg = argv[i];
+			if (arg.rfind("config=", 0) == 0)
+				readConfigFile(arg.substr(7), &args);
+			else
+				args.push_back(arg);
+		}
+		return args;
+	}
+
+	size_t parseTickerCfg(const std::vector<std::string>& positional, size_t first,
+		TradeEngineCfgHashMap* ticker_cfg) {
+		ASSERT(first <= positional.size() && (positional.size() - first) % 5 == 0,
+			"Ticker configuration takes CLIP THRESHOLD MAX_ORDER_SIZE MAX_POSITION MAX_LOSS.");
+		const auto num_tickers = (positional.size() - first) / 5;
+		ASSERT(num_tickers <= ticker_cfg->size(), "Too many tickers configured.");
+		for (size_t i = first, ticker_id = 0; i < positional.size(); i += 5, ++ticker_id) {
+			ticker_cfg->at(ticker_id) = { static_cast<Qty>(std::stoul(positional[i])),
+				std::stod(positional[i + 1]), { static_cast<Qty>(std::stoul(positional[i + 2])),
+				static_cast<Qty>(std::stoul(positional[i + 3])), std::stod(positional[i + 4]) } };
+		}
+		return num_tickers;
+	}
+
+	std::vector<StrategyCfg> strategiesOf(AlgoType algo_type, size_t num_tickers,
+		const std::vector<StrategyCfg>& extra_strategies) {
+		if (extra_strategies.empty())
+			return {};
+		std::vector<StrategyCfg> strategies = { { algo_type, {} } };
+		for (TickerId ticker_id = 0; ticker_id < num_tickers; ++ticker_id)
+			strategies.front().m_tickers.push_back(ticker_id);
+		strategies.insert(strategies.end(), extra_strategies.begin(), extra_strategies.end());
+		return strategies;
+	}
+}
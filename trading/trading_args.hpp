@@ -0,0 +1,31 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "common/macros.hpp"
+#include "common/types.hpp"
+
+#include "trading/strategy/multi_algo.hpp"
+
+using namespace Common;
+
+namespace Trading {
+
+	/// Arguments of a trading binary, argv after the program name with every
+	/// config=<file> replaced by the file's arguments: whitespace separated, #
+	/// starts a comment.
+	std::vector<std::string> readArgs(int argc, char** argv);
+
+	/// Configures tickers 0 onwards from positional[first] onwards, five
+	/// arguments each: CLIP THRESHOLD MAX_ORDER_SIZE MAX_POSITION MAX_LOSS.
+	/// Returns the number of tickers configured.
+	size_t parseTickerCfg(const std::vector<std::string>& positional, size_t first,
+		TradeEngineCfgHashMap* ticker_cfg);
+
+	/// Strategies of an engine given strategy= arguments: algo_type on tickers 0
+	/// to num_tickers - 1, then extra_strategies, see MultiAlgo. Empty without
+	/// extra_strategies, algo_type then trades alone.
+	std::vector<StrategyCfg> strategiesOf(AlgoType algo_type, size_t num_tickers,
+		const std::vector<StrategyCfg>& extra_strategies);
+}
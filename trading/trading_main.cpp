@@ -0,0 +1,166 @@
+#include <csignal>
+
+#include "trading/trading_args.hpp"
+#include "trading/strategy/trade_engine.hpp"
+#include "trading/order_gw/order_gateway.hpp"
+#include "trading/market_data/market_data_consumer.hpp"
+#include "trading/capture/market_data_capture.hpp"
+
+// Trading client against a local exchange_main: MarketDataConsumer, OrderGateway
+// and TradeEngine joined by their three queues.
+//
+// Usage: trading_main CLIENT_ID ALGO_TYPE [CLIP THRESHOLD MAX_ORDER_SIZE MAX_POSITION
+//   MAX_LOSS]... [key=value]...
+// The five numbers configure ticker 0, the next five ticker 1 and so on. Options:
+// - config=<file>: more arguments, whitespace separated, # starts a comment.
+// - md_core=, ogw_core=, te_core=: cores to pin the threads to, unpinned by default.
+// - ip=, iface=, port=: the order server, 127.0.0.1 on lo port 12345 by default.
+// - channels=: market data channels of exchange_main, 1 by default.
+// - seconds=: run time, until SIGINT by default.
+// - capture=<dir>: record market updates and responses the engine processed, see
+//   MarketDataCapture. capture_rows= sets the rows per file, capture_core= the core.
+// - strategy=ALGO_TYPE:TICKER,...: another strategy in the same engine on those
+//   tickers, next to ALGO_TYPE on the configured ones, see MultiAlgo. Repeatable.
+// Positions and PnL are printed on the way out.
+
+Trading::MarketDataConsumer* market_data_consumer = nullptr;
+Trading::OrderGateway* order_gateway = nullptr;
+Trading::TradeEngine* trade_engine = nullptr;
+Trading::MarketDataCapture* market_data_capture = nullptr;
+Common::MetricsRegistry* metrics = nullptr;
+
+volatile bool keep_running = true;
+
+void signal_handler(int) {
+	keep_running = false;
+}
+
+int main(int argc, char** argv) {
+	const auto args = Trading::readArgs(argc, argv);
+
+	std::string ip = "127.0.0.1";
+	std::string iface = "lo";
+	int port = 12345;
+	size_t num_channels = 1;
+	int md_core = -1, ogw_core = -1, te_core = -1, capture_core = -1;
+	Nanos run_time = 0;
+	std::string capture_dir;
+	uint64_t capture_rows = Trading::CaptureDefaultRows;
+	std::vector<Trading::StrategyCfg> extra_strategies;
+	std::vector<std::string> positional;
+	for (const auto& arg : args) {
+		const auto equals = arg.find('=');
+		if (equals == std::string::npos) {
+			positional.push_back(arg);
+			continue;
+		}
+		const auto key = arg.substr(0, equals);
+		const auto value = arg.substr(equals + 1);
+		if (key == "ip")
+			ip = value;
+		else if (key == "iface")
+			iface = value;
+		else if (key == "port")
+			port = std::stoi(value);
+		else if (key == "channels")
+			num_channels = std::stoul(value);
+		else if (key == "md_core")
+			md_core = std::stoi(value);
+		else if (key == "ogw_core")
+			ogw_core = std::stoi(value);
+		else if (key == "te_core")
+			te_core = std::stoi(value);
+		else if (key == "capture")
+			capture_dir = value;
+		else if (key == "capture_rows")
+			capture_rows = std::stoull(value);
+		else if (key == "capture_core")
+			capture_core = std::stoi(value);
+		else if (key == "seconds")
+			run_time = static_cast<Nanos>(std::stod(value) * NANOS_TO_SECS);
+		else if (key == "strategy")
+			extra_strategies.push_back(Trading::stringToStrategyCfg(value));
+		else
+			FATAL("Unknown argument " + arg);
+	}
+
+	ASSERT(positional.size() >= 2 && (positional.size() - 2) % 5 == 0,
+		"Usage: trading_main CLIENT_ID ALGO_TYPE [CLIP THRESHOLD MAX_ORDER_SIZE MAX_POSITION"
+		" MAX_LOSS]... [key=value]...");
+	const auto client_id = static_cast<Common::ClientId>(std::stoul(positional[0]));
+	ASSERT(client_id < ME_MAX_NUM_CLIENTS, "Invalid client id " + positional[0]);
+	const auto algo_type = Common::stringToAlgoType(positional[1]);
+	ASSERT(algo_type != Common::AlgoType::INVALID && algo_type != Common::AlgoType::MAX,
+		"Invalid algo type " + positional[1]);
+	ASSERT(algo_type != Common::AlgoType::RANDOM,
+		"RANDOM flow comes from the load_generator binary.");
+
+	Common::TradeEngineCfgHashMap ticker_cfg;
+	const auto num_tickers = Trading::parseTickerCfg(positional, 2, &ticker_cfg);
+
+	std::signal(SIGINT, signal_handler);
+
+	Exchange::ClientRequestLFQueue client_requests(ME_MAX_CLIENT_UPDATES);
+	Trading::RecvTimeClientResponseLFQueue client_responses(ME_MAX_CLIENT_UPDATES);
+	Trading::RecvTimeMarketUpdateLFQueue market_updates(ME_MAX_MARKET_UPDATES);
+
+	Trading::RecvTimeClientResponseLFQueue capture_responses(ME_MAX_CLIENT_UPDATES);
+	Trading::RecvTimeMarketUpdateLFQueue capture_updates(ME_MAX_MARKET_UPDATES);
+
+	const auto strategies = Trading::strategiesOf(algo_type, num_tickers, extra_strategies);
+	if (strategies.empty()) {
+		trade_engine = Trading::createTradeEngine(client_id, algo_type, ticker_cfg,
+			&client_requests, &client_responses, &market_updates);
+	}
+	else {
+		trade_engine = Trading::createTradeEngine(client_id, strategies, ticker_cfg,
+			&client_requests, &client_responses, &market_updates);
+	}
+	if (!capture_dir.empty()) {
+		market_data_capture = new Trading::MarketDataCapture(capture_dir, capture_rows,
+			&capture_updates, &capture_responses);
+		trade_engine->setCaptureQueues(&capture_updates, &capture_responses);
+		market_data_capture->start(capture_core);
+	}
+	trade_engine->start(te_core);
+
+	order_gateway = new Trading::OrderGateway(client_id, &client_requests, &client_responses,
+		ip, iface, port);
+	order_gateway->start(ogw_core);
+
+	market_data_consumer = new Trading::MarketDataConsumer(client_id, &market_updates, iface,
+		Exchange::makeMarketDataChannelCfgs(num_channels));
+	market_data_consumer->start(md_core);
+
+	// Live counters, queue depths and latencies, see llstat.
+	metrics = new Common::MetricsRegistry("ll_trading_" + std::to_string(client_id));
+	trade_engine->registerMetrics(*metrics);
+	order_gateway->registerMetrics(*metrics);
+	market_data_consumer->registerMetrics(*metrics);
+	if (market_data_capture)
+		market_data_capture->registerMetrics(*metrics);
+	metrics->start();
+
+	trade_engine->initLastEventTime();
+	const auto start_time = Common::getCurrentNanos();
+	while (keep_running && (!run_time || Common::getCurrentNanos() - start_time < run_time)) {
+		using namespace std::literals::chrono_literals;
+		std::this_thread::sleep_for(100ms);
+	}
+
+	// No more market data, then let the engine drain what is queued and the order
+	// gateway send what it produced.
+	delete metrics; metrics = nullptr;
+	market_data_consumer->stop();
+	trade_engine->stop();
+	std::cout << "POSITIONS client:" << static_cast<size_t>(client_id) << " algo:" <<
+		Common::algoTypeToString(algo_type) << "\n" <<
+		trade_engine->positionKeeper().toString() << std::endl;
+
+	delete trade_engine; trade_engine = nullptr;
+	delete market_data_capture; market_data_capture = nullptr;
+	delete order_gateway; order_gateway = nullptr;
+	delete market_data_consumer; market_data_consumer = nullptr;
+
+	return 0;
+}